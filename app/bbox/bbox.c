@@ -0,0 +1,320 @@
+/**
+ * @file       bbox.c
+ * @brief      CAN black-box recorder implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bbox.h"
+#include "bbox_intf.h"
+
+#include "log.h"
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_bbox"
+
+#define MDP_BBOX_REC_MAX	17	/* hdr, dt[5], id[2], data[8] */
+#define MDP_BBOX_DUMP_LINE	32
+
+#define bbox_flash()		mdp_intf_bbox_flash()
+#define bbox_flash_size()	mdp_intf_bbox_flash_size()
+#define bbox_erase(x)		mdp_intf_bbox_erase(x)
+#define bbox_program(x, y, z)	mdp_intf_bbox_program(x, y, z)
+
+#define ring_at(pos)		ring[(pos) & (MDP_BBOX_RING_SIZE - 1)]
+
+static uint8_t ring[MDP_BBOX_RING_SIZE];
+static uint32_t head, tail;	/* Free-running byte positions */
+static uint64_t first_us;	/* Time of the record at tail */
+static uint64_t last_us;	/* Time of the newest record */
+
+static uint16_t dict[MDP_BBOX_DICT_SIZE];
+static uint32_t dict_cnt;
+
+static bool triggered;
+static mdp_bbox_event_t trigger_ev;
+static uint32_t trigger_ms;
+static bool trigger_pending;
+
+static uint32_t leb128_put(uint8_t *buf, uint32_t val)
+{
+	uint32_t len = 0;
+
+	do {
+		buf[len] = val & 0x7F;
+		val >>= 7;
+		if (val)
+			buf[len] |= 0x80;
+		len++;
+	} while (val);
+
+	return len;
+}
+
+/* Returns LEB128 length at the ring position, value is optional */
+static uint32_t leb128_get(uint32_t pos, uint32_t *val)
+{
+	uint32_t len = 0, res = 0;
+	uint8_t byte;
+
+	do {
+		byte = ring_at(pos + len);
+		res |= (uint32_t)(byte & 0x7F) << (7 * len);
+		len++;
+	} while (byte & 0x80);
+
+	if (val)
+		*val = res;
+
+	return len;
+}
+
+static uint32_t bbox_rec_len(uint32_t pos)
+{
+	uint8_t hdr = ring_at(pos);
+	uint32_t len = 1;
+
+	len += leb128_get(pos + len, NULL);
+
+	switch (hdr >> MDP_BBOX_TYPE_SHIFT) {
+	case MDP_BBOX_REC_DICT:
+		return len + 1 + (hdr & MDP_BBOX_DLC_MASK);
+	case MDP_BBOX_REC_ID:
+		return len + 2 + (hdr & MDP_BBOX_DLC_MASK);
+	default:
+		return len + leb128_get(pos + len, NULL);
+	}
+}
+
+static void bbox_drop_oldest(void)
+{
+	uint32_t dt;
+
+	tail += bbox_rec_len(tail);
+	if (tail == head)
+		return;
+
+	/* Next record becomes the oldest, its time is known from delta */
+	leb128_get(tail + 1, &dt);
+	first_us += dt;
+}
+
+static void bbox_push(const uint8_t *rec, uint32_t len, uint64_t now)
+{
+	while (MDP_BBOX_RING_SIZE - (head - tail) < len)
+		bbox_drop_oldest();
+
+	if (head == tail)
+		first_us = now;
+
+	for (uint32_t i = 0; i < len; i++)
+		ring_at(head + i) = rec[i];
+
+	head += len;
+	last_us = now;
+}
+
+static uint32_t bbox_put_dt(uint8_t *rec, uint64_t now)
+{
+	uint64_t dt = now - last_us;
+
+	return leb128_put(rec, dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt);
+}
+
+static int bbox_dict_lookup(uint16_t id)
+{
+	for (uint32_t i = 0; i < dict_cnt; i++) {
+		if (dict[i] == id)
+			return i;
+	}
+
+	if (dict_cnt >= MDP_BBOX_DICT_SIZE)
+		return -ENOSPC;
+
+	/* First appearance is recorded with literal ID */
+	dict[dict_cnt++] = id;
+	return -ENOENT;
+}
+
+void mdp_bbox_init(void)
+{
+	head = tail = 0;
+	dict_cnt = 0;
+	triggered = trigger_pending = false;
+	last_us = mdp_tm_us();
+
+	mdp_bbox_event(MDP_BBOX_EV_BOOT, 0);
+}
+
+void mdp_bbox_frame(int dir, const struct mdp_can_msg *msg, bool rewritten)
+{
+	uint8_t rec[MDP_BBOX_REC_MAX];
+	uint64_t now = mdp_tm_us();
+	uint32_t len = 1;
+	uint8_t dlc = MIN(msg->size, MDP_CAN_FRAME_LEN);
+	int idx;
+
+	rec[0] = (dir ? BIT(MDP_BBOX_DIR_BIT) : 0) |
+		 (rewritten ? BIT(MDP_BBOX_REWR_BIT) : 0) | dlc;
+	len += bbox_put_dt(&rec[len], now);
+
+	idx = bbox_dict_lookup(msg->id);
+	if (idx >= 0) {
+		rec[0] |= MDP_BBOX_REC_DICT << MDP_BBOX_TYPE_SHIFT;
+		rec[len++] = idx;
+	} else {
+		rec[0] |= MDP_BBOX_REC_ID << MDP_BBOX_TYPE_SHIFT;
+		rec[len++] = msg->id & 0xFF;
+		rec[len++] = (msg->id >> 8) & 0xFF;
+	}
+
+	memcpy(&rec[len], msg->data, dlc);
+	len += dlc;
+
+	bbox_push(rec, len, now);
+}
+
+void mdp_bbox_event(mdp_bbox_event_t ev, uint32_t arg)
+{
+	uint8_t rec[MDP_BBOX_REC_MAX];
+	uint64_t now = mdp_tm_us();
+	uint32_t len = 1;
+
+	rec[0] = (MDP_BBOX_REC_EVENT << MDP_BBOX_TYPE_SHIFT) |
+		 (ev & MDP_BBOX_EVENT_MASK);
+	len += bbox_put_dt(&rec[len], now);
+	len += leb128_put(&rec[len], arg);
+
+	bbox_push(rec, len, now);
+}
+
+void mdp_bbox_trigger(mdp_bbox_event_t ev, uint32_t arg)
+{
+	mdp_bbox_event(ev, arg);
+
+	if (triggered)
+		return;
+
+	triggered = true;
+	trigger_pending = true;
+	trigger_ev = ev;
+	trigger_ms = mdp_tm_ms();
+}
+
+bool mdp_bbox_due(void)
+{
+	return trigger_pending && mdp_tm_ms() - trigger_ms >= MDP_BBOX_POST_MS;
+}
+
+void mdp_bbox_poll(void)
+{
+	if (!mdp_bbox_due())
+		return;
+
+	trigger_pending = false;
+	mdp_bbox_commit(trigger_ev);
+}
+
+int mdp_bbox_commit(mdp_bbox_event_t reason)
+{
+	static uint8_t chunk[64];
+	struct mdp_bbox_hdr hdr;
+	uint32_t len, size, off, n;
+	uint32_t start_ms = mdp_tm_ms();
+
+	mdp_bbox_event(MDP_BBOX_EV_TRIGGER, reason);
+
+	/* Flash is programmed by half-words */
+	len = head - tail;
+	size = sizeof(hdr) + ALIGN_UP(len, 2);
+	if (size > bbox_flash_size()) {
+		log_err("Snapshot doesn't fit: %lu bytes\r\n", size);
+		return -ENOSPC;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = MDP_BBOX_MAGIC;
+	hdr.version = MDP_BBOX_VERSION;
+	hdr.reason = reason;
+	hdr.commit_ms = start_ms;
+	hdr.len = len;
+	hdr.first_us = first_us;
+	hdr.dict_cnt = dict_cnt;
+	memcpy(hdr.dict, dict, sizeof(dict));
+
+	if (!bbox_erase(size)) {
+		log_err("Flash erase failed\r\n");
+		return -EIO;
+	}
+
+	/* Records are taken out of the ring in linear chunks */
+	for (off = 0; off < len; off += n) {
+		n = MIN(len - off, sizeof(chunk));
+		for (uint32_t i = 0; i < n; i++)
+			chunk[i] = ring_at(tail + off + i);
+		if (n & 1)
+			chunk[n] = 0xFF;
+
+		if (!bbox_program(sizeof(hdr) + off, chunk, ALIGN_UP(n, 2))) {
+			log_err("Flash program failed\r\n");
+			return -EIO;
+		}
+	}
+
+	/* Magic goes last, so an interrupted commit is never valid */
+	if (!bbox_program(sizeof(hdr.magic), (uint8_t *)&hdr + sizeof(hdr.magic),
+			  sizeof(hdr) - sizeof(hdr.magic)) ||
+	    !bbox_program(0, (uint8_t *)&hdr.magic, sizeof(hdr.magic))) {
+		log_err("Flash program failed\r\n");
+		return -EIO;
+	}
+
+	log_sys("Snapshot saved: %lu bytes, %lu ms\r\n", len,
+		mdp_tm_ms() - start_ms);
+	return 0;
+}
+
+void mdp_bbox_dump(void)
+{
+	const struct mdp_bbox_hdr *hdr = (const void *)bbox_flash();
+	const uint8_t *data = bbox_flash();
+	uint32_t size, n;
+	char line[MDP_BBOX_DUMP_LINE * 2 + 1];
+
+	if (hdr->magic != MDP_BBOX_MAGIC ||
+	    hdr->version != MDP_BBOX_VERSION ||
+	    sizeof(*hdr) + hdr->len > bbox_flash_size()) {
+		log_sys("No snapshot\r\n");
+		return;
+	}
+
+	log_sys("Snapshot: reason %u, uptime %lu ms, %lu bytes\r\n",
+		hdr->reason, hdr->commit_ms, hdr->len);
+
+	size = sizeof(*hdr) + hdr->len;
+	for (uint32_t off = 0; off < size; off += n) {
+		n = MIN(size - off, MDP_BBOX_DUMP_LINE);
+		for (uint32_t i = 0; i < n; i++)
+			snprintf(&line[i * 2], 3, "%02X", data[off + i]);
+
+		log_sys("BBOX %04lX %s\r\n", off, line);
+	}
+}
+
+int mdp_bbox_clear(void)
+{
+	if (!bbox_erase(bbox_flash_size())) {
+		log_err("Flash erase failed\r\n");
+		return -EIO;
+	}
+
+	return 0;
+}
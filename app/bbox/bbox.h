@@ -0,0 +1,165 @@
+/**
+ * @file       bbox.h
+ * @brief      CAN black-box recorder.
+ *
+ *             Forwarded frames, gateway decisions and application events
+ *             are kept in a RAM ring, the oldest records are overwritten.
+ *             On an error trigger the ring is committed to the reserved
+ *             flash region, so it survives reset and can be dumped with
+ *             the "bbox dump" console command and decoded on the host
+ *             with tools/mdp_bbox_decode.py.
+ *
+ *             Record formats (timestamp delta is in microseconds, since
+ *             the previous record, unsigned LEB128):
+ *
+ *             Frame, known ID:   | hdr | dt | dict index | data[dlc] |
+ *             Frame, new ID:     | hdr | dt | id[2] (LE) | data[dlc] |
+ *             Event:             | hdr | dt | arg (LEB128)           |
+ *
+ *             Frame hdr: bits 7..6 - type, bit 5 - gateway direction,
+ *                        bit 4 - frame was rewritten, bits 3..0 - DLC.
+ *             Event hdr: bits 7..6 - type, bits 5..0 - event code.
+ *
+ *             IDs are added to the dictionary on their first appearance
+ *             and never removed, so any record can be decoded with the
+ *             dictionary saved in the snapshot header.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_BBOX_H__
+#define __MDP_BBOX_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "boardinfo.h"
+#include "can_bus_def.h"
+
+#define MDP_BBOX_RING_SIZE	4096	/* Must be power of two */
+#define MDP_BBOX_DICT_SIZE	64	/* Maximum number of known IDs */
+#define MDP_BBOX_POST_MS	200	/* Recording time after the trigger */
+
+#define MDP_BBOX_MAGIC		0x42504D44	/* "MDPB" */
+#define MDP_BBOX_VERSION	1
+
+#define MDP_BBOX_REC_DICT	0	/* Frame with dictionary ID */
+#define MDP_BBOX_REC_ID		1	/* Frame with literal ID */
+#define MDP_BBOX_REC_EVENT	2
+
+#define MDP_BBOX_TYPE_SHIFT	6
+#define MDP_BBOX_DIR_BIT	5
+#define MDP_BBOX_REWR_BIT	4
+#define MDP_BBOX_DLC_MASK	0x0F
+#define MDP_BBOX_EVENT_MASK	0x3F
+
+typedef enum {
+	MDP_BBOX_EV_BOOT = 0,	/* arg: 0 */
+	MDP_BBOX_EV_TRIGGER,	/* arg: event that caused the commit */
+	MDP_BBOX_EV_ERROR,	/* arg: 0, application error handler */
+	MDP_BBOX_EV_RGEAR,	/* arg: reverse gear state */
+	MDP_BBOX_EV_POWER,	/* arg: power mode */
+	MDP_BBOX_EV_BYPASS,	/* arg: bypass state */
+	MDP_BBOX_EV_GW_DROP,	/* arg: direction, queue was full */
+	MDP_BBOX_EV_RX_ERR,	/* arg: direction << 8 | -errno */
+	MDP_BBOX_EV_TX_ERR,	/* arg: direction << 8 | -errno */
+} mdp_bbox_event_t;
+
+/* Snapshot header, records follow it in flash */
+struct mdp_bbox_hdr {
+	uint32_t magic;		/* Written last, snapshot is valid if set */
+	uint16_t version;
+	uint16_t reason;	/* Event that caused the commit */
+	uint32_t commit_ms;	/* Uptime at the commit */
+	uint32_t len;		/* Records length */
+	uint64_t first_us;	/* Time of the oldest record */
+	uint16_t dict_cnt;
+	uint16_t dict[MDP_BBOX_DICT_SIZE];
+	uint16_t reserved[3];	/* Keeps size multiple of 8, no padding */
+};
+
+#if (MDP_BBOX_ENABLED == 1)
+/**
+ * @brief Initialize recorder, records the boot event.
+ */
+void mdp_bbox_init(void);
+
+/**
+ * @brief Record forwarded frame.
+ *
+ * @param [in] dir Gateway direction index.
+ * @param [in] msg Frame as it was sent.
+ * @param [in] rewritten true if the frame was changed by the gateway.
+ */
+void mdp_bbox_frame(int dir, const struct mdp_can_msg *msg, bool rewritten);
+
+/**
+ * @brief Record application event.
+ *
+ * @param [in] ev Event code.
+ * @param [in] arg Event argument, see mdp_bbox_event_t.
+ */
+void mdp_bbox_event(mdp_bbox_event_t ev, uint32_t arg);
+
+/**
+ * @brief Record event and commit the ring to flash after
+ *        MDP_BBOX_POST_MS. Only the first trigger after boot is
+ *        committed, so the original failure isn't overwritten.
+ *
+ * @param [in] ev Event code.
+ * @param [in] arg Event argument.
+ */
+void mdp_bbox_trigger(mdp_bbox_event_t ev, uint32_t arg);
+
+/**
+ * @brief Commit the ring to flash right now. Blocks while flash is
+ *        erased and programmed: a full ring takes 5 pages of 20-40 ms
+ *        and 2K half-words of 40-70 us, 100-300 ms in total. Nothing
+ *        is forwarded meanwhile.
+ *
+ * @param [in] reason Event code saved in the snapshot header.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_bbox_commit(mdp_bbox_event_t reason);
+
+/**
+ * @brief Check if the pending trigger is due, so the next
+ *        mdp_bbox_poll() will commit and block.
+ *
+ * @return true if the commit is due.
+ */
+bool mdp_bbox_due(void);
+
+/**
+ * @brief Commit pending trigger, must be called in the main loop.
+ */
+void mdp_bbox_poll(void);
+
+/**
+ * @brief Print snapshot from flash in hex, one line per 32 bytes.
+ */
+void mdp_bbox_dump(void);
+
+/**
+ * @brief Erase snapshot from flash.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_bbox_clear(void);
+#else
+static inline void mdp_bbox_init(void) {}
+static inline void mdp_bbox_frame(int dir, const struct mdp_can_msg *msg,
+				  bool rewritten) {}
+static inline void mdp_bbox_event(mdp_bbox_event_t ev, uint32_t arg) {}
+static inline void mdp_bbox_trigger(mdp_bbox_event_t ev, uint32_t arg) {}
+static inline int mdp_bbox_commit(mdp_bbox_event_t reason) { return 0; }
+static inline bool mdp_bbox_due(void) { return false; }
+static inline void mdp_bbox_poll(void) {}
+static inline void mdp_bbox_dump(void) {}
+static inline int mdp_bbox_clear(void) { return 0; }
+#endif /* MDP_BBOX_ENABLED */
+
+#endif /* __MDP_BBOX_H__ */
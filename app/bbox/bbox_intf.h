@@ -0,0 +1,68 @@
+/**
+ * @file       bbox_intf.h
+ * @brief      Black-box flash interface wrapper, the purpose is to use
+ *             different MCU's with the black-box recorder API.
+ *
+ *             Snapshot region is reserved in the linker script (BBOX
+ *             memory region), so the application can't grow into it.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_BBOX_INTF_H__
+#define __MDP_BBOX_INTF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "flash_intf.h"
+
+#ifdef STM32F103xB
+extern uint8_t __bbox_start[];
+extern uint8_t __bbox_size[];
+
+#define __MCU_BBOX_ADDR ((uint32_t)__bbox_start)
+#define __MCU_BBOX_SIZE ((uint32_t)__bbox_size)
+#endif /* STM32F103xB */
+
+static inline const uint8_t *mdp_intf_bbox_flash(void)
+{
+#ifdef STM32F103xB
+	return (const uint8_t *)__MCU_BBOX_ADDR;
+#else
+	return NULL;
+#endif /* STM32F103xB */
+}
+
+static inline uint32_t mdp_intf_bbox_flash_size(void)
+{
+#ifdef STM32F103xB
+	return __MCU_BBOX_SIZE;
+#else
+	return 0;
+#endif /* STM32F103xB */
+}
+
+static inline bool mdp_intf_bbox_erase(uint32_t size)
+{
+#ifdef STM32F103xB
+	return mdp_intf_flash_erase(__MCU_BBOX_ADDR, size);
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+/* Offset and size must be even, flash is programmed by half-words */
+static inline bool mdp_intf_bbox_program(uint32_t offset, const uint8_t *data,
+					 uint32_t size)
+{
+#ifdef STM32F103xB
+	return mdp_intf_flash_program(__MCU_BBOX_ADDR + offset, data, size);
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_BBOX_INTF_H__ */
@@ -12,42 +12,21 @@
 #define MDP_BEEP_MIN_FREQ	1000	/* Minimal frequency is 1 KHz */
 #define MDP_BEEP_MAX_FREQ	10000	/* Maximal frequency is 10 KHz */
 
+#define beeper_init()		mdp_intf_beeper_init()
 #define beeper_on()		mdp_intf_beeper_start()
 #define beeper_off()		mdp_intf_beeper_stop()
 #define beeper_set_freq(x)	mdp_intf_beeper_set_freq(x)
+#define beeper_set_cadence(x, y) mdp_intf_beeper_set_cadence(x, y)
 
 static bool beeper_inited;
-static mdp_beep_mode_t beep_mode;
-static struct mdp_timestamp beep_ts;
+static bool beeper_running;
+static uint32_t beeper_freq;
+static struct mdp_beep_pattern beep_pattern;
 
-static inline char *mode_to_str(mdp_beep_mode_t mode)
-{
-	switch (mode) {
-	case MDP_BEEP_NONE:
-		return "MDP_BEEP_NONE";
-	case MDP_BEEP_SLOW:
-		return "MDP_BEEP_SLOW";
-	case MDP_BEEP_FAST:
-		return "MDP_BEEP_FAST";
-	case MDP_BEEP_CONST:
-		return "MDP_BEEP_CONST";
-	default:
-		return "invalid mode";
-	}
-}
-
-static inline void beep_toggle(void)
-{
-	static bool beep_on = false;
-
-	if (beep_on) {
-		beeper_off();
-		beep_on = false;
-	} else {
-		beeper_on();
-		beep_on = true;
-	}
-}
+static const struct mdp_beep_pattern beep_presets[] = {
+	[MDP_BEEP_NONE] = { .on_ms = 0, .off_ms = 0 },
+	[MDP_BEEP_CONST] = { .on_ms = MDP_BEEP_CONST_INTERVAL, .off_ms = 0 },
+};
 
 bool mdp_beeper_init(uint32_t freq)
 {
@@ -57,39 +36,24 @@ bool mdp_beeper_init(uint32_t freq)
 		return false;
 	}
 
+	beeper_init();
 	beeper_set_freq(freq);
 
-	beep_ts = MDP_TIMESTAMP;
-
+	beeper_freq = freq;
 	beeper_inited = true;
 
 	log_dbg("Beeper inited with frequency %lu Hz\r\n", freq);
 	return true;
 }
 
-void mdp_beeper_beep(void)
+void mdp_beeper_update_clock(void)
 {
 	if (!beeper_inited)
 		return;
 
-	switch (beep_mode) {
-	case MDP_BEEP_NONE:
-		beeper_off();
-		break;
-	case MDP_BEEP_SLOW:
-		if (mdp_tm_elapsed(&beep_ts, MDP_BEEP_SLOW_INTERVAL))
-			beep_toggle();
-		break;
-	case MDP_BEEP_FAST:
-		if (mdp_tm_elapsed(&beep_ts, MDP_BEEP_FAST_INTERVAL))
-			beep_toggle();
-		break;
-	case MDP_BEEP_CONST:
-		beeper_on();
-		break;
-	default:
-		break;
-	}
+	/* Timers prescalers depend on the bus clocks */
+	beeper_init();
+	beeper_set_freq(beeper_freq);
 }
 
 bool mdp_beeper_set_mode(mdp_beep_mode_t mode)
@@ -99,7 +63,42 @@ bool mdp_beeper_set_mode(mdp_beep_mode_t mode)
 		return false;
 	}
 
-	beep_mode = mode;
+	return mdp_beeper_set_pattern(&beep_presets[mode]);
+}
+
+bool mdp_beeper_set_pattern(const struct mdp_beep_pattern *pattern)
+{
+	bool ret = true;
 
-	return true;
+	if (!beeper_inited)
+		return false;
+
+	/* Hardware keeps beeping, nothing to do if the cadence is the same */
+	if (pattern->on_ms == beep_pattern.on_ms &&
+	    pattern->off_ms == beep_pattern.off_ms)
+		return true;
+
+	if (pattern->on_ms + pattern->off_ms > MDP_INTF_CADENCE_MAX_MS) {
+		log_err("Invalid pattern: on = %u, off = %u\r\n",
+			pattern->on_ms, pattern->off_ms);
+		return false;
+	}
+
+	beep_pattern = *pattern;
+
+	if (!beep_pattern.on_ms) {
+		if (beeper_running)
+			ret = beeper_off();
+		beeper_running = false;
+		return ret;
+	}
+
+	beeper_set_cadence(beep_pattern.on_ms, beep_pattern.off_ms);
+
+	if (!beeper_running) {
+		ret = beeper_on();
+		beeper_running = ret;
+	}
+
+	return ret;
 }
@@ -2,6 +2,11 @@
  * @file       beeper.h
  * @brief      Beeper API for signaling the work of parking sensors.
  *
+ *             Beep cadence is described by a pattern (on and off time) and
+ *             is generated by the hardware, so it doesn't depend on how
+ *             often the main loop is running. The main loop only needs to
+ *             push a new pattern when the distance changes.
+ *
  * @date       August 20, 2021
  * @author     Eduard Chaika <rampopula@gmail.com>
  * @copyright  Copyright (c) 2021 Eduard Chaika
@@ -13,20 +18,30 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#define MDP_BEEP_SLOW_INTERVAL	300
-#define MDP_BEEP_FAST_INTERVAL	100
+#define MDP_BEEP_CONST_INTERVAL	1000
 
 typedef enum {
 	MDP_BEEP_NONE = 0,
-	MDP_BEEP_SLOW,
-	MDP_BEEP_FAST,
 	MDP_BEEP_CONST
 } mdp_beep_mode_t;
 
+/**
+ * @brief Beep pattern descriptor.
+ *        If on_ms is zero the beeper is silent,
+ *        if off_ms is zero the beeper is on constantly.
+ */
+struct mdp_beep_pattern {
+	uint16_t on_ms;
+	uint16_t off_ms;
+};
+
 bool mdp_beeper_init(uint32_t freq);
 
-void mdp_beeper_beep(void);
+/* Must be called after the system clock change */
+void mdp_beeper_update_clock(void);
 
 bool mdp_beeper_set_mode(mdp_beep_mode_t mode);
 
+bool mdp_beeper_set_pattern(const struct mdp_beep_pattern *pattern);
+
 #endif /* __MDP_BEEPER_H__*/
@@ -3,6 +3,12 @@
  * @brief      Beeper interface wrapper, the purpose is to use different MCU's
  *             with the beeper API.
  *
+ *             The tone is generated by TIM1 channel 2 in toggle mode.
+ *             The on/off cadence is generated by TIM2: its OC1REF signal is
+ *             routed to TRGO and gates TIM1 (slave gated mode, ITR1), so the
+ *             tone is audible only while OC1REF is high. No CPU involvement
+ *             is required once the cadence is programmed.
+ *
  * @date       August 20, 2021
  * @author     Eduard Chaika <rampopula@gmail.com>
  * @copyright  Copyright (c) 2021 Eduard Chaika
@@ -16,16 +22,43 @@
 
 #include "boardinfo.h"
 
+#define MDP_INTF_CADENCE_TICK_HZ	10000	/* Cadence timer tick, 0.1 ms */
+#define MDP_INTF_CADENCE_TICK_MS	(MDP_INTF_CADENCE_TICK_HZ / 1000)
+#define MDP_INTF_CADENCE_MAX_MS		(0xFFFF / MDP_INTF_CADENCE_TICK_MS)
+
 #ifdef STM32F103xB
 #include "stm32f1xx_hal.h"
 
 extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim2;
+#endif /* STM32F103xB */
+
+static inline void mdp_intf_beeper_init(void)
+{
+#ifdef STM32F103xB
+	/**
+	 * APB1 timers are clocked with PCLK1 if APB1 prescaler is 1,
+	 * otherwise with PCLK1 * 2.
+	 */
+	uint32_t tim_clk = HAL_RCC_GetPCLK1Freq();
+
+	if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1)
+		tim_clk *= 2;
+
+	__HAL_TIM_SET_PRESCALER(&htim2, tim_clk / MDP_INTF_CADENCE_TICK_HZ - 1);
 #endif /* STM32F103xB */
+}
 
 static inline bool mdp_intf_beeper_start(void)
 {
 #ifdef STM32F103xB
-	return HAL_TIM_OC_Start(&htim1, TIM_CHANNEL_2) == HAL_OK;
+	/* Restart cadence from the "on" phase and load preloaded values */
+	htim2.Instance->EGR = TIM_EGR_UG;
+
+	if (HAL_TIM_OC_Start(&htim1, TIM_CHANNEL_2) != HAL_OK)
+		return false;
+
+	return HAL_TIM_Base_Start(&htim2) == HAL_OK;
 #else
 	return false;
 #endif /* STM32F103xB */
@@ -34,6 +67,9 @@ static inline bool mdp_intf_beeper_start(void)
 static inline bool mdp_intf_beeper_stop(void)
 {
 #ifdef STM32F103xB
+	if (HAL_TIM_Base_Stop(&htim2) != HAL_OK)
+		return false;
+
 	return HAL_TIM_OC_Stop(&htim1, TIM_CHANNEL_2) == HAL_OK;
 #else
 	return false;
@@ -55,4 +91,32 @@ static inline void mdp_intf_beeper_set_freq(uint32_t freq)
 #endif /* STM32F103xB */
 }
 
+static inline void mdp_intf_beeper_set_cadence(uint32_t on_ms, uint32_t off_ms)
+{
+#ifdef STM32F103xB
+	/**
+	 * TIM2 runs in PWM mode 1: OC1REF is high while CNT < CCR1.
+	 * Period (ARR + 1) is the whole on + off time, CCR1 is the on time.
+	 * If the off time is zero, CCR1 is set above ARR and OC1REF (and
+	 * thus the TIM1 gate) stays high all the time.
+	 *
+	 * Both ARR and CCR1 are preloaded, so a slower cadence is applied on
+	 * the next update event without glitches. A faster one or the
+	 * constant tone is an escalation and must not wait for the end of
+	 * the current period, up to MDP_INTF_CADENCE_MAX_MS: the update is
+	 * generated at once and the new cadence starts from the "on" phase.
+	 */
+	uint32_t period = (on_ms + off_ms) * MDP_INTF_CADENCE_TICK_MS;
+	bool escalate = !off_ms || period <= __HAL_TIM_GET_AUTORELOAD(&htim2);
+
+	__HAL_TIM_SET_AUTORELOAD(&htim2, period - 1);
+	__HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1,
+			      off_ms ? on_ms * MDP_INTF_CADENCE_TICK_MS :
+				       period);
+
+	if (escalate)
+		htim2.Instance->EGR = TIM_EGR_UG;
+#endif /* STM32F103xB */
+}
+
 #endif /* __MDP_BEEPER_INTF_H__ */
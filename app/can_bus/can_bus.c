@@ -1,5 +1,7 @@
 #include "can_bus.h"
+#include "common.h"
 #include "log.h"
+#include "boardinfo.h"
 
 #include "can_hal.h"
 #include "can_spi.h"
@@ -61,28 +63,250 @@ int mdp_can_write(struct mdp_can *can)
 	return can->ops.write(can->msg.id, can->msg.data, can->msg.size);
 }
 
+int mdp_can_set_listen(struct mdp_can *can, bool enable)
+{
+	if (!can || !can->ops.set_listen) {
+		log_err("Invalid arguments: can = %p, ops.set_listen = %p\r\n",
+			can, can->ops.set_listen);
+		return -EINVAL;
+	}
+
+	return can->ops.set_listen(enable);
+}
+
+int mdp_can_set_prio_hook(struct mdp_can *can, uint32_t id,
+			  void (*hook)(const struct mdp_can_msg *msg))
+{
+	if (!can) {
+		log_err("Invalid arguments: can = %p\r\n", can);
+		return -EINVAL;
+	}
+
+	/* MCP2515 INT pin is not wired, there is no RX interrupt */
+	if (!can->ops.set_prio_hook)
+		return -ENOTSUP;
+
+	return can->ops.set_prio_hook(id, hook);
+}
+
+uint32_t mdp_can_rx_lost(struct mdp_can *can)
+{
+	if (!can || !can->ops.rx_lost)
+		return 0;
+
+	return can->ops.rx_lost();
+}
+
+uint32_t mdp_can_rx_us(struct mdp_can *can)
+{
+	if (!can || !can->ops.rx_us)
+		return (uint32_t)mdp_tm_us();
+
+	return can->ops.rx_us();
+}
+
+#if (MDP_CAN_HAL_ROLE == MDP_CAN_ROLE_AUTO)
+static int can_sample_traffic(struct mdp_can *hal, struct mdp_can *spi,
+			      uint32_t *hal_cnt, uint32_t *spi_cnt)
+{
+	uint32_t start_ms;
+	int ret;
+
+	mdp_can_set_listen(hal, true);
+	mdp_can_set_listen(spi, true);
+
+	ret = mdp_can_start(hal);
+	if (!ret)
+		ret = mdp_can_start(spi);
+
+	*hal_cnt = *spi_cnt = 0;
+	start_ms = mdp_tm_ms();
+
+	while (!ret && mdp_tm_ms() - start_ms < MDP_CAN_ROLES_SAMPLE_MS) {
+		ret = mdp_can_read(hal);
+		if (ret > 0)
+			(*hal_cnt)++;
+		if (ret < 0)
+			break;
+
+		ret = mdp_can_read(spi);
+		if (ret > 0)
+			(*spi_cnt)++;
+		if (ret < 0)
+			break;
+
+		ret = 0;
+	}
+
+	mdp_can_stop(hal);
+	mdp_can_stop(spi);
+
+	mdp_can_set_listen(hal, false);
+	mdp_can_set_listen(spi, false);
+
+	return ret;
+}
+#endif
+
+int mdp_can_assign_roles(struct mdp_can *pjb, struct mdp_can *dp)
+{
+	struct mdp_can hal = mdp_get_can_hal_interface();
+	struct mdp_can spi = mdp_get_can_spi_interface();
+	bool hal_on_pjb = (MDP_CAN_HAL_ROLE != MDP_CAN_ROLE_DP);
+
+#if (MDP_CAN_HAL_ROLE == MDP_CAN_ROLE_AUTO)
+	uint32_t hal_cnt, spi_cnt;
+	int ret;
+
+	ret = can_sample_traffic(&hal, &spi, &hal_cnt, &spi_cnt);
+	if (ret) {
+		log_err("Traffic sampling failed: %d\r\n", ret);
+		return ret;
+	}
+
+	/* Keep the default assignment if both segments are equally busy */
+	if (spi_cnt > hal_cnt)
+		hal_on_pjb = false;
+
+	log_sys("Sampled %d ms: %s %lu, %s %lu frames\r\n",
+		MDP_CAN_ROLES_SAMPLE_MS, hal.name, hal_cnt, spi.name, spi_cnt);
+#endif
+
+	*pjb = hal_on_pjb ? hal : spi;
+	*dp = hal_on_pjb ? spi : hal;
+
+	log_sys("PJB side: %s, display side: %s\r\n", pjb->name, dp->name);
+	return 0;
+}
+
+static void can_backoff(struct mdp_can *can)
+{
+	struct mdp_can_recovery *rec = &can->rec;
+
+	rec->state = MDP_CAN_BACKOFF;
+	rec->retry_ms = mdp_tm_ms() + rec->backoff_ms;
+	rec->backoff_ms = MIN(rec->backoff_ms * 2, MDP_CAN_BACKOFF_MAX_MS);
+}
+
+static int can_reinit(struct mdp_can *can)
+{
+	int ret;
+
+	can->rec.reinits++;
+
+	/* Stop may fail if controller is stuck, start anyway */
+	can->ops.stop();
+
+	ret = can->ops.start();
+	if (ret)
+		return ret;
+
+	return can->ops.check();
+}
+
+void mdp_can_fault(struct mdp_can *can, int err)
+{
+	struct mdp_can_recovery *rec = &can->rec;
+
+	rec->last_err = err;
+
+	if (rec->state != MDP_CAN_OK)
+		return;
+
+	log_err("%s: fault %d, recovering\r\n", can->name, err);
+
+	rec->faults++;
+	rec->fault_ms = mdp_tm_ms();
+	rec->passive_cnt = 0;
+	rec->backoff_ms = MDP_CAN_BACKOFF_MIN_MS;
+	can_backoff(can);
+}
+
+bool mdp_can_recover(struct mdp_can *can)
+{
+	struct mdp_can_recovery *rec = &can->rec;
+	int ret;
+
+	if (rec->state == MDP_CAN_OK)
+		return true;
+
+	if ((int32_t)(mdp_tm_ms() - rec->retry_ms) < 0)
+		return false;
+
+	if (rec->state == MDP_CAN_BACKOFF) {
+		ret = can->ops.check();
+		if (ret == -EAGAIN &&
+		    ++rec->passive_cnt < MDP_CAN_PASSIVE_RETRIES) {
+			/* Error counters decrease on successful frames */
+			can_backoff(can);
+			return false;
+		}
+
+		rec->state = ret ? MDP_CAN_REINIT : MDP_CAN_OK;
+	}
+
+	if (rec->state == MDP_CAN_REINIT) {
+		ret = can_reinit(can);
+		if (ret) {
+			rec->last_err = ret;
+			can_backoff(can);
+			rec->state = MDP_CAN_REINIT;
+			return false;
+		}
+	}
+
+	rec->state = MDP_CAN_OK;
+	rec->recoveries++;
+	rec->last_ttr_ms = mdp_tm_ms() - rec->fault_ms;
+	rec->max_ttr_ms = MAX(rec->max_ttr_ms, rec->last_ttr_ms);
+
+	log_sys("%s: recovered in %lu ms\r\n", can->name, rec->last_ttr_ms);
+	return true;
+}
+
+void mdp_can_print_stats(struct mdp_can *can)
+{
+	struct mdp_can_recovery *rec = &can->rec;
+
+	log_sys("%s: %s, faults %lu, recoveries %lu, reinits %lu\r\n",
+		can->name, rec->state == MDP_CAN_OK ? "ok" : "recovering",
+		rec->faults, rec->recoveries, rec->reinits);
+	log_sys("%s: ttr last %lu ms, max %lu ms, last error %d\r\n",
+		can->name, rec->last_ttr_ms, rec->max_ttr_ms, rec->last_err);
+}
+
 struct mdp_can mdp_get_can_hal_interface(void)
 {
 	struct mdp_can intf = {
+		.name = "can_hal",
 		.ops = {
 			.start = mdp_can_hal_start,
 			.stop = mdp_can_hal_stop,
 			.read = mdp_can_hal_read,
-			.write = mdp_can_hal_write
+			.write = mdp_can_hal_write,
+			.check = mdp_can_hal_check,
+			.set_listen = mdp_can_hal_set_listen,
+			.set_prio_hook = mdp_can_hal_set_prio_id,
+			.rx_lost = mdp_can_hal_rx_lost,
+			.rx_us = mdp_can_hal_rx_us
 		}
 	};
 
 	return intf;
 }
 
- struct mdp_can mdp_get_can_spi_interface(void)
+struct mdp_can mdp_get_can_spi_interface(void)
 {
 	struct mdp_can intf = {
+		.name = "can_spi",
 		.ops = {
 			.start = mdp_can_spi_start,
 			.stop = mdp_can_spi_stop,
 			.read = mdp_can_spi_read,
-			.write = mdp_can_spi_write
+			.write = mdp_can_spi_write,
+			.check = mdp_can_spi_check,
+			.set_listen = mdp_can_spi_set_listen,
+			.rx_lost = mdp_can_spi_rx_lost
 		}
 	};
 
@@ -12,23 +12,150 @@
 
 #include "can_bus_def.h"
 
+#include <stdbool.h>
+
+#define MDP_CAN_BACKOFF_MIN_MS	10	/* First retry delay after a fault */
+#define MDP_CAN_BACKOFF_MAX_MS	1000	/* Retry delay upper limit */
+#define MDP_CAN_PASSIVE_RETRIES	3	/* Error-passive checks before reinit */
+
+#define MDP_CAN_ROLES_SAMPLE_MS	250	/* Traffic sampling time in auto mode */
+
+typedef enum {
+	MDP_CAN_OK = 0,		/* Interface is operational */
+	MDP_CAN_BACKOFF,	/* Waiting before the next check */
+	MDP_CAN_REINIT,		/* Controller must be reinitialized */
+} mdp_can_state_t;
+
+struct mdp_can_recovery {
+	mdp_can_state_t state;
+	uint32_t backoff_ms;
+	uint32_t retry_ms;	/* Time of the next check */
+	uint32_t fault_ms;	/* Time of the first fault */
+	uint32_t passive_cnt;
+
+	/* Statistics */
+	uint32_t faults;
+	uint32_t recoveries;
+	uint32_t reinits;
+	uint32_t last_ttr_ms;	/* Last time-to-recover */
+	uint32_t max_ttr_ms;	/* Worst time-to-recover */
+	int last_err;
+};
+
 struct mdp_can_ops {
 	int(*start)(void);
 	int(*stop)(void);
 	int(*read)(uint32_t *, uint8_t *, uint32_t *);
 	int(*write)(uint32_t, uint8_t *, uint32_t);
+	int(*check)(void); /* 0, -EAGAIN if error-passive, -ENETDOWN if off */
+	int(*set_listen)(bool); /* Applied on the next start */
+	/* Optional, hook is called from RX interrupt, applied on next start */
+	int(*set_prio_hook)(uint32_t, void (*)(const struct mdp_can_msg *));
+	/* Optional, frames lost by the controller since power-on */
+	uint32_t(*rx_lost)(void);
+	/* Optional, reception time of the last message read, us */
+	uint32_t(*rx_us)(void);
 };
 
 struct mdp_can {
+	const char *name;
 	struct mdp_can_msg msg;
 	struct mdp_can_ops ops;
+	struct mdp_can_recovery rec;
 };
 
 int mdp_can_start(struct mdp_can *can);
 int mdp_can_stop(struct mdp_can *can);
+/* Returns 1 if a message was read to can->msg, 0 if there is none */
 int mdp_can_read(struct mdp_can *can);
+/* Returns -EBUSY if there is no free TX buffer, try again later */
 int mdp_can_write(struct mdp_can *can);
 
+/**
+ * @brief Select listen-only or normal mode. In listen-only mode the
+ *        controller never transmits, not even ACK or error frames.
+ *        Mode is applied on the next start.
+ *
+ * @param [in] can CAN interface.
+ * @param [in] enable true - listen-only mode, false - normal mode.
+ */
+int mdp_can_set_listen(struct mdp_can *can, bool enable);
+
+/**
+ * @brief Handle the message with given ID right at reception time.
+ *        Hook is called from the RX interrupt context.
+ *
+ * @param [in] can CAN interface.
+ * @param [in] id Message ID.
+ * @param [in] hook Function to call on reception.
+ *
+ * @return 0 on success, -ENOTSUP if the controller can't do it.
+ */
+int mdp_can_set_prio_hook(struct mdp_can *can, uint32_t id,
+			  void (*hook)(const struct mdp_can_msg *msg));
+
+/**
+ * @brief Get number of received frames lost by the controller: RX FIFO
+ *        or buffer overruns and queue drops. Controllers flag an
+ *        overrun, not the number of frames lost in it, so the count is
+ *        a lower bound.
+ *
+ * @param [in] can CAN interface.
+ *
+ * @return Number of frames since power-on, 0 if the controller can't
+ *         tell.
+ */
+uint32_t mdp_can_rx_lost(struct mdp_can *can);
+
+/**
+ * @brief Get reception time of the last message read. Controllers that
+ *        are not served in interrupt give the time it was read.
+ *
+ * @param [in] can CAN interface.
+ *
+ * @return Time in microseconds, low 32 bits of mdp_tm_us().
+ */
+uint32_t mdp_can_rx_us(struct mdp_can *can);
+
+/**
+ * @brief Assign CAN controllers to the bus segments according to
+ *        MDP_CAN_HAL_ROLE. In auto mode both ports are started in
+ *        listen-only mode for MDP_CAN_ROLES_SAMPLE_MS and the on-chip
+ *        controller gets the segment with more traffic.
+ *        Interfaces are returned stopped.
+ *
+ * @param [out] pjb Interface facing the PJB (vehicle) segment.
+ * @param [out] dp Interface facing the display segment.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_can_assign_roles(struct mdp_can *pjb, struct mdp_can *dp);
+
+/**
+ * @brief Report failed read/write, interface enters recovery.
+ *
+ * @param [in] can CAN interface.
+ * @param [in] err Error code returned by read/write.
+ */
+void mdp_can_fault(struct mdp_can *can, int err);
+
+/**
+ * @brief Advance recovery state machine, must be called before
+ *        every read/write. Never blocks.
+ *
+ * @param [in] can CAN interface.
+ *
+ * @return true if interface is operational, false if still recovering.
+ */
+bool mdp_can_recover(struct mdp_can *can);
+
+/**
+ * @brief Print recovery statistics.
+ *
+ * @param [in] can CAN interface.
+ */
+void mdp_can_print_stats(struct mdp_can *can);
+
 struct mdp_can mdp_get_can_hal_interface(void);
 struct mdp_can mdp_get_can_spi_interface(void);
 
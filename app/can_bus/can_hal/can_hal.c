@@ -3,15 +3,133 @@
 #include "log.h"
 
 #include <errno.h>
+#include <string.h>
 
 #ifdef MDP_MODULE
 #undef MDP_MODULE
 #endif
 #define MDP_MODULE "can_hal"
 
-#define MDP_HAL_CAN_MIN_MSG_LEN	8
+#define MDP_HAL_CAN_MIN_MSG_LEN	0
 #define MDP_HAL_CAN_MAX_MSG_LEN	8
 
+#define MDP_HAL_CAN_PRIO_BANK	1
+#define MDP_HAL_CAN_STDID_SHIFT	5	/* STDID position in filter IdHigh */
+
+static uint32_t prio_id;
+static void (*prio_hook)(const struct mdp_can_msg *msg);
+
+struct can_hal_entry {
+	struct mdp_can_msg msg;
+	uint32_t us;		/* Reception time */
+};
+
+/* Single producer (RX1 interrupt), single consumer (main loop) */
+static struct can_hal_entry prio_queue[MDP_HAL_CAN_PRIO_QUEUE_LEN];
+static volatile uint32_t prio_head, prio_tail;
+static uint32_t prio_drops;
+
+static uint32_t rx_us;		/* Reception time of the last frame read */
+
+static uint32_t rx_ovr;
+
+static bool listen_only;
+
+int mdp_can_hal_set_listen(bool enable)
+{
+	listen_only = enable;
+	return 0;
+}
+
+int mdp_can_hal_set_prio_id(uint32_t id,
+			    void (*hook)(const struct mdp_can_msg *msg))
+{
+	prio_id = id;
+	prio_hook = hook;
+	return 0;
+}
+
+static int can_hal_prio_start(void)
+{
+	CAN_FilterTypeDef filter_conf;
+	uint32_t id = prio_id << MDP_HAL_CAN_STDID_SHIFT;
+	int ret = 0;
+
+	/**
+	 * Identifier list filters have priority over mask filters of the
+	 * same scale, so the message matches this bank only and goes to
+	 * FIFO1. A 16-bit bank would lose to the 32-bit accept-all bank.
+	 */
+	filter_conf.FilterBank = MDP_HAL_CAN_PRIO_BANK;
+	filter_conf.FilterMode = CAN_FILTERMODE_IDLIST;
+	filter_conf.FilterScale = CAN_FILTERSCALE_32BIT;
+	filter_conf.FilterIdHigh = id;
+	filter_conf.FilterIdLow = 0;
+	filter_conf.FilterMaskIdHigh = id;
+	filter_conf.FilterMaskIdLow = 0;
+	filter_conf.FilterFIFOAssignment = CAN_RX_FIFO1;
+	filter_conf.FilterActivation = ENABLE;
+	filter_conf.SlaveStartFilterBank = 14;
+
+	ret = HAL_CAN_ConfigFilter(&hcan, &filter_conf);
+	if (ret) {
+		log_err("Config prio filter failed: 0x%lx\r\n", hcan.ErrorCode);
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
+static bool can_hal_prio_pop(uint32_t *msg_id, uint8_t *data, uint32_t *size)
+{
+	struct can_hal_entry *entry;
+	uint32_t tail = prio_tail;
+
+	if (tail == prio_head)
+		return false;
+
+	entry = &prio_queue[tail & (MDP_HAL_CAN_PRIO_QUEUE_LEN - 1)];
+	*msg_id = entry->msg.id;
+	*size = entry->msg.size;
+	memcpy(data, entry->msg.data, entry->msg.size);
+	rx_us = entry->us;
+
+	prio_tail = tail + 1;
+	return true;
+}
+
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+	CAN_RxHeaderTypeDef rx_header;
+	struct can_hal_entry drop, *entry = &drop;
+	uint32_t head = prio_head;
+	bool full = (head - prio_tail >= MDP_HAL_CAN_PRIO_QUEUE_LEN);
+
+	/* Hook is called even if the queue is full */
+	if (!full)
+		entry = &prio_queue[head & (MDP_HAL_CAN_PRIO_QUEUE_LEN - 1)];
+
+	entry->us = (uint32_t)mdp_tm_us();
+
+	if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO1, &rx_header,
+				 entry->msg.data))
+		return;
+
+	entry->msg.id = rx_header.StdId;
+	entry->msg.size = rx_header.DLC;
+
+	/* In listen-only mode every message comes here */
+	if (prio_hook && entry->msg.id == prio_id)
+		prio_hook(&entry->msg);
+
+	if (full) {
+		prio_drops++;
+		return;
+	}
+
+	prio_head = head + 1;
+}
+
 int mdp_can_hal_start(void)
 {
 	CAN_FilterTypeDef filter_conf;
@@ -24,7 +142,9 @@ int mdp_can_hal_start(void)
 	filter_conf.FilterIdLow = 0x0000;
 	filter_conf.FilterMaskIdHigh = 0x0000;
 	filter_conf.FilterMaskIdLow = 0x0000;
-	filter_conf.FilterFIFOAssignment = CAN_RX_FIFO0;
+	/* Listen-only: every message is read and stamped in interrupt */
+	filter_conf.FilterFIFOAssignment = listen_only ? CAN_RX_FIFO1 :
+							 CAN_RX_FIFO0;
 	filter_conf.FilterActivation = ENABLE;
 	filter_conf.SlaveStartFilterBank = 14;
 
@@ -34,6 +154,28 @@ int mdp_can_hal_start(void)
 		return -EFAULT;
 	}
 
+	if (prio_hook) {
+		ret = can_hal_prio_start();
+		if (ret)
+			return ret;
+	}
+
+	if (prio_hook || listen_only) {
+		ret = HAL_CAN_ActivateNotification(&hcan,
+						   CAN_IT_RX_FIFO1_MSG_PENDING);
+		if (ret) {
+			log_err("Activate notification failed: 0x%lx\r\n",
+				hcan.ErrorCode);
+			return -EFAULT;
+		}
+	}
+
+	/* Controller is in initialization mode here, BTR is writable */
+	if (listen_only)
+		SET_BIT(hcan.Instance->BTR, CAN_BTR_SILM);
+	else
+		CLEAR_BIT(hcan.Instance->BTR, CAN_BTR_SILM);
+
 	ret = HAL_CAN_Start(&hcan);
 	if (ret) {
 		log_err("CAN start failed: 0x%lx\r\n", hcan.ErrorCode);
@@ -66,6 +208,9 @@ int mdp_can_hal_read(uint32_t *msg_id, uint8_t *data, uint32_t *size)
 		return -EFAULT;
 	}
 
+	if (can_hal_prio_pop(msg_id, data, size))
+		return 1;
+
 	if (!HAL_CAN_GetRxFifoFillLevel(&hcan, CAN_RX_FIFO0))
 		return 0;
 
@@ -77,8 +222,9 @@ int mdp_can_hal_read(uint32_t *msg_id, uint8_t *data, uint32_t *size)
 
 	*msg_id = rx_header.StdId;
 	*size = rx_header.DLC;
+	rx_us = (uint32_t)mdp_tm_us();
 
-	return *size;
+	return 1;
 }
 
 int mdp_can_hal_write(uint32_t msg_id, uint8_t *data, uint32_t size)
@@ -105,6 +251,9 @@ int mdp_can_hal_write(uint32_t msg_id, uint8_t *data, uint32_t size)
 	tx_header.StdId = msg_id;
 	tx_header.DLC = size;
 
+	if (!HAL_CAN_GetTxMailboxesFreeLevel(&hcan))
+		return -EBUSY;
+
 	ret = HAL_CAN_AddTxMessage(&hcan, &tx_header, data, &tx_mailbox);
 	if (ret) {
 		log_err("CAN write failed: 0x%lx\r\n", hcan.ErrorCode);
@@ -113,3 +262,38 @@ int mdp_can_hal_write(uint32_t msg_id, uint8_t *data, uint32_t size)
 
 	return size;
 }
+
+uint32_t mdp_can_hal_rx_lost(void)
+{
+	/* FIFOs are not locked, the flag means the last frame was replaced */
+	if (__HAL_CAN_GET_FLAG(&hcan, CAN_FLAG_FOV0)) {
+		__HAL_CAN_CLEAR_FLAG(&hcan, CAN_FLAG_FOV0);
+		rx_ovr++;
+	}
+
+	if (__HAL_CAN_GET_FLAG(&hcan, CAN_FLAG_FOV1)) {
+		__HAL_CAN_CLEAR_FLAG(&hcan, CAN_FLAG_FOV1);
+		rx_ovr++;
+	}
+
+	return rx_ovr + prio_drops;
+}
+
+uint32_t mdp_can_hal_rx_us(void)
+{
+	return rx_us;
+}
+
+int mdp_can_hal_check(void)
+{
+	uint32_t esr = hcan.Instance->ESR;
+
+	/* Automatic bus-off management is disabled, so it needs reinit */
+	if (esr & CAN_ESR_BOFF)
+		return -ENETDOWN;
+
+	if (esr & CAN_ESR_EPVF)
+		return -EAGAIN;
+
+	return 0;
+}
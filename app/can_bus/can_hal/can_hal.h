@@ -11,12 +11,34 @@
 #define __MDP_CAN_HAL_H__
 
 #include "stm32f1xx_hal.h"
+#include "can_bus_def.h"
+
+#include <stdbool.h>
+
+#define MDP_HAL_CAN_PRIO_QUEUE_LEN	16	/* Must be power of two */
 
 extern CAN_HandleTypeDef hcan;
 
+/**
+ * @brief Route one message ID to a dedicated FIFO, served in interrupt.
+ *        The hook is called in interrupt context at reception time,
+ *        then the message is queued and returned by mdp_can_hal_read()
+ *        ahead of other messages. Must be called before start.
+ *        In listen-only mode all messages take this path.
+ *
+ * @param [in] id Standard message ID.
+ * @param [in] hook Function to call on reception.
+ */
+int mdp_can_hal_set_prio_id(uint32_t id,
+			    void (*hook)(const struct mdp_can_msg *msg));
+
 int mdp_can_hal_start(void);
 int mdp_can_hal_stop(void);
 int mdp_can_hal_read(uint32_t *msg_id, uint8_t *data, uint32_t *size);
 int mdp_can_hal_write(uint32_t msg_id, uint8_t *data, uint32_t size);
+int mdp_can_hal_check(void);
+int mdp_can_hal_set_listen(bool enable);
+uint32_t mdp_can_hal_rx_lost(void);
+uint32_t mdp_can_hal_rx_us(void);
 
 #endif /* __MDP_CAN_HAL_H__*/
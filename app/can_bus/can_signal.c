@@ -0,0 +1,51 @@
+/**
+ * @file       can_signal.c
+ * @brief      Generic CAN signal decoder.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "can_signal.h"
+
+#include "log.h"
+
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "can_signal"
+
+int32_t mdp_can_signal_decode(const struct mdp_can_signal *sig,
+			      const uint8_t *data)
+{
+	uint32_t raw = mdp_sig_raw(data, sig->start, sig->len, sig->order);
+
+	return mdp_sig_phys(raw, sig->len, sig->is_signed, sig->scale_num,
+			    sig->scale_den, sig->offset);
+}
+
+const struct mdp_can_signal *mdp_can_signal_find(
+	const struct mdp_can_signal *table, size_t cnt, const char *name)
+{
+	for (size_t i = 0; i < cnt; i++) {
+		if (!strcmp(table[i].name, name))
+			return &table[i];
+	}
+
+	return NULL;
+}
+
+void mdp_can_signal_print(const struct mdp_can_signal *table, size_t cnt,
+			  uint32_t msg, uint32_t id, const uint8_t *data)
+{
+	for (size_t i = 0; i < cnt; i++) {
+		if (table[i].id != msg)
+			continue;
+
+		log_sys("0x%03lX %-12s %ld\r\n", id, table[i].name,
+			mdp_can_signal_decode(&table[i], data));
+	}
+}
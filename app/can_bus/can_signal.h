@@ -0,0 +1,143 @@
+/**
+ * @file       can_signal.h
+ * @brief      DBC-like CAN signal description and extraction.
+ *
+ *             Signals are described in X-macro tables, one row per
+ *             signal: name, message ID, start bit, length, byte order,
+ *             signedness, scale (numerator/denominator) and offset.
+ *             Bit numbering follows DBC conventions:
+ *                 1. Little-endian (Intel): start bit is the LSB,
+ *                    bit N is bit (N % 8) of byte (N / 8).
+ *                 2. Big-endian (Motorola): start bit is the MSB,
+ *                    numbered in the same way.
+ *
+ *             MDP_SIG_EXTRACTOR() turns a row into an inline function
+ *             with constant arguments, so the compiler reduces it to a
+ *             few loads, shifts and masks without any loops or branches.
+ *             The same table also builds struct mdp_can_signal arrays for
+ *             the generic decoder, used where speed doesn't matter
+ *             (console, host tools).
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_CAN_SIGNAL_H__
+#define __MDP_CAN_SIGNAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define MDP_SIG_LE	0	/* Intel byte order */
+#define MDP_SIG_BE	1	/* Motorola byte order */
+
+#define __mdp_sig_inline	static inline __attribute__((always_inline))
+
+struct mdp_can_signal {
+	const char *name;
+	uint32_t id;		/* Message ID, or role if shared by profiles */
+	uint8_t start;
+	uint8_t len;		/* 1..32 bits */
+	uint8_t order;
+	bool is_signed;
+	int32_t scale_num;
+	int32_t scale_den;
+	int32_t offset;
+};
+
+__mdp_sig_inline uint32_t mdp_sig_raw(const uint8_t *data, unsigned start,
+				      unsigned len, unsigned order)
+{
+	unsigned first = start / 8, last;
+	uint64_t raw = 0;
+	int shift;
+
+	if (order == MDP_SIG_LE) {
+		last = (start + len - 1) / 8;
+		for (int i = last; i >= (int)first; i--)
+			raw = (raw << 8) | data[i];
+		shift = start % 8;
+	} else {
+		/* Bits left after the MSB byte, counted towards LSB */
+		int rest = (int)len - (int)(start % 8) - 1;
+
+		last = first + (rest > 0 ? (rest + 7) / 8 : 0);
+		for (unsigned i = first; i <= last; i++)
+			raw = (raw << 8) | data[i];
+		shift = rest > 0 ? (8 - rest % 8) % 8 : -rest;
+	}
+
+	raw >>= shift;
+	return (uint32_t)(raw & ((1ULL << len) - 1));
+}
+
+__mdp_sig_inline int32_t mdp_sig_phys(uint32_t raw, unsigned len,
+				      bool is_signed, int32_t num, int32_t den,
+				      int32_t offset)
+{
+	int64_t val = raw;
+
+	if (is_signed && (raw & (1UL << (len - 1))))
+		val -= (int64_t)1 << len;
+
+	return (int32_t)(val * num / den + offset);
+}
+
+/**
+ * Defines "<prefix>_<name>(data)" returning the physical value and
+ * "<prefix>_<name>_raw(data)" returning the raw value of a signal.
+ */
+#define MDP_SIG_EXTRACTOR(prefix, name, id, start, len, order, sgn, num,   \
+			  den, off)					     \
+	__mdp_sig_inline uint32_t prefix##_##name##_raw(const uint8_t *data) \
+	{								     \
+		return mdp_sig_raw(data, start, len, order);		     \
+	}								     \
+	__mdp_sig_inline int32_t prefix##_##name(const uint8_t *data)	     \
+	{								     \
+		return mdp_sig_phys(prefix##_##name##_raw(data), len, sgn,   \
+				    num, den, off);			     \
+	}
+
+/* Builds struct mdp_can_signal initializer from a table row */
+#define MDP_SIG_ENTRY(name, id, start, len, order, sgn, num, den, off)	\
+	{ #name, id, start, len, order, sgn, num, den, off },
+
+/**
+ * @brief Generic signal decoder.
+ *
+ * @param [in] sig Signal description.
+ * @param [in] data Message data, must have enough bytes for the signal.
+ *
+ * @return Physical value of the signal.
+ */
+int32_t mdp_can_signal_decode(const struct mdp_can_signal *sig,
+			      const uint8_t *data);
+
+/**
+ * @brief Find signal by name.
+ *
+ * @param [in] table Signal table.
+ * @param [in] cnt Number of signals in the table.
+ * @param [in] name Signal name.
+ *
+ * @return Signal description or NULL if not found.
+ */
+const struct mdp_can_signal *mdp_can_signal_find(
+	const struct mdp_can_signal *table, size_t cnt, const char *name);
+
+/**
+ * @brief Print all signals of the message with their physical values.
+ *
+ * @param [in] table Signal table.
+ * @param [in] cnt Number of signals in the table.
+ * @param [in] msg Message as given in the table, ID or role.
+ * @param [in] id Message ID on the bus, printed with every signal.
+ * @param [in] data Message data.
+ */
+void mdp_can_signal_print(const struct mdp_can_signal *table, size_t cnt,
+			  uint32_t msg, uint32_t id, const uint8_t *data);
+
+#endif /* __MDP_CAN_SIGNAL_H__ */
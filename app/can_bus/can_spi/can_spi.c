@@ -4,12 +4,21 @@
 #include "mcp2515.h"
 
 #include <errno.h>
+#include <stdbool.h>
 
 #ifdef MDP_MODULE
 #undef MDP_MODULE
 #endif
 #define MDP_MODULE "can_spi"
 
+static bool listen_only;
+
+int mdp_can_spi_set_listen(bool enable)
+{
+	listen_only = enable;
+	return 0;
+}
+
 int mdp_can_spi_start(void)
 {
 	/**
@@ -45,14 +54,89 @@ int mdp_can_spi_start(void)
 		return ret;
 	}
 
+	/* Keep up to two messages in hardware while SPI side is busy */
+	ret = mcp2515_enable_rollover();
+	if (ret) {
+		log_err("Rollover enable failed: %s!\r\n", strerror(ret));
+		return ret;
+	}
+
+	if (listen_only) {
+		ret = mcp2515_listen_mode();
+		if (ret) {
+			log_err("Listen-only mode failed: %s!\r\n",
+				strerror(ret));
+			return ret;
+		}
+	}
+
 	return ret;
 }
 
 int mdp_can_spi_stop(void)
 {
+	int ret = 0;
+
+	/* Reset puts MCP2515 into configuration mode, it leaves the bus */
+	ret = mcp2515_reset();
+	if (ret)
+		log_err("Reset failed: %d\r\n", ret);
+
+	return ret;
+}
+
+int mdp_can_spi_check(void)
+{
+	int ret = 0;
+
+	ret = mcp2515_check_bus_on();
+	if (ret < 0)
+		return ret;
+	if (!ret)
+		return -ENETDOWN;
+
+	ret = mcp2515_check_passive_tx_error();
+	if (ret < 0)
+		return ret;
+	if (ret)
+		return -EAGAIN;
+
+	ret = mcp2515_check_passive_rx_error();
+	if (ret < 0)
+		return ret;
+	if (ret)
+		return -EAGAIN;
+
 	return 0;
 }
 
+void mdp_can_spi_print_stats(void)
+{
+	mcp2515_rx_stats_t stats;
+
+	mcp2515_get_rx_stats(&stats);
+
+	log_sys("RXB0: rx %lu, overflow %lu\r\n", stats.rx[MCP2515_RXB0],
+		stats.ovr[MCP2515_RXB0]);
+	log_sys("RXB1: rx %lu, overflow %lu\r\n", stats.rx[MCP2515_RXB1],
+		stats.ovr[MCP2515_RXB1]);
+}
+
+uint32_t mdp_can_spi_rx_lost(void)
+{
+	mcp2515_rx_stats_t stats;
+
+	/* Overflow flags are checked and counted by mcp2515_rx_message() */
+	mcp2515_get_rx_stats(&stats);
+
+	return stats.ovr[MCP2515_RXB0] + stats.ovr[MCP2515_RXB1];
+}
+
+void mdp_can_spi_update_clock(void)
+{
+	mcp2515_update_clock();
+}
+
 int mdp_can_spi_read(uint32_t *msg_id, uint8_t *data, uint32_t *size)
 {
 	int ret = 0;
@@ -65,6 +149,9 @@ int mdp_can_spi_read(uint32_t *msg_id, uint8_t *data, uint32_t *size)
 	}
 
 	ret = mcp2515_rx_message(&msg);
+	if (ret == -ENODATA)
+		return 0;
+
 	if (ret) {
 		log_err("CAN read failed: %d\r\n", ret);
 		return ret;
@@ -74,7 +161,7 @@ int mdp_can_spi_read(uint32_t *msg_id, uint8_t *data, uint32_t *size)
 	*size = msg.size;
 	memcpy(data, msg.data, msg.size);
 
-	return ret;
+	return 1;
 }
 
 int mdp_can_spi_write(uint32_t msg_id, uint8_t *data, uint32_t size)
@@ -94,7 +181,7 @@ int mdp_can_spi_write(uint32_t msg_id, uint8_t *data, uint32_t size)
 	memcpy(msg.data, data, size);
 
 	ret = mcp2515_tx_message(MCP2515_TX_BUF_AUTO, &msg);
-	if (ret)
+	if (ret && ret != -EBUSY)
 		log_err("CAN write failed: %d\r\n", ret);
 
 	return ret;
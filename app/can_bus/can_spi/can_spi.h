@@ -11,10 +11,23 @@
 #define __MDP_CAN_SPI_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 int mdp_can_spi_start(void);
 int mdp_can_spi_stop(void);
 int mdp_can_spi_read(uint32_t *msg_id, uint8_t *data, uint32_t *size);
 int mdp_can_spi_write(uint32_t msg_id, uint8_t *data, uint32_t size);
+int mdp_can_spi_check(void);
+int mdp_can_spi_set_listen(bool enable);
+uint32_t mdp_can_spi_rx_lost(void);
+void mdp_can_spi_print_stats(void);
+
+/* Must be called after the system clock change */
+void mdp_can_spi_update_clock(void);
+
+/**
+ * @brief Run MCP2515 SPI transaction microbenchmarks and print results.
+ */
+void mdp_can_spi_bench(void);
 
 #endif /* __MDP_CAN_SPI_H__*/
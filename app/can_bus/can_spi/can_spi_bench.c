@@ -0,0 +1,113 @@
+/**
+ * @file       can_spi_bench.c
+ * @brief      MCP2515 SPI transaction microbenchmarks.
+ *
+ *             Every benchmark repeats a typical driver transaction
+ *             (CS low, transfer, CS high) and reports the average cost
+ *             in core cycles and microseconds. Only non-destructive
+ *             transactions are used, so the benchmark may be run while
+ *             the gateway is working.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "can_spi.h"
+#include "common.h"
+#include "log.h"
+#include "mcp2515_regs.h"
+#include "mcp2515_spi_intf.h"
+
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "spi_bench"
+
+#define SPI_BENCH_ITERATIONS	256
+#define SPI_BENCH_BUF_SIZE	16
+#define SPI_BENCH_DUMMY		0xFF
+
+#if (MDP_MCP2515_SPI_FAST == 1)
+#define SPI_BENCH_TRANSPORT	"register"
+#else
+#define SPI_BENCH_TRANSPORT	"HAL"
+#endif
+
+struct spi_bench {
+	const char *name;
+	uint8_t tx[SPI_BENCH_BUF_SIZE];
+	uint8_t len;
+};
+
+static const struct spi_bench spi_benches[] = {
+	{
+		.name = "READ_STATUS",
+		.tx = { MCP2515_READ_STATUS, SPI_BENCH_DUMMY },
+		.len = 2,
+	},
+	{
+		.name = "READ",
+		.tx = { MCP2515_READ, MCP2515_CANSTAT, SPI_BENCH_DUMMY },
+		.len = 3,
+	},
+	{
+		/* Zero mask, register is left unchanged */
+		.name = "BIT_MODIFY",
+		.tx = { MCP2515_BIT_MOD, MCP2515_CANINTF, 0x00, 0x00 },
+		.len = 4,
+	},
+	{
+		/* Same size as READ RX BUFFER, but doesn't clear RXnIF */
+		.name = "READ_RXB0",
+		.tx = { MCP2515_READ, MCP2515_RXB0SIDH },
+		.len = 15,
+	},
+};
+
+static int spi_bench_run(const struct spi_bench *bench, uint32_t *cycles)
+{
+	int ret = 0;
+	uint8_t tx[SPI_BENCH_BUF_SIZE];
+	uint8_t rx[SPI_BENCH_BUF_SIZE];
+	struct mdp_time tm;
+
+	memcpy(tx, bench->tx, sizeof(tx));
+
+	mdp_tm_measure_start(&tm);
+
+	for (uint32_t i = 0; i < SPI_BENCH_ITERATIONS; i++) {
+		mcp2515_intf_spi_cs_low();
+		ret |= mcp2515_intf_spi_transfer(tx, rx, bench->len);
+		mcp2515_intf_spi_cs_high();
+	}
+
+	mdp_tm_measure_stop(&tm);
+
+	*cycles = tm.cycles / SPI_BENCH_ITERATIONS;
+
+	return ret;
+}
+
+void mdp_can_spi_bench(void)
+{
+	uint32_t cycles;
+
+	log_sys("Transport: %s, %u iterations\r\n", SPI_BENCH_TRANSPORT,
+		SPI_BENCH_ITERATIONS);
+	log_sys("%-12s %5s %8s %8s\r\n", "transaction", "bytes", "cycles",
+		"usec");
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(spi_benches); i++) {
+		if (spi_bench_run(&spi_benches[i], &cycles)) {
+			log_err("%s failed\r\n", spi_benches[i].name);
+			continue;
+		}
+
+		log_sys("%-12s %5u %8lu %8lu\r\n", spi_benches[i].name,
+			spi_benches[i].len, cycles,
+			mdp_tm_cycles_to_us(cycles));
+	}
+}
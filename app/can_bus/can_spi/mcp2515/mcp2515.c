@@ -10,6 +10,7 @@
 #include "mcp2515.h"
 #include "mcp2515_internal.h"
 #include "mcp2515_spi_intf.h"
+#include "prof.h"
 
 #define spi_tx(byte)                                                           \
 	({                                                                     \
@@ -19,11 +20,16 @@
 #define spi_rx(byte)		mcp2515_intf_spi_receive(byte, sizeof(*byte));
 #define spi_rx_buf(buf, len)	mcp2515_intf_spi_receive(buf, len)
 #define spi_tx_buf(buf, len)	mcp2515_intf_spi_transmit(buf, len)
+#define spi_xfer(tx, rx, len)	mcp2515_intf_spi_transfer(tx, rx, len)
 
+#define spi_init()		mcp2515_intf_spi_init()
+#define spi_update_clock()	mcp2515_intf_spi_update_clock()
 #define spi_ready()		mcp2515_intf_spi_ready()
 #define spi_cs_high()		mcp2515_intf_spi_cs_high()
 #define spi_cs_low()		mcp2515_intf_spi_cs_low()
 
+#define SPI_DUMMY		0xFF	/* Byte clocked out while reading */
+
 #define mcp2515_config_on()	mcp2515_set_mode(MCP2515_CONFIG_MODE)
 #define mcp2515_config_off()	mcp2515_set_mode(MCP2515_NORMAL_MODE)
 
@@ -160,48 +166,72 @@ static uint32_t mcp2515_reg_to_canid(mcp2515_canid_type_t id_type,
 	return can_id;
 }
 
+/**
+ * RXBnSIDL bit 3: Extended Identifier Flag bit (IDE).
+ * RXBnSIDL bit 4: Standard Frame Remote Transmit Request bit (SRR).
+ * RXBnDLC  bit 6: Extended Frame Remote Transmission Request bit (RTR).
+ */
+static mcp2515_canid_type_t mcp2515_reg_to_type(mcp2515_buf_regs_t *reg)
+{
+	if (reg->id_regs.sid_l & (1 << 3))
+		return (reg->dlc & (1 << 6)) ? MCP2515_MSG_EXD_REMOTE :
+					       MCP2515_MSG_EXD_DATA;
+
+	return (reg->id_regs.sid_l & (1 << 4)) ? MCP2515_MSG_STD_REMOTE :
+						 MCP2515_MSG_STD_DATA;
+}
+
+static mcp2515_rx_stats_t rx_stats;
+
+/* RXB1 message is older than the one in RXB0 */
+static bool rxb1_first;
+
 static int mcp2515_modify_bit(uint8_t addr, uint8_t mask, uint8_t data)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_BIT_MOD, addr, mask, data };
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_BIT_MOD);
-	ret |= spi_tx(addr);
-	ret |= spi_tx(mask);
-	ret |= spi_tx(data);
+	ret |= spi_tx_buf(tx, sizeof(tx));
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_read_status(mcp2515_status_t *status)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_READ_STATUS, SPI_DUMMY };
+	uint8_t rx[sizeof(tx)];
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_READ_STATUS);
-	ret |= spi_rx(&status->data);
+	ret |= spi_xfer(tx, rx, sizeof(tx));
 
 	spi_cs_high();
 
-	return ret;
+	status->data = rx[1];
+
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_read_rx_status(mcp2515_rx_status_t *rx_status)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_RX_STATUS, SPI_DUMMY };
+	uint8_t rx[sizeof(tx)];
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_RX_STATUS);
-	ret |= spi_rx(&rx_status->data);
+	ret |= spi_xfer(tx, rx, sizeof(tx));
 
 	spi_cs_high();
 
-	return ret;
+	rx_status->data = rx[1];
+
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_request_send(uint8_t instruction)
@@ -214,7 +244,7 @@ static int mcp2515_request_send(uint8_t instruction)
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_load_tx_seq(uint8_t instruction, mcp2515_buf_regs_t *regs)
@@ -224,28 +254,28 @@ static int mcp2515_load_tx_seq(uint8_t instruction, mcp2515_buf_regs_t *regs)
 	spi_cs_low();
 
 	ret |= spi_tx(instruction);
-	ret |= spi_tx_buf((uint8_t *)&regs->id_regs, sizeof(regs->id_regs));
-	ret |= spi_tx(regs->dlc);
-	ret |= spi_tx_buf((uint8_t *)&regs->buf, sizeof(regs->buf));
+	ret |= spi_tx_buf(regs->data, sizeof(regs->data));
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_read_byte(uint8_t addr, uint8_t *byte)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_READ, addr, SPI_DUMMY };
+	uint8_t rx[sizeof(tx)];
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_READ);
-	ret |= spi_tx(addr);
-	ret |= spi_rx(byte);
+	ret |= spi_xfer(tx, rx, sizeof(tx));
 
 	spi_cs_high();
 
-	return ret;
+	*byte = rx[2];
+
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_read_byte_seq(uint8_t instruction, uint8_t *data,
@@ -260,38 +290,37 @@ static int mcp2515_read_byte_seq(uint8_t instruction, uint8_t *data,
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_write_byte(uint8_t addr, uint8_t data)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_WRITE, addr, data };
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_WRITE);
-	ret |= spi_tx(addr);
-	ret |= spi_tx(data);
+	ret |= spi_tx_buf(tx, sizeof(tx));
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_write_byte_seq(uint8_t start_addr, uint8_t end_addr,
 				  uint8_t *data)
 {
 	int ret = EOK;
+	uint8_t tx[] = { MCP2515_WRITE, start_addr };
 
 	spi_cs_low();
 
-	ret |= spi_tx(MCP2515_WRITE);
-	ret |= spi_tx(start_addr);
-	ret |= spi_rx_buf(data, end_addr - start_addr + 1);
+	ret |= spi_tx_buf(tx, sizeof(tx));
+	ret |= spi_tx_buf(data, end_addr - start_addr + 1);
 
 	spi_cs_high();
 
-	return ret;
+	return ret ? -EIO : EOK;
 }
 
 static int mcp2515_set_mode(mcp2515_mode_t mode)
@@ -301,7 +330,7 @@ static int mcp2515_set_mode(mcp2515_mode_t mode)
 	uint32_t tries_cnt = MCP2515_SET_OPMODE_TRIES;
 
 	if (mode != MCP2515_CONFIG_MODE && mode != MCP2515_NORMAL_MODE &&
-	    mode != MCP2515_SLEEP_MODE)
+	    mode != MCP2515_SLEEP_MODE && mode != MCP2515_LISTEN_MODE)
 		return -EINVAL;
 
 	ret = mcp2515_write_byte(MCP2515_CANCTRL, (uint8_t)mode);
@@ -336,6 +365,9 @@ int mcp2515_init(mcp2515_osc_t osc, mcp2515_speed_t speed)
 	if (!spi_ready())
 		return -EBUSY;
 
+	spi_init();
+	spi_update_clock();
+
 	ret = mcp2515_config_on();
 	if (ret != EOK)
 		return ret;
@@ -401,6 +433,38 @@ int mcp2515_apply_filters(mcp2515_rxb_t rxb, mcp2515_rx_filter_t *filter)
 	return EOK;
 }
 
+int mcp2515_enable_rollover(void)
+{
+	return mcp2515_modify_bit(MCP2515_RXB0CTRL, MCP2515_RXB0CTRL_BUKT,
+				  MCP2515_RXB0CTRL_BUKT);
+}
+
+void mcp2515_get_rx_stats(mcp2515_rx_stats_t *stats)
+{
+	*stats = rx_stats;
+}
+
+static int mcp2515_check_rx_overflow(void)
+{
+	int ret = EOK;
+	uint8_t eflg = 0;
+
+	ret = mcp2515_read_byte(MCP2515_EFLG, &eflg);
+	if (ret != EOK)
+		return ret;
+
+	if (!(eflg & MCP2515_ERR_RXOVR_MASK))
+		return EOK;
+
+	if (eflg & MCP2515_ERR_RX0OVR)
+		rx_stats.ovr[MCP2515_RXB0]++;
+	if (eflg & MCP2515_ERR_RX1OVR)
+		rx_stats.ovr[MCP2515_RXB1]++;
+
+	/* Overflow flags are not cleared by hardware */
+	return mcp2515_modify_bit(MCP2515_EFLG, MCP2515_ERR_RXOVR_MASK, 0);
+}
+
 int mcp2515_messages_available(void)
 {
 	int ret = EOK;
@@ -451,16 +515,59 @@ int mcp2515_check_passive_tx_error(void)
 	return byte & MCP2515_ERR_TXEP;
 }
 
+/**
+ * Pick TX buffer for the next frame.
+ *
+ * Pending buffers of equal priority are sent from the highest number down,
+ * so in auto mode a frame is loaded only below every pending buffer,
+ * otherwise it could overtake frames written before it.
+ */
+static int mcp2515_select_tx_buf(mcp2515_tx_buf_t tx_buf,
+				 mcp2515_status_t status)
+{
+	bool pending[MCP2515_TX_BUF_NUM] = {
+		status.tx0_req, status.tx1_req, status.tx2_req
+	};
+	int buf;
+
+	if (tx_buf >= MCP2515_TX_BUF0 && tx_buf <= MCP2515_TX_BUF2) {
+		buf = tx_buf - MCP2515_TX_BUF0;
+		return pending[buf] ? -EBUSY : buf;
+	}
+
+	/* Invalid TX buffer is treated as auto */
+	for (buf = 0; buf < MCP2515_TX_BUF_NUM; buf++) {
+		if (pending[buf])
+			break;
+	}
+
+	return buf ? buf - 1 : -EBUSY;
+}
+
 int mcp2515_tx_message(mcp2515_tx_buf_t tx_buf, mcp2515_can_msg_t *tx_msg)
 {
+	static const uint8_t load_cmd[MCP2515_TX_BUF_NUM] = {
+		MCP2515_LOAD_TXB0SIDH, MCP2515_LOAD_TXB1SIDH,
+		MCP2515_LOAD_TXB2SIDH
+	};
+	static const uint8_t rts_cmd[MCP2515_TX_BUF_NUM] = {
+		MCP2515_RTS_TX0, MCP2515_RTS_TX1, MCP2515_RTS_TX2
+	};
 	int ret = EOK;
+	int buf;
 	mcp2515_status_t tx_status;
 	mcp2515_buf_regs_t tx_regs;
 
+	MDP_PROF_SCOPE(MDP_PROF_MCP2515_TX);
+
 	ret = mcp2515_read_status(&tx_status);
 	if (ret != EOK)
 		return ret;
 
+	buf = mcp2515_select_tx_buf(tx_buf, tx_status);
+	if (buf < 0)
+		return buf;
+
 	mcp2515_canid_to_reg(tx_msg->id, tx_msg->id_type, &tx_regs);
 
 	/* Trim message size if user don't read docs */
@@ -482,47 +589,8 @@ int mcp2515_tx_message(mcp2515_tx_buf_t tx_buf, mcp2515_can_msg_t *tx_msg)
 		tx_regs.dlc |= 1 << 6;
 	}
 
-	switch (tx_buf) {
-	default:
-		/* Invalid TX buffer, treat as auto */
-		tx_buf = MCP2515_TX_BUF_AUTO;
-	case MCP2515_TX_BUF_AUTO:
-	case MCP2515_TX_BUF0:
-		if (!tx_status.tx0_int) {
-			ret |= mcp2515_load_tx_seq(MCP2515_LOAD_TXB0SIDH,
-						   &tx_regs);
-			ret |= mcp2515_request_send(MCP2515_RTS_TX0);
-
-			break;
-		}
-
-		if (tx_buf != MCP2515_TX_BUF_AUTO)
-			break;
-
-	case MCP2515_TX_BUF1:
-		if (!tx_status.tx1_int) {
-			ret |= mcp2515_load_tx_seq(MCP2515_LOAD_TXB1SIDH,
-						   &tx_regs);
-			ret |= mcp2515_request_send(MCP2515_RTS_TX1);
-
-			break;
-		}
-
-		if (tx_buf != MCP2515_TX_BUF_AUTO)
-			break;
-
-	case MCP2515_TX_BUF2:
-		if (!tx_status.tx1_int) {
-			ret |= mcp2515_load_tx_seq(MCP2515_LOAD_TXB2SIDH,
-						   &tx_regs);
-			ret |= mcp2515_request_send(MCP2515_RTS_TX2);
-
-			break;
-		}
-
-		if (tx_buf != MCP2515_TX_BUF_AUTO)
-			break;
-	}
+	ret |= mcp2515_load_tx_seq(load_cmd[buf], &tx_regs);
+	ret |= mcp2515_request_send(rts_cmd[buf]);
 
 	return ret;
 }
@@ -532,8 +600,11 @@ int mcp2515_rx_message(mcp2515_can_msg_t *rx_msg)
 	int ret = EOK;
 	mcp2515_rx_status_t rx_status = {
 		.data = 0
-	};
+	}, after;
 	mcp2515_buf_regs_t rx_regs;
+	bool both, rxb1;
+
+	MDP_PROF_SCOPE(MDP_PROF_MCP2515_RX);
 
 	ret = mcp2515_read_rx_status(&rx_status);
 	if (ret != EOK)
@@ -543,21 +614,60 @@ int mcp2515_rx_message(mcp2515_can_msg_t *rx_msg)
 	if (!rx_status.rx_buffer)
 		return -ENODATA;
 
-	if (rx_status.rx_buffer == MCP2515_MSG_RXB0 ||
-	    rx_status.rx_buffer == MCP2515_MSG_BOTH) {
+	/**
+	 * Overflow is possible only when both buffers are full, and they
+	 * stay full until read, so EFLG is read only in this case.
+	 */
+	if (rx_status.rx_buffer == MCP2515_MSG_BOTH) {
+		ret = mcp2515_check_rx_overflow();
+		if (ret != EOK)
+			return ret;
+	}
+
+	/**
+	 * With rollover the oldest message is in RXB0 only until it is read
+	 * with RXB1 still full: the next message goes to RXB0 again and is
+	 * newer than the one waiting in RXB1.
+	 */
+	both = rx_status.rx_buffer == MCP2515_MSG_BOTH;
+	rxb1 = rx_status.rx_buffer == MCP2515_MSG_RXB1 || (both && rxb1_first);
+
+	if (!rxb1) {
 		/* Read message from RXB0 buffer */
 		ret = mcp2515_read_byte_seq(MCP2515_READ_RXB0SIDH, rx_regs.data,
 					    sizeof(rx_regs.data));
+		rx_stats.rx[MCP2515_RXB0]++;
 	} else {
 		/* Read message from RXB1 buffer */
 		ret = mcp2515_read_byte_seq(MCP2515_READ_RXB1SIDH, rx_regs.data,
 					    sizeof(rx_regs.data));
+		rx_stats.rx[MCP2515_RXB1]++;
 	}
 
 	if (ret != EOK)
 		return ret;
 
-	rx_msg->id_type = rx_status.msg_type;
+	/**
+	 * After RXB0 is read, a message in RXB1 came while RXB0 was full,
+	 * so it is older than the next one in RXB0. If RXB1 was empty, it
+	 * may have been filled during the read, that needs one more look.
+	 */
+	if (rxb1) {
+		rxb1_first = false;
+	} else if (both) {
+		rxb1_first = true;
+	} else {
+		ret = mcp2515_read_rx_status(&after);
+		if (ret != EOK)
+			return ret;
+		rxb1_first = after.rx_buffer & MCP2515_MSG_RXB1;
+	}
+
+	/* RX STATUS reports the message type of RXB0 if both are full */
+	if (both && rxb1)
+		rx_msg->id_type = mcp2515_reg_to_type(&rx_regs);
+	else
+		rx_msg->id_type = rx_status.msg_type;
 	rx_msg->id = mcp2515_reg_to_canid(rx_msg->id_type, &rx_regs);
 	rx_msg->size = rx_regs.dlc;
 	memcpy(rx_msg->data, rx_regs.buf, rx_msg->size);
@@ -579,6 +689,11 @@ int mcp2515_sleep_mode(void)
 	return mcp2515_set_mode(MCP2515_SLEEP_MODE);
 }
 
+int mcp2515_listen_mode(void)
+{
+	return mcp2515_set_mode(MCP2515_LISTEN_MODE);
+}
+
 int mcp2515_reset(void)
 {
 	int ret = EOK;
@@ -589,5 +704,13 @@ int mcp2515_reset(void)
 
 	spi_cs_high();
 
-	return ret;
+	/* Both RX buffers are empty after reset */
+	rxb1_first = false;
+
+	return ret ? -EIO : EOK;
+}
+
+void mcp2515_update_clock(void)
+{
+	spi_update_clock();
 }
@@ -42,6 +42,14 @@
  */
 #define MCP2515_RXB1_FILTER_NUM 4
 
+/**
+ * @brief Number of TX Buffers.
+ *
+ *        NOTE: For more detail information please refer to
+ *              MCP2515 datasheet, page 15.
+ */
+#define MCP2515_TX_BUF_NUM 3
+
 /**
  * @brief CAN Bus message type enumeration.
  *
@@ -63,7 +71,7 @@ typedef enum {
  *              MCP2515 datasheet, page 15.
  */
 typedef enum {
-	MCP2515_TX_BUF_AUTO = 0, /* Select TX buffer automatically */
+	MCP2515_TX_BUF_AUTO = 0, /* Select TX buffer keeping frame order */
 	MCP2515_TX_BUF0, /* Select TX buffer 0 */
 	MCP2515_TX_BUF1, /* Select TX buffer 1 */
 	MCP2515_TX_BUF2, /* Select TX buffer 2 */
@@ -115,6 +123,18 @@ typedef enum {
 	__MCP2515_RXB_COUNT
 } mcp2515_rxb_t;
 
+/**
+ * @brief Receive statistics, per receive buffer.
+ *
+ *        Overflow is counted when a message is received while both
+ *        buffers are full (RXnOVR flags in EFLG register), such message
+ *        is lost.
+ */
+typedef struct mcp2515_rx_stats {
+	uint32_t rx[__MCP2515_RXB_COUNT]; /* Messages read from buffer */
+	uint32_t ovr[__MCP2515_RXB_COUNT]; /* Overflow events */
+} mcp2515_rx_stats_t;
+
 /**
  * @brief Receive buffer filter configuration structure.
  *
@@ -183,6 +203,22 @@ int mcp2515_init(mcp2515_osc_t osc, mcp2515_speed_t speed);
  */
 int mcp2515_apply_filters(mcp2515_rxb_t rxb, mcp2515_rx_filter_t *filter);
 
+/**
+ * @brief  Enable RXB0 to RXB1 rollover (BUKT bit).
+ *         Message received while RXB0 is full is written to RXB1,
+ *         so two messages may wait for reading instead of one.
+ *
+ * @return EOK if rollover enabled successfully, error code otherwise.
+ */
+int mcp2515_enable_rollover(void);
+
+/**
+ * @brief  Get receive statistics.
+ *
+ * @param  [out] stats Receive statistics.
+ */
+void mcp2515_get_rx_stats(mcp2515_rx_stats_t *stats);
+
 /**
  * @brief  Check for new received messages in MCP2515 buffers.
  *
@@ -232,7 +268,7 @@ int mcp2515_check_passive_rx_error(void);
  * @param  [in] tx_msg CAN Bus message.
  *
  * @return EOK if message transmitting finished successfully,
- *         error code otherwise.
+ *         -EBUSY if no suitable TX buffer is free, error code otherwise.
  */
 int mcp2515_tx_message(mcp2515_tx_buf_t tx_buf, mcp2515_can_msg_t *tx_msg);
 
@@ -254,6 +290,15 @@ int mcp2515_rx_message(mcp2515_can_msg_t *rx_msg);
  */
 int mcp2515_sleep_mode(void);
 
+/**
+ * @brief  Activate MCP2515 listen-only mode. Valid frames are received,
+ *         but the chip never transmits, not even ACK or error frames.
+ *
+ * @return EOK if MCP2515 listen-only mode activation finished
+ *         successfully, error code otherwise.
+ */
+int mcp2515_listen_mode(void);
+
 /**
  * @brief  Reinitialize the internal registers of the MCP2515 chip.
  *
@@ -262,4 +307,10 @@ int mcp2515_sleep_mode(void);
  */
 int mcp2515_reset(void);
 
+/**
+ * @brief  Recompute SPI clock prescaler after the MCU clock change,
+ *         so the SPI clock doesn't exceed MCP2515 limit.
+ */
+void mcp2515_update_clock(void);
+
 #endif /* __MDP_MCP2515_DRIVER_H__ */
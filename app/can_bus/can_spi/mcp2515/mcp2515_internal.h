@@ -24,6 +24,12 @@
 #define MCP2515_SET_OPMODE_TRIES (20000) /* Wait timeout for mode change */
 #define MCP2515_MAX_MSG_SIZE 8 /* MCP2515 can handle maximum 8-byte messages */
 
+/* Receive buffer control */
+#define MCP2515_RXB0CTRL_BUKT (1 << 2) /* Rollover enable bit */
+
+/* Receive buffers overflow flags in EFLG */
+#define MCP2515_ERR_RXOVR_MASK (MCP2515_ERR_RX0OVR | MCP2515_ERR_RX1OVR)
+
 /* Interrupts */
 #define MCP2515_WAKIF_MASK (1 << 6) /* Wakeup interrupt flag mask */
 #define MCP2515_WAKIF_SET (1 << 6) /* Wakeup interrupt flag set */
@@ -51,21 +57,23 @@ typedef enum {
 } mcp2515_error_flag_t;
 
 /**
- * @brief A union to map MCP2515 CAN interrupt flags and get chip status.
+ * @brief A union to map MCP2515 READ STATUS instruction result: RX
+ *        interrupt flags, TX request and TX interrupt flag of every
+ *        TX buffer. This is not the CANINTF register layout.
  *
  *        NOTE: For more detail information please refer to
- *              MCP2515 datasheet, page 54.
+ *              MCP2515 datasheet, page 70.
  */
 typedef union {
 	struct {
 		uint8_t rx0_int : 1; /* RX Buffer 0 Full Interrupt Flag bit */
 		uint8_t rx1_int : 1; /* RX Buffer 1 Full Interrupt Flag bit */
+		uint8_t tx0_req : 1; /* TX Buffer 0 Request to Send bit */
 		uint8_t tx0_int : 1; /* TX Buffer 0 Empty Interrupt Flag bit */
+		uint8_t tx1_req : 1; /* TX Buffer 1 Request to Send bit */
 		uint8_t tx1_int : 1; /* TX Buffer 1 Empty Interrupt Flag bit */
+		uint8_t tx2_req : 1; /* TX Buffer 2 Request to Send bit */
 		uint8_t tx2_int : 1; /* TX Buffer 2 Empty Interrupt Flag bit */
-		uint8_t err_int : 1; /*  Error Interrupt Flag bit */
-		uint8_t wake_int : 1; /* Wake-up Interrupt Flag bit */
-		uint8_t msg_err_int : 1; /* Message Error Interrupt Flag bit */
 	};
 	uint8_t data;
 } mcp2515_status_t;
@@ -119,8 +127,7 @@ typedef union {
 /**
  * @brief MCP2515 Modes of operation enumeration.
  *
- *        NOTE: Loopback and Listen-Only modes currently
- *              are not implemented.
+ *        NOTE: Loopback mode currently is not implemented.
  *
  *        NOTE: For more detail information please refer to
  *              MCP2515 datasheet, page 59.
@@ -128,6 +135,7 @@ typedef union {
 typedef enum {
 	MCP2515_NORMAL_MODE = 0x00,
 	MCP2515_SLEEP_MODE = 0x20,
+	MCP2515_LISTEN_MODE = 0x60,
 	MCP2515_CONFIG_MODE = 0x80
 } mcp2515_mode_t;
 
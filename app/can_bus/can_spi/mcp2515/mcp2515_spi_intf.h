@@ -3,6 +3,15 @@
  * @brief      SPI interface wrapper, the purpose is to use different MCU's
  *             with MCP2515 controller.
  *
+ *             Two transports are available for STM32F103xB:
+ *                 1. HAL transport, every call goes through HAL SPI API.
+ *                 2. Register transport (MDP_MCP2515_SPI_FAST), short
+ *                    transfers are done by writing DR and polling TXE/RXNE
+ *                    directly, chip select is driven through BSRR. Transfers
+ *                    longer than __MCU_SPI_FAST_MAX still go through HAL.
+ *
+ *             Host build (MDP_HOST) talks to the MCP2515 model instead.
+ *
  * @date       April 9, 2021
  * @author     Eduard Chaika <rampopula@gmail.com>
  * @copyright  Copyright (c) 2021 Eduard Chaika
@@ -13,6 +22,8 @@
 
 #include <stdbool.h>
 
+#include "boardinfo.h"
+
 #ifdef STM32F103xB
 #include "stm32f1xx_hal.h"
 
@@ -23,12 +34,100 @@ extern SPI_HandleTypeDef hspi1;
 
 #define __MCU_SPI_INTF (&hspi1)
 #define __MCU_SPI_TIMEOUT (10)
+
+#define __MCU_SPI_FAST_MAX (16) /* Maximum register transport transfer */
+#define __MCU_SPI_POLL_TRIES (1000) /* TXE/RXNE poll timeout */
+#define __MCU_SPI_DUMMY (0xFF) /* Byte to send while receiving */
+#define __MCU_SPI_MAX_HZ (10000000) /* MCP2515 maximum SPI clock */
+
+#if (MDP_MCP2515_SPI_FAST == 1)
+static inline int __mcp2515_spi_wait(SPI_TypeDef *spi, uint32_t flag)
+{
+	uint32_t tries = __MCU_SPI_POLL_TRIES;
+
+	while (!(spi->SR & flag)) {
+		if (!--tries)
+			return HAL_TIMEOUT;
+	}
+
+	return HAL_OK;
+}
+
+static inline int __mcp2515_spi_xfer(const uint8_t *tx, uint8_t *rx,
+				     uint16_t size)
+{
+	SPI_TypeDef *spi = __MCU_SPI_INTF->Instance;
+	uint8_t byte;
+
+	/* Drop stale data left by the previous HAL transmit, if any */
+	if (spi->SR & SPI_SR_RXNE)
+		(void)spi->DR;
+
+	for (uint16_t i = 0; i < size; i++) {
+		if (__mcp2515_spi_wait(spi, SPI_SR_TXE) != HAL_OK)
+			return HAL_TIMEOUT;
+
+		*(volatile uint8_t *)&spi->DR = tx ? tx[i] : __MCU_SPI_DUMMY;
+
+		if (__mcp2515_spi_wait(spi, SPI_SR_RXNE) != HAL_OK)
+			return HAL_TIMEOUT;
+
+		byte = (uint8_t)spi->DR;
+		if (rx)
+			rx[i] = byte;
+	}
+
+	return HAL_OK;
+}
+#endif /* MDP_MCP2515_SPI_FAST */
+#elif defined(MDP_HOST)
+#include "stm32f1xx_hal.h"
+#include "mcp2515_emu.h"
+
+#define __HOST_SPI_MAX_HZ (10000000) /* MCP2515 maximum SPI clock */
 #endif /* STM32F103xB */
 
+static inline void mcp2515_intf_spi_init(void)
+{
+#if defined(STM32F103xB) && (MDP_MCP2515_SPI_FAST == 1)
+	/* HAL enables SPI on the first transfer, register transport doesn't */
+	__HAL_SPI_ENABLE(__MCU_SPI_INTF);
+#endif
+}
+
+static inline void mcp2515_intf_spi_update_clock(void)
+{
+#ifdef STM32F103xB
+	SPI_TypeDef *spi = __MCU_SPI_INTF->Instance;
+	uint32_t pclk = HAL_RCC_GetPCLK2Freq();
+	uint32_t br = 0;
+
+	/* SCK = PCLK2 / 2^(BR + 1), choose the fastest one within limit */
+	while ((pclk >> (br + 1)) > __MCU_SPI_MAX_HZ && br < 7)
+		br++;
+
+	while (spi->SR & SPI_SR_BSY)
+		;
+
+	MODIFY_REG(spi->CR1, SPI_CR1_BR, br << SPI_CR1_BR_Pos);
+	__MCU_SPI_INTF->Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
+#elif defined(MDP_HOST)
+	uint32_t pclk = HAL_RCC_GetPCLK2Freq();
+	uint32_t br = 0;
+
+	while ((pclk >> (br + 1)) > __HOST_SPI_MAX_HZ && br < 7)
+		br++;
+
+	mcp2515_emu_set_sck(pclk >> (br + 1));
+#endif /* STM32F103xB */
+}
+
 static inline bool mcp2515_intf_spi_ready(void)
 {
 #ifdef STM32F103xB
 	return (HAL_SPI_GetState(__MCU_SPI_INTF) == HAL_SPI_STATE_READY);
+#elif defined(MDP_HOST)
+	return true;
 #endif /* STM32F103xB */
 	return false;
 }
@@ -36,7 +135,29 @@ static inline bool mcp2515_intf_spi_ready(void)
 static inline int mcp2515_intf_spi_transmit(uint8_t *data, uint16_t size)
 {
 #ifdef STM32F103xB
+#if (MDP_MCP2515_SPI_FAST == 1)
+	if (size <= __MCU_SPI_FAST_MAX)
+		return __mcp2515_spi_xfer(data, NULL, size);
+#endif /* MDP_MCP2515_SPI_FAST */
 	return HAL_SPI_Transmit(__MCU_SPI_INTF, data, size, __MCU_SPI_TIMEOUT);
+#elif defined(MDP_HOST)
+	return mcp2515_emu_xfer(data, NULL, size);
+#endif /* STM32F103xB */
+	return false;
+}
+
+static inline int mcp2515_intf_spi_transfer(uint8_t *tx, uint8_t *rx,
+					     uint16_t size)
+{
+#ifdef STM32F103xB
+#if (MDP_MCP2515_SPI_FAST == 1)
+	if (size <= __MCU_SPI_FAST_MAX)
+		return __mcp2515_spi_xfer(tx, rx, size);
+#endif /* MDP_MCP2515_SPI_FAST */
+	return HAL_SPI_TransmitReceive(__MCU_SPI_INTF, tx, rx, size,
+				       __MCU_SPI_TIMEOUT);
+#elif defined(MDP_HOST)
+	return mcp2515_emu_xfer(tx, rx, size);
 #endif /* STM32F103xB */
 	return false;
 }
@@ -44,7 +165,13 @@ static inline int mcp2515_intf_spi_transmit(uint8_t *data, uint16_t size)
 static inline int mcp2515_intf_spi_receive(uint8_t *data, uint16_t size)
 {
 #ifdef STM32F103xB
+#if (MDP_MCP2515_SPI_FAST == 1)
+	if (size <= __MCU_SPI_FAST_MAX)
+		return __mcp2515_spi_xfer(NULL, data, size);
+#endif /* MDP_MCP2515_SPI_FAST */
 	return HAL_SPI_Receive(__MCU_SPI_INTF, data, size, __MCU_SPI_TIMEOUT);
+#elif defined(MDP_HOST)
+	return mcp2515_emu_xfer(NULL, data, size);
 #endif /* STM32F103xB */
 	return false;
 }
@@ -52,16 +179,28 @@ static inline int mcp2515_intf_spi_receive(uint8_t *data, uint16_t size)
 static inline void mcp2515_intf_spi_cs_high(void)
 {
 #ifdef STM32F103xB
+#if (MDP_MCP2515_SPI_FAST == 1)
+	__MCU_SPI_CS_GPIO_PORT->BSRR = __MCU_SPI_CS_GPIO_PIN;
+#else
 	HAL_GPIO_WritePin(__MCU_SPI_CS_GPIO_PORT, __MCU_SPI_CS_GPIO_PIN,
 			  GPIO_PIN_SET);
+#endif /* MDP_MCP2515_SPI_FAST */
+#elif defined(MDP_HOST)
+	mcp2515_emu_cs(true);
 #endif /* STM32F103xB */
 }
 
 static inline void mcp2515_intf_spi_cs_low(void)
 {
 #ifdef STM32F103xB
+#if (MDP_MCP2515_SPI_FAST == 1)
+	__MCU_SPI_CS_GPIO_PORT->BSRR = (uint32_t)__MCU_SPI_CS_GPIO_PIN << 16;
+#else
 	HAL_GPIO_WritePin(__MCU_SPI_CS_GPIO_PORT, __MCU_SPI_CS_GPIO_PIN,
 			  GPIO_PIN_RESET);
+#endif /* MDP_MCP2515_SPI_FAST */
+#elif defined(MDP_HOST)
+	mcp2515_emu_cs(false);
 #endif /* STM32F103xB */
 }
 
@@ -0,0 +1,92 @@
+#include "console.h"
+#include "console_intf.h"
+
+#include "log.h"
+#include "common.h"
+
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_console"
+
+#define console_getc(x)		mdp_intf_console_getc(x)
+
+static const struct mdp_console_cmd *cmds[MDP_CONSOLE_MAX_CMDS];
+static int cmds_cnt;
+
+static char line[MDP_CONSOLE_LINE_LEN];
+static int line_len;
+
+static void console_help(void)
+{
+	log_sys("Available commands:\r\n");
+	for (int i = 0; i < cmds_cnt; i++)
+		log_sys("  %-10s %s\r\n", cmds[i]->name, cmds[i]->help);
+}
+
+static void console_exec(char *cmd_line)
+{
+	char *args;
+	size_t name_len;
+
+	/* Split command line into command name and arguments */
+	args = strchr(cmd_line, ' ');
+	if (args) {
+		name_len = args - cmd_line;
+		while (*args == ' ')
+			args++;
+	} else {
+		name_len = strlen(cmd_line);
+		args = &cmd_line[name_len];
+	}
+
+	if (!name_len)
+		return;
+
+	for (int i = 0; i < cmds_cnt; i++) {
+		if (strlen(cmds[i]->name) == name_len &&
+		    !strncmp(cmds[i]->name, cmd_line, name_len)) {
+			cmds[i]->handler(args);
+			return;
+		}
+	}
+
+	console_help();
+}
+
+bool mdp_console_register(const struct mdp_console_cmd *cmd)
+{
+	if (!cmd || !cmd->name || !cmd->handler) {
+		log_err("Invalid command!\r\n");
+		return false;
+	}
+
+	if (cmds_cnt >= MDP_CONSOLE_MAX_CMDS) {
+		log_err("No space for command '%s'\r\n", cmd->name);
+		return false;
+	}
+
+	cmds[cmds_cnt++] = cmd;
+
+	return true;
+}
+
+void mdp_console_poll(void)
+{
+	char c;
+
+	while (console_getc(&c)) {
+		if (c == '\r' || c == '\n') {
+			line[line_len] = '\0';
+			line_len = 0;
+			console_exec(line);
+			continue;
+		}
+
+		/* Drop too long lines */
+		if (line_len < MDP_CONSOLE_LINE_LEN - 1)
+			line[line_len++] = c;
+	}
+}
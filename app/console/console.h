@@ -0,0 +1,43 @@
+/**
+ * @file       console.h
+ * @brief      Simple UART command console, used to request diagnostic
+ *             information from the device without a debugger.
+ *
+ *             Commands are read from the debug UART without blocking,
+ *             one command per line: "<name> [args]".
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_CONSOLE_H__
+#define __MDP_CONSOLE_H__
+
+#include <stdbool.h>
+
+#define MDP_CONSOLE_MAX_CMDS	12	/* Maximum number of commands */
+#define MDP_CONSOLE_LINE_LEN	32	/* Maximum command line length */
+
+struct mdp_console_cmd {
+	const char *name;
+	const char *help;
+	void (*handler)(const char *args);
+};
+
+/**
+ * @brief Register console command.
+ *
+ * @param [in] cmd Command descriptor, must be valid all the time.
+ *
+ * @return true if command was registered, false otherwise.
+ */
+bool mdp_console_register(const struct mdp_console_cmd *cmd);
+
+/**
+ * @brief Poll console for the new input and execute commands.
+ *        This function must be called constantly in the main loop.
+ */
+void mdp_console_poll(void);
+
+#endif /* __MDP_CONSOLE_H__ */
@@ -0,0 +1,38 @@
+/**
+ * @file       console_intf.h
+ * @brief      Console UART interface wrapper, the purpose is to use
+ *             different MCU's with the console API.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_CONSOLE_INTF_H__
+#define __MDP_CONSOLE_INTF_H__
+
+#include <stdbool.h>
+
+#ifdef STM32F103xB
+#include "stm32f1xx_hal.h"
+
+extern UART_HandleTypeDef huart3;
+
+#define __MCU_CONSOLE_UART (&huart3)
+#endif /* STM32F103xB */
+
+static inline bool mdp_intf_console_getc(char *c)
+{
+#ifdef STM32F103xB
+	/* Reading DR also clears overrun error, if any */
+	if (!__HAL_UART_GET_FLAG(__MCU_CONSOLE_UART, UART_FLAG_RXNE))
+		return false;
+
+	*c = (char)(__MCU_CONSOLE_UART->Instance->DR & 0xFF);
+	return true;
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_CONSOLE_INTF_H__ */
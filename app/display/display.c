@@ -0,0 +1,163 @@
+/**
+ * @file       display.c
+ * @brief      Display message compositor implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "display.h"
+
+#include "mdp.h"
+#include "common.h"
+#include "time.h"
+
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_display"
+
+struct mdp_dp_layer {
+	char text[MAZDA_DP_CHAR_NUM];
+	bool shown;
+	uint32_t shown_ms;
+	uint32_t ttl_ms;
+};
+
+static struct mdp_dp_layer layers[MDP_DP_LAYER_COUNT];
+static mdp_dp_layer_t visible = MDP_DP_LAYER_NONE;
+static bool dirty;
+static uint8_t frames[MAZDA_DP_REG_NUM][MAZDA_DP_MSG_SIZE];
+
+static void display_update_visible(void)
+{
+	mdp_dp_layer_t top = MDP_DP_LAYER_NONE;
+
+	for (int i = 0; i < MDP_DP_LAYER_COUNT; i++) {
+		if (layers[i].shown) {
+			top = i;
+			break;
+		}
+	}
+
+	if (top != visible) {
+		visible = top;
+		dirty = true;
+	}
+}
+
+static void display_build_frames(const char *text)
+{
+	/**
+	 * Mazda 3 has 12-symbol LCD display, and it has two logical parts:
+	 *	1. Left half of display with CAN bus address 0x290.
+	 *	2. Right half of display with CAN bus address 0x291.
+	 *
+	 * To write data to the display, we need to
+	 * send 2 data packets 8 bytes each.
+	 *
+	 * Start byte of each data packet is service byte and it is different
+	 * for each packet:
+	 *	1. 0xC0 - For the left half of display.
+	 *	2. 0x85 - For the right half of display.
+	 *
+	 * Thus, effective payload of display is 14 bytes.
+	 * Due to the fact that the display has only 12 characters to display,
+	 * we need to place data in buffer in a certain way: in left half we
+	 * will write first 7 bytes of our data with offset 1 (service byte);
+	 * in right half we will write next 7 bytes of data, with an data offset
+	 * not of 7 bytes, but 5.
+	 *
+	 * Example: Write string "Initializing" to the display
+	 *	Index:        0      1     2     3     4     5     6     7
+	 *	Left half:  [0xC0] ['I'] ['n'] ['i'] ['t'] ['i'] ['a'] ['l']
+	 *	Right half: [0x85] ['a'] ['l'] ['i'] ['z'] ['i'] ['n'] ['g']
+	 */
+	frames[MAZDA_DP_LHALF][0] = mdp_vehicle->lhalf_byte;
+	frames[MAZDA_DP_RHALF][0] = mdp_vehicle->rhalf_byte;
+
+	memcpy(&frames[MAZDA_DP_LHALF][1],
+	       text,
+	       MAZDA_DP_MSG_SIZE - 1);
+	memcpy(&frames[MAZDA_DP_RHALF][1],
+	       &text[MAZDA_DP_CHAR_NUM - MAZDA_DP_MSG_SIZE + 1],
+	       MAZDA_DP_MSG_SIZE - 1);
+}
+
+void mdp_display_show(mdp_dp_layer_t layer, const char *text,
+		      uint32_t ttl_ms)
+{
+	struct mdp_dp_layer *l;
+	char buf[MAZDA_DP_CHAR_NUM];
+	size_t len;
+
+	if (layer >= MDP_DP_LAYER_COUNT || !text)
+		return;
+
+	/* Trim or add trailing spaces */
+	len = MIN(strlen(text), (size_t)MAZDA_DP_CHAR_NUM);
+	memcpy(buf, text, len);
+	memset(&buf[len], ' ', MAZDA_DP_CHAR_NUM - len);
+
+	l = &layers[layer];
+	l->shown_ms = mdp_tm_ms();
+	l->ttl_ms = ttl_ms;
+
+	if (l->shown && !memcmp(l->text, buf, sizeof(buf)))
+		return;
+
+	memcpy(l->text, buf, sizeof(buf));
+	l->shown = true;
+
+	if (layer == visible)
+		dirty = true;
+	else
+		display_update_visible();
+}
+
+void mdp_display_hide(mdp_dp_layer_t layer)
+{
+	if (layer >= MDP_DP_LAYER_COUNT || !layers[layer].shown)
+		return;
+
+	layers[layer].shown = false;
+	display_update_visible();
+}
+
+void mdp_display_poll(void)
+{
+	uint32_t now = mdp_tm_ms();
+	struct mdp_dp_layer *l;
+
+	for (int i = 0; i < MDP_DP_LAYER_COUNT; i++) {
+		l = &layers[i];
+		if (l->shown && l->ttl_ms != MDP_DP_TTL_FOREVER &&
+		    now - l->shown_ms >= l->ttl_ms) {
+			log_dbg("Layer %d expired\r\n", i);
+			mdp_display_hide(i);
+		}
+	}
+}
+
+mdp_dp_layer_t mdp_display_visible(void)
+{
+	return visible;
+}
+
+const uint8_t *mdp_display_frame(int half)
+{
+	if (dirty && visible != MDP_DP_LAYER_NONE) {
+		display_build_frames(layers[visible].text);
+		dirty = false;
+	}
+
+	return frames[half];
+}
+
+void mdp_display_invalidate(void)
+{
+	dirty = true;
+}
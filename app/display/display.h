@@ -0,0 +1,86 @@
+/**
+ * @file       display.h
+ * @brief      Display message compositor.
+ *
+ *             Every source of the display text owns a layer. Layers are
+ *             stacked by priority, the highest shown one is visible, and
+ *             the car's own text passes through if no layer is shown.
+ *             A layer may be shown for a limited time, then it expires
+ *             by itself, so a source that stops refreshing it doesn't
+ *             leave stale text on the display.
+ *
+ *             Display frames are rebuilt only when the visible text
+ *             changes: showing the same text again or changing a hidden
+ *             layer costs just a comparison.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_DISPLAY_H__
+#define __MDP_DISPLAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MDP_DP_TTL_FOREVER	0
+
+/* Ordered by priority, the lower value wins */
+typedef enum {
+	MDP_DP_LAYER_PARKING = 0,
+	MDP_DP_LAYER_ERROR,
+	MDP_DP_LAYER_GREETING,
+	MDP_DP_LAYER_COUNT,
+	MDP_DP_LAYER_NONE = MDP_DP_LAYER_COUNT,	/* Passthrough */
+} mdp_dp_layer_t;
+
+/**
+ * @brief Show text on the layer.
+ *
+ * @param [in] layer Layer to update.
+ * @param [in] text Text, trimmed or padded with spaces to the display
+ *                  width.
+ * @param [in] ttl_ms Time to show the text, MDP_DP_TTL_FOREVER to show
+ *                    it until hidden. Showing the text again restarts it.
+ */
+void mdp_display_show(mdp_dp_layer_t layer, const char *text,
+		      uint32_t ttl_ms);
+
+/**
+ * @brief Hide the layer, does nothing if it's hidden already.
+ *
+ * @param [in] layer Layer to hide.
+ */
+void mdp_display_hide(mdp_dp_layer_t layer);
+
+/**
+ * @brief Hide expired layers. Must be called from the main loop.
+ */
+void mdp_display_poll(void);
+
+/**
+ * @brief Get the visible layer.
+ *
+ * @return Visible layer, MDP_DP_LAYER_NONE if the car's text passes
+ *         through.
+ */
+mdp_dp_layer_t mdp_display_visible(void);
+
+/**
+ * @brief Get the display frame of the visible layer, rebuilt if the
+ *        visible text has changed since the last call.
+ *
+ * @param [in] half MAZDA_DP_LHALF or MAZDA_DP_RHALF.
+ *
+ * @return Frame data, MAZDA_DP_MSG_SIZE bytes.
+ */
+const uint8_t *mdp_display_frame(int half);
+
+/**
+ * @brief Force the frames to be rebuilt, e.g. after the vehicle profile
+ *        has changed.
+ */
+void mdp_display_invalidate(void);
+
+#endif /* __MDP_DISPLAY_H__ */
@@ -0,0 +1,179 @@
+/**
+ * @file       edgecap.c
+ * @brief      Parktronic data line edge capture implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "edgecap.h"
+#include "falcon2616_gpio_intf.h"
+#include "sniffer.h"
+#include "sniffer_intf.h"
+
+#include "boardinfo.h"
+#include "log.h"
+#include "time.h"
+
+#include <errno.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_edgecap"
+
+#define MDP_EDGECAP_REC_SIZE	9
+#define MDP_EDGECAP_BUF_SIZE	(32 * MDP_EDGECAP_REC_SIZE)
+
+#define read_gpio()		f2616_intf_gpio_read()
+
+/* Stream goes out of the same UART channel as the sniffer records */
+#define edgecap_init(x)		mdp_intf_sniffer_init(x)
+#define edgecap_busy()		mdp_intf_sniffer_busy()
+#define edgecap_send(x, y)	mdp_intf_sniffer_send(x, y)
+
+struct edgecap_edge {
+	uint32_t cyc;
+	uint8_t seq;
+	uint8_t info;
+};
+
+static bool active;
+static uint8_t clock_mhz;
+static void (*decoder_irq)(void);
+
+/* Written by the line interrupt only, read by the main loop */
+static struct edgecap_edge ring[MDP_EDGECAP_RING_LEN];
+static volatile uint32_t ring_head, ring_tail;
+static uint8_t seq;
+
+/* One buffer is filled while the other one is sent by DMA */
+static uint8_t buf[2][MDP_EDGECAP_BUF_SIZE];
+static uint32_t buf_len;
+static int buf_idx;
+
+static struct mdp_timestamp tick_ts;
+
+/* Must be called with the line interrupt masked */
+static void edgecap_push(uint32_t cyc, uint8_t info)
+{
+	struct edgecap_edge *e;
+
+	if (ring_head - ring_tail == MDP_EDGECAP_RING_LEN)
+		return;
+
+	e = &ring[ring_head & (MDP_EDGECAP_RING_LEN - 1)];
+	e->cyc = cyc;
+	e->seq = seq;
+	e->info = info;
+	ring_head++;
+}
+
+static void edgecap_irq(void)
+{
+	/* Time is taken first, so the decoder doesn't add latency */
+	uint32_t cyc = (uint32_t)mdp_tm_cycles();
+
+	/* Sequence number counts dropped edges too */
+	seq++;
+	edgecap_push(cyc, read_gpio() << MDP_EDGECAP_INFO_LEVEL);
+
+	if (decoder_irq)
+		decoder_irq();
+}
+
+static void edgecap_tick(void)
+{
+	uint32_t primask;
+	uint8_t info;
+
+	if (!mdp_tm_elapsed(&tick_ts, MDP_EDGECAP_TICK_MS))
+		return;
+
+	/* Taken in the ring, so the tick is never ahead of an edge */
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	info = read_gpio() << MDP_EDGECAP_INFO_LEVEL;
+	edgecap_push((uint32_t)mdp_tm_cycles(),
+		     info | 1 << MDP_EDGECAP_INFO_TICK);
+
+	__set_PRIMASK(primask);
+}
+
+static void edgecap_flush(void)
+{
+	if (!buf_len || edgecap_busy())
+		return;
+
+	edgecap_send(buf[buf_idx], buf_len);
+	buf_idx ^= 1;
+	buf_len = 0;
+}
+
+static void edgecap_put(const struct edgecap_edge *e)
+{
+	uint8_t *rec = &buf[buf_idx][buf_len];
+
+	rec[0] = MDP_EDGECAP_SYNC;
+	rec[1] = e->seq;
+	rec[2] = e->info;
+	rec[3] = clock_mhz;
+	rec[4] = e->cyc & 0xFF;
+	rec[5] = (e->cyc >> 8) & 0xFF;
+	rec[6] = (e->cyc >> 16) & 0xFF;
+	rec[7] = (e->cyc >> 24) & 0xFF;
+	rec[8] = mdp_sniffer_crc8(&rec[1], MDP_EDGECAP_REC_SIZE - 2);
+
+	buf_len += MDP_EDGECAP_REC_SIZE;
+}
+
+int mdp_edgecap_start(void)
+{
+	clock_mhz = MDP_CLOCK_FREQ_MHZ;
+
+	log_sys("Streaming parktronic line edges at %d baud, %u MHz\r\n",
+		MDP_SNIFFER_UART_SPEED, clock_mhz);
+
+	if (!edgecap_init(MDP_SNIFFER_UART_SPEED))
+		return -EIO;
+
+	ring_head = ring_tail = 0;
+	tick_ts = MDP_TIMESTAMP;
+
+	/* Logs would corrupt the stream from now on */
+	active = true;
+
+	decoder_irq = __F2616_GPIO_IRQ_CB;
+	__F2616_GPIO_IRQ_CB = edgecap_irq;
+
+	return 0;
+}
+
+void mdp_edgecap_poll(void)
+{
+	if (!active)
+		return;
+
+	edgecap_tick();
+
+	/* Ring is drained only as far as the free buffer space allows */
+	while (ring_tail != ring_head) {
+		if (buf_len + MDP_EDGECAP_REC_SIZE > MDP_EDGECAP_BUF_SIZE) {
+			edgecap_flush();
+			if (buf_len)
+				break;
+		}
+
+		edgecap_put(&ring[ring_tail & (MDP_EDGECAP_RING_LEN - 1)]);
+		ring_tail++;
+	}
+
+	edgecap_flush();
+}
+
+bool mdp_edgecap_active(void)
+{
+	return active;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file       edgecap.h
+ * @brief      Parktronic data line edge capture.
+ *
+ *             Every edge on the parktronic data line is timestamped by
+ *             the DWT cycle counter in the line interrupt and kept in a
+ *             RAM ring, the main loop streams the ring out of the debug
+ *             UART in a compact binary format. The decoder keeps working
+ *             on the same edges. tools/mdp_edges2vcd.py converts the
+ *             stream to VCD for waveform viewers.
+ *
+ *             Record format, multi-byte fields are little-endian:
+ *
+ *             | 0x5A | seq | info | mhz | cyc[4] | crc8 |
+ *
+ *             seq  - incremented for every edge, including edges dropped
+ *                    because the ring was full, so the host sees a gap
+ *                    if anything was lost. Tick records don't count.
+ *             info - bit 0: line level after the edge, bit 1: tick
+ *                    record (no edge, the current level and time).
+ *             mhz  - core clock, cycles per microsecond.
+ *             cyc  - DWT cycle counter at the edge. A tick record is
+ *                    sent every MDP_EDGECAP_TICK_MS, so the host can
+ *                    extend the counter past its wrap (~59 s at 72 MHz).
+ *             crc8 - polynomial 0x07, over all bytes after 0x5A.
+ *
+ *             Core clock is kept at the active mode rate and the core
+ *             never sleeps while capturing, so the counter is never
+ *             stopped. Falcon 2616 sends a bit every ~800 us, that is
+ *             ~2500 edges/s inside a frame or ~23 KB/s of records, the
+ *             stream goes at MDP_SNIFFER_UART_SPEED (~100 KB/s).
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_EDGECAP_H__
+#define __MDP_EDGECAP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MDP_EDGECAP_RING_LEN	256	/* Edges, must be power of two */
+#define MDP_EDGECAP_TICK_MS	1000	/* Tick record period */
+
+#define MDP_EDGECAP_SYNC	0x5A
+#define MDP_EDGECAP_INFO_LEVEL	0	/* Line level bit in info byte */
+#define MDP_EDGECAP_INFO_TICK	1	/* Tick record bit in info byte */
+
+/**
+ * @brief Enter capture mode. The debug UART is switched to
+ *        MDP_SNIFFER_UART_SPEED and the console and logs are not
+ *        available until reset.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_edgecap_start(void);
+
+/**
+ * @brief Send captured edges to UART.
+ *        This function must be called constantly in the main loop.
+ */
+void mdp_edgecap_poll(void);
+
+/**
+ * @brief Check if the capture mode is active.
+ *
+ * @return true if the debug UART is used by the capture.
+ */
+bool mdp_edgecap_active(void);
+
+#endif /* __MDP_EDGECAP_H__ */
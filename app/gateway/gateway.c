@@ -0,0 +1,174 @@
+/**
+ * @file       gateway.c
+ * @brief      CAN gateway implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "gateway.h"
+#include "bbox.h"
+
+#include "log.h"
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_gateway"
+
+#define gw_queue_len(dir)	((dir)->head - (dir)->tail)
+#define gw_queue_entry(dir, i)	(&(dir)->queue[(i) & (MDP_GW_QUEUE_LEN - 1)])
+
+static void gw_receive(struct mdp_gw_dir *dir)
+{
+	struct mdp_gw_entry *entry;
+	int ret;
+
+	/* Drain the source even if the queue is full, to count drops */
+	while (true) {
+		ret = mdp_can_read(dir->src);
+		if (ret < 0) {
+			log_err("%s: read failed\r\n", dir->name);
+			mdp_bbox_trigger(MDP_BBOX_EV_RX_ERR,
+					 (dir->index << 8) | (-ret & 0xFF));
+			mdp_can_fault(dir->src, ret);
+			return;
+		}
+
+		if (!ret)
+			return;
+
+		dir->stats.rx++;
+
+		if (dir->on_rx)
+			dir->on_rx(&dir->src->msg);
+
+		if (gw_queue_len(dir) >= MDP_GW_QUEUE_LEN) {
+			dir->stats.drops++;
+			mdp_bbox_event(MDP_BBOX_EV_GW_DROP, dir->index);
+			continue;
+		}
+
+		entry = gw_queue_entry(dir, dir->head);
+		entry->msg = dir->src->msg;
+		entry->rx_us = (uint32_t)mdp_tm_us();
+		dir->head++;
+	}
+}
+
+/* Message class, 0 - none */
+static uint32_t gw_class(struct mdp_gw_dir *dir, uint32_t id)
+{
+	uint32_t cls;
+
+	if (!dir->class_map || id >= MDP_GW_ID_NUM)
+		return 0;
+
+	cls = dir->class_map[id];
+	return cls < dir->rules_cnt ? cls : 0;
+}
+
+static bool gw_rewrite(struct mdp_gw_dir *dir, struct mdp_can_msg *msg)
+{
+	mdp_gw_rewrite_t rewrite;
+	uint32_t cls = gw_class(dir, msg->id);
+
+	if (!cls)
+		return false;
+
+	rewrite = dir->rules[cls];
+	if (!rewrite || !rewrite(msg))
+		return false;
+
+	dir->stats.rewrites++;
+	return true;
+}
+
+static void gw_transmit(struct mdp_gw_dir *dir)
+{
+	struct mdp_gw_entry *entry;
+	uint32_t now, gap = 0;
+	bool rewritten;
+	int ret;
+
+	while (gw_queue_len(dir)) {
+		entry = gw_queue_entry(dir, dir->tail);
+
+		now = (uint32_t)mdp_tm_us();
+		if (dir->tx_gaps)
+			gap = dir->tx_gaps[gw_class(dir, entry->msg.id)];
+		if (gap && now - dir->tx_last_us < gap)
+			return;
+
+		dir->dst->msg = entry->msg;
+		rewritten = gw_rewrite(dir, &dir->dst->msg);
+
+		ret = mdp_can_write(dir->dst);
+		if (ret == -EBUSY) {
+			/* Frame stays in the queue until a buffer is free */
+			dir->stats.busy++;
+			return;
+		}
+
+		dir->tail++;
+
+		if (ret < 0) {
+			log_err("%s: write failed\r\n", dir->name);
+			mdp_bbox_trigger(MDP_BBOX_EV_TX_ERR,
+					 (dir->index << 8) | (-ret & 0xFF));
+			mdp_can_fault(dir->dst, ret);
+			return;
+		}
+
+		mdp_bbox_frame(dir->index, &dir->dst->msg, rewritten);
+
+		if (gap)
+			dir->tx_last_us = now;
+		dir->stats.tx++;
+		dir->stats.lat_last_us = now - entry->rx_us;
+		dir->stats.lat_max_us = MAX(dir->stats.lat_max_us,
+					    dir->stats.lat_last_us);
+		dir->stats.lat_sum_us += dir->stats.lat_last_us;
+	}
+}
+
+void mdp_gw_poll(struct mdp_gw_dir *dir)
+{
+	gw_receive(dir);
+	gw_transmit(dir);
+}
+
+bool mdp_gw_pending(struct mdp_gw_dir *dir)
+{
+	return gw_queue_len(dir) != 0;
+}
+
+void mdp_gw_print_stats(struct mdp_gw_dir *dir)
+{
+	struct mdp_gw_stats *stats = &dir->stats;
+	uint32_t elapsed_ms = mdp_tm_ms() - stats->start_ms;
+	uint32_t fps = 0, avg_us = 0;
+
+	if (elapsed_ms)
+		fps = (uint64_t)stats->tx * __MDP_MSEC_IN_SEC / elapsed_ms;
+	if (stats->tx)
+		avg_us = stats->lat_sum_us / stats->tx;
+
+	log_sys("%s: rx %lu, tx %lu (%lu fps), rewrites %lu\r\n", dir->name,
+		stats->rx, stats->tx, fps, stats->rewrites);
+	log_sys("%s: drops %lu, busy %lu, queued %lu\r\n", dir->name,
+		stats->drops, stats->busy, gw_queue_len(dir));
+	log_sys("%s: latency last %lu us, avg %lu us, max %lu us\r\n",
+		dir->name, stats->lat_last_us, avg_us, stats->lat_max_us);
+}
+
+void mdp_gw_reset_stats(struct mdp_gw_dir *dir)
+{
+	memset(&dir->stats, 0, sizeof(dir->stats));
+	dir->stats.start_ms = mdp_tm_ms();
+}
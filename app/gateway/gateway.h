@@ -0,0 +1,113 @@
+/**
+ * @file       gateway.h
+ * @brief      CAN gateway, forwards frames between two CAN interfaces.
+ *
+ *             Every direction has its own receive queue, rewrite table
+ *             and statistics. Rewrite table is indexed by message class,
+ *             given by the direction class map, so a frame is matched
+ *             in constant time. A frame is queued as soon as the source
+ *             interface has it, rewritten right before transmission,
+ *             so it always carries the most recent data, and sent when
+ *             the destination interface is able to take it.
+ *
+ *             A class can be paced: its frame is sent no sooner than
+ *             the class gap after the previous paced frame. Frames stay
+ *             in order, so the ones behind it wait as well.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_GATEWAY_H__
+#define __MDP_GATEWAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "can_bus.h"
+
+#define MDP_GW_QUEUE_LEN	8	/* Must be power of two */
+#define MDP_GW_ID_NUM		2048	/* Standard 11-bit IDs */
+
+/**
+ * @brief Rewrite function, returns true if the frame was modified.
+ */
+typedef bool (*mdp_gw_rewrite_t)(struct mdp_can_msg *msg);
+
+struct mdp_gw_entry {
+	struct mdp_can_msg msg;
+	uint32_t rx_us;		/* Reception time */
+};
+
+struct mdp_gw_stats {
+	uint32_t rx;
+	uint32_t tx;
+	uint32_t drops;		/* Queue was full */
+	uint32_t rewrites;
+	uint32_t busy;		/* Destination had no free TX buffer */
+	uint32_t lat_last_us;	/* Reception to transmission latency */
+	uint32_t lat_max_us;
+	uint64_t lat_sum_us;
+	uint32_t start_ms;	/* Statistics start time */
+};
+
+struct mdp_gw_dir {
+	const char *name;
+	int index;		/* Direction index in black-box records */
+	struct mdp_can *src;
+	struct mdp_can *dst;
+
+	/* Message class by ID (MDP_GW_ID_NUM entries), 0 - no class */
+	const uint8_t *class_map;
+	/* Rewrite table indexed by message class */
+	const mdp_gw_rewrite_t *rules;
+	/* Optional gap table, same index, 0 - the class is not paced */
+	const uint16_t *tx_gaps;
+	size_t rules_cnt;
+
+	/* Optional inspection hook, called on reception */
+	void (*on_rx)(const struct mdp_can_msg *msg);
+
+	/* Transmission time of the last paced frame */
+	uint32_t tx_last_us;
+
+	struct mdp_gw_entry queue[MDP_GW_QUEUE_LEN];
+	uint32_t head, tail;
+
+	struct mdp_gw_stats stats;
+};
+
+/**
+ * @brief Receive all pending frames from the source and transmit
+ *        queued frames to the destination. Never blocks.
+ *
+ * @param [in] dir Gateway direction.
+ */
+void mdp_gw_poll(struct mdp_gw_dir *dir);
+
+/**
+ * @brief Check if there are frames waiting for transmission.
+ *
+ * @param [in] dir Gateway direction.
+ *
+ * @return true if the queue is not empty.
+ */
+bool mdp_gw_pending(struct mdp_gw_dir *dir);
+
+/**
+ * @brief Print direction statistics.
+ *
+ * @param [in] dir Gateway direction.
+ */
+void mdp_gw_print_stats(struct mdp_gw_dir *dir);
+
+/**
+ * @brief Reset direction statistics.
+ *
+ * @param [in] dir Gateway direction.
+ */
+void mdp_gw_reset_stats(struct mdp_gw_dir *dir);
+
+#endif /* __MDP_GATEWAY_H__ */
@@ -1,11 +1,23 @@
 #include "mdp.h"
+#include "bbox.h"
 #include "beeper.h"
 #include "common.h"
+#include "console.h"
+#include "display.h"
+#include "edgecap.h"
 #include "can_bus.h"
+#include "can_hal.h"
+#include "can_spi.h"
 #include "can_bypass_switch.h"
+#include "gateway.h"
 #include "ptronic_decoder.h"
+#include "power.h"
+#include "prof.h"
 #include "ptronic_switch.h"
+#include "sniffer.h"
 #include "system_led.h"
+#include "track.h"
+#include "zone.h"
 
 #ifdef MDP_MODULE
 #undef MDP_MODULE
@@ -18,12 +30,16 @@
 #define MDP_ERROR_BLINK_DELAY	50	/* Error state blink delay msec */
 
 #define MDP_DIST_BEEP_NONE	150	/* Distance in centimeters */
-#define MDP_DIST_BEEP_SLOW	90	/* Distance in centimeters */
-#define MDP_DIST_BEEP_FAST	30	/* Distance in centimeters */
+#define MDP_DIST_BEEP_CONST	30	/* Distance in centimeters */
 
-#define MDP_MAGIC_SLEEP_MS	1	/* Fixes display flickering */
+#define MDP_BEEP_PERIOD_MAX	600	/* Beep period at MDP_DIST_BEEP_NONE */
+#define MDP_BEEP_PERIOD_MIN	200	/* Beep period at MDP_DIST_BEEP_CONST */
+
+#define MDP_MAGIC_GAP_US	1000	/* Display frames gap, fixes flicker */
 
 #define MDP_PARK_ERR_STR	"    ERRm    "
+#define MDP_PARK_ERR_TTL	1000	/* Error text time after the last check */
+#define MDP_GREETING_TTL	1000	/* Greeting time after the last frame */
 #define MDP_NO_DATA_STR		"    -.-m    "
 #define MDP_DATA_TMPL_STR	"    %u.%um    "
 #define MDP_STEP		30
@@ -36,20 +52,93 @@
 		"\xF0   ",          "\x3E   ",          "\x3E   "		\
 	}
 
+#define MDP_TEXT_STEP		10	/* Decoder resolution */
+#define MDP_TEXT_CNT		27	/* Up to 2.6m, decoder max is 2.55m */
+#define MDP_ZONE_HYST		10	/* One decoder step */
+#define MDP_ZONE_DWELL_MS	300	/* Farther zone hold time */
+#define MDP_DP_PERIOD_MS	250	/* Display frame period until measured */
+
+#define MDP_TTC_REF_SPEED	30	/* Beeps follow distance up to, cm/s */
+#define MDP_TTC_FLASH_MS	1000	/* Display flashes below that */
+#define MDP_TTC_FLASH_OFF_MS	1300	/* and stops flashing above that */
+#define MDP_FLASH_MS		500	/* Flash half period */
+
+#if (MDP_TTC_WARNING == 1) && (MDP_DIST_PREDICT != 1)
+#error "Time to contact warning needs distance prediction!"
+#endif
+
+const struct mdp_can_signal mazda_signals[MAZDA_SIG_COUNT] = {
+	MAZDA_SIGNALS(MDP_SIG_ENTRY)
+};
+
 struct mdp_state {
 	uint32_t curr;
 	uint32_t prev;
 };
 
-static uint8_t mazda_stat;
+static volatile bool mazda_rgear;
+static uint8_t mazda_stat_data[MAZDA_MAX_MSG_SIZE];
 static struct mdp_state rgear_state;
+static uint32_t rgear_on_ms;
+
+/* Latency from the reverse bit on the bus to the first rewritten frame */
+static volatile bool rgear_isr_prev;
+static volatile uint64_t rgear_rx_us;
+static volatile bool rgear_lat_pending;
+static bool rgear_in_isr;
+static uint32_t rgear_lat_last_us, rgear_lat_max_us;
 static struct mdp_can dp_can, pjb_can;
 
 static const char *dist_steps[] = MDP_STEP_STR;
-static uint8_t mdp_buffer[MAZDA_DP_REG_NUM][MAZDA_DP_MSG_SIZE];
 
-#if (MDP_OVERRIDE_GREETING == 1)
-static bool greetin_replace;
+/* Arrows, the last zone has no arrow */
+static const struct mdp_zone_cfg arrow_zone_cfg = {
+	.step_cm = MDP_STEP,
+	.cnt = MDP_STEP_CNT + 1,
+	.hyst_cm = MDP_ZONE_HYST,
+	.dwell_ms = MDP_ZONE_DWELL_MS,
+};
+
+/* Distance text, readings are already quantized by the decoder */
+static const struct mdp_zone_cfg text_zone_cfg = {
+	.step_cm = MDP_TEXT_STEP,
+	.cnt = MDP_TEXT_CNT,
+	.dwell_ms = MDP_ZONE_DWELL_MS,
+};
+
+/* Beeps, hysteresis at the silent and constant tone boundaries only */
+#define MDP_BEEP_ZONE(cm)	((cm) / MDP_TEXT_STEP)
+#define MDP_BEEP_ZONE_CNT	(MDP_BEEP_ZONE(MDP_DIST_BEEP_NONE) + 1)
+
+static const uint8_t beep_zone_hyst[MDP_BEEP_ZONE_CNT - 1] = {
+	[MDP_BEEP_ZONE(MDP_DIST_BEEP_CONST) - 1] = MDP_ZONE_HYST,
+	[MDP_BEEP_ZONE(MDP_DIST_BEEP_NONE) - 1] = MDP_ZONE_HYST,
+};
+
+static const struct mdp_zone_cfg beep_zone_cfg = {
+	.step_cm = MDP_TEXT_STEP,
+	.cnt = MDP_BEEP_ZONE_CNT,
+	.band_hyst_cm = beep_zone_hyst,
+	.dwell_ms = MDP_ZONE_DWELL_MS,
+};
+
+static struct mdp_zone left_zone, right_zone, text_zone, beep_zone;
+static bool parking_shown, beep_applied;
+
+#if (MDP_DIST_PREDICT == 1)
+static const struct mdp_track_cfg track_cfg = MDP_TRACK_CFG_DEFAULT;
+static struct mdp_track rear_track[MDP_SENSOR_CNT];
+static struct mdp_track front_track[MDP_SENSOR_CNT];
+static uint8_t rear_seq[MDP_SENSOR_CNT], front_seq[MDP_SENSOR_CNT];
+static struct ptronic_data predicted;
+static uint32_t ttc_ms = UINT32_MAX;	/* Nearest approaching obstacle */
+
+/* Display frames go out at the rate of the head unit */
+static uint32_t dp_tx_ms, dp_period_ms = MDP_DP_PERIOD_MS;
+#endif
+
+#if (MDP_TTC_WARNING == 1)
+static bool flash_on, flash_blank;
 #endif
 
 static void app_error_blink();
@@ -57,8 +146,15 @@ static void app_error_blink();
 static void error_handler(void)
 {
 #if (MDP_USE_CAN_BYPASS == 1)
+	/* Display gets the vehicle frames while the recorder is saved */
 	mdp_can_bypass_on();
+#endif
+
+	/* Nothing is running after this point, save the recorder now */
+	mdp_bbox_event(MDP_BBOX_EV_ERROR, 0);
+	mdp_bbox_commit(MDP_BBOX_EV_ERROR);
 
+#if (MDP_USE_CAN_BYPASS == 1)
 	while(true) {
 		app_error_blink();
 	}
@@ -85,151 +181,249 @@ static void log_app_info(void)
 	log_sys("%s\r\n", line);
 }
 
-static void update_display(char *string)
+static void distance_to_string(char *string)
 {
-	size_t string_len;
-	static char dp_string[MAZDA_DP_CHAR_NUM];
+	uint8_t left = mdp_zone_get(&left_zone);
+	uint8_t right = mdp_zone_get(&right_zone);
+	uint32_t main_dist;
 
-	/* Prepare string for displaying: trim or add trailing spaces */
-	string_len = strlen(string);
-	if (string_len > MAZDA_DP_CHAR_NUM) {
-		string_len = MAZDA_DP_CHAR_NUM;
+	MDP_PROF_SCOPE(MDP_PROF_DIST_TO_STR);
+
+	/* No data from sensors */
+	if (mdp_zone_get(&text_zone) == MDP_ZONE_INVALID) {
+		sprintf(string, MDP_NO_DATA_STR);
+		return;
 	}
-	memcpy(dp_string, string, string_len);
-	memset(&dp_string[string_len], ' ', MAZDA_DP_CHAR_NUM - string_len);
 
-	/**
-	 * Fill display buffer
-	 *
-	 * Mazda 3 has 12-symbol LCD display, and it has two logical parts:
-	 *	1. Left half of display with CAN bus address 0x290.
-	 *	2. Right half of display with CAN bus address 0x291.
-	 *
-	 * To write data to the display, we need to
-	 * send 2 data packets 8 bytes each.
-	 *
-	 * Start byte of each data packet is service byte and it is different
-	 * for each packet:
-	 *	1. 0xC0 - For the left half of display.
-	 *	2. 0x85 - For the right half of display.
-	 *
-	 * Thus, effective payload of display is 14 bytes.
-	 * Due to the fact that the display has only 12 characters to display,
-	 * we need to place data in buffer in a certain way: in left half we
-	 * will write first 7 bytes of our data with offset 1 (service byte);
-	 * in right half we will write next 7 bytes of data, with an data offset
-	 * not of 7 bytes, but 5.
-	 *
-	 * Example: Write string "Initializing" to the display
-	 *	Index:        0      1     2     3     4     5     6     7
-	 *	Left half:  [0xC0] ['I'] ['n'] ['i'] ['t'] ['i'] ['a'] ['l']
-	 *	Right half: [0x85] ['a'] ['l'] ['i'] ['z'] ['i'] ['n'] ['g']
-	 */
-	mdp_buffer[MAZDA_DP_LHALF][0] = MAZDA_DP_LHALF_BYTE;
-	mdp_buffer[MAZDA_DP_RHALF][0] = MAZDA_DP_RHALF_BYTE;
+	/* Write distance in meters */
+	main_dist = mdp_zone_cm(&text_zone);
+	sprintf(string, MDP_DATA_TMPL_STR, (unsigned)(main_dist / 100),
+		(unsigned)((main_dist % 100) / 10));
 
-	memcpy(&mdp_buffer[MAZDA_DP_LHALF][1],
-	       dp_string,
-	       MAZDA_DP_MSG_SIZE - 1);
-	memcpy(&mdp_buffer[MAZDA_DP_RHALF][1],
-	       &dp_string[MAZDA_DP_CHAR_NUM - MAZDA_DP_MSG_SIZE + 1],
-	       MAZDA_DP_MSG_SIZE - 1);
+	/* Write arrows for the left and right halfs of the display */
+	if (left < MDP_STEP_CNT) {
+		for (int j = 0; j < MDP_STEP_STRLEN; j++) {
+			string[j] = dist_steps[left][j];
+		}
+	}
+
+	if (right < MDP_STEP_CNT) {
+		for (int j = MDP_STEP_STRLEN - 1; j >= 0; j--) {
+			char *ch = &string[MAZDA_DP_CHAR_NUM - 1 - j];
+
+			switch(dist_steps[right][j]) {
+			case '\xF0':		/* Solid right arrow */
+				*ch = '\xF1';	/* Solid left arrow */
+				break;
+			case '\x3E':		/* Usual right arrow */
+				*ch = '\x3C';	/* Usual left arrow */
+				break;
+			}
+		}
+	}
+}
+
+static uint16_t distance_min(const uint32_t *distance)
+{
+	return MIN(MIN(distance[MDP_SENSOR_A], distance[MDP_SENSOR_B]),
+		   MIN(distance[MDP_SENSOR_C], distance[MDP_SENSOR_D]));
 }
 
-static void distance_to_string(struct ptronic_data *ptronic, char *string)
+static struct mdp_beep_pattern distance_to_beep(void)
 {
-	const uint32_t dist_step = MDP_STEP;
-	const uint32_t l_flag = 0x80000000, r_flag = 0x00008000;
-	uint16_t main_dist, left_dist, right_dist;
-	uint32_t dist_flag = 0;
+	struct mdp_beep_pattern pattern = { 0 };
+	uint32_t main_dist, period;
 
 	/* No data from sensors */
-	if (!ptronic->valid) {
-		sprintf(string, MDP_NO_DATA_STR);
-		return;
+	if (mdp_zone_get(&beep_zone) == MDP_ZONE_INVALID)
+		return pattern;
+
+	main_dist = mdp_zone_cm(&beep_zone);
+	if (main_dist >= MDP_DIST_BEEP_NONE)
+		return pattern;
+
+	if (main_dist < MDP_DIST_BEEP_CONST) {
+		pattern.on_ms = MDP_BEEP_CONST_INTERVAL;
+		return pattern;
 	}
 
-	/* Get minimum distance for left and right halfs */
-	left_dist = MIN(ptronic->distance[MDP_SENSOR_A],
-			ptronic->distance[MDP_SENSOR_B]);
-	right_dist = MIN(ptronic->distance[MDP_SENSOR_C],
-			 ptronic->distance[MDP_SENSOR_D]);
-	main_dist = MIN(left_dist, right_dist);
+	/* Beep period is proportional to the distance, duty cycle is 50% */
+	period = MDP_BEEP_PERIOD_MIN +
+		 (main_dist - MDP_DIST_BEEP_CONST) *
+		 (MDP_BEEP_PERIOD_MAX - MDP_BEEP_PERIOD_MIN) /
+		 (MDP_DIST_BEEP_NONE - MDP_DIST_BEEP_CONST);
 
-	/* Write distance in meters */
-	sprintf(string, MDP_DATA_TMPL_STR, (main_dist / 100),
-		(main_dist % 100) / 10);
+	pattern.on_ms = period / 2;
+	pattern.off_ms = period - pattern.on_ms;
 
-	/* Write arrows for the left and right halfs of the display */
-	for (int i = 0; i < MDP_STEP_CNT; ++i) {
-		if (!(dist_flag & l_flag) && left_dist <= (dist_step * i)) {
-			for (int j = 0; j < MDP_STEP_STRLEN; j++) {
-				string[j] = dist_steps[i][j];
-			}
+	return pattern;
+}
 
-			dist_flag |= l_flag;
-		}
+#if (MDP_DIST_PREDICT == 1)
+static void distance_dp_sent(void)
+{
+	uint32_t now = mdp_tm_ms(), dt = now - dp_tx_ms;
 
-		if (!(dist_flag & r_flag) && right_dist <= (dist_step * i)) {
-			for (int j = MDP_STEP_STRLEN - 1; j >= 0; j--) {
-				char *ch = &string[MAZDA_DP_CHAR_NUM - 1 - j];
-
-				switch(dist_steps[i][j]) {
-				case '\xF0':		/* Solid right arrow */
-					*ch = '\xF1';	/* Solid left arrow */
-					break;
-				case '\x3E':		/* Usual right arrow */
-					*ch = '\x3C';	/* Usual left arrow */
-					break;
-				}
-			}
+	/* Gaps of a stopped head unit are not the frame period */
+	if (dt < 2 * MDP_DP_PERIOD_MS)
+		dp_period_ms += ((int32_t)dt - (int32_t)dp_period_ms) / 4;
+	dp_tx_ms = now;
+}
+
+/* Readings of one unit, only a new reading updates its tracker */
+static void distance_track(struct mdp_track *track, uint8_t *seen,
+			   const uint32_t *cm, const uint8_t *seq,
+			   uint32_t *out, uint32_t now_ms, uint32_t at_ms)
+{
+	for (int i = 0; i < MDP_SENSOR_CNT; i++) {
+		out[i] = cm[i];
+
+		/* Sensor failure, the reading is passed as is */
+		if (cm[i] > track_cfg.cm_max) {
+			mdp_track_reset(&track[i]);
+			continue;
+		}
 
-			dist_flag |= r_flag;
+		if (!track[i].valid || seq[i] != seen[i]) {
+			seen[i] = seq[i];
+			mdp_track_update(&track[i], &track_cfg, cm[i], now_ms);
 		}
 
-		if (dist_flag & l_flag & r_flag)
-			break;
+		out[i] = mdp_track_predict(&track[i], &track_cfg, at_ms);
 	}
 }
 
-static mdp_beep_mode_t distance_to_beep(struct ptronic_data *ptronic)
+/* Distance expected when the next display frame goes out */
+static struct ptronic_data *distance_predict(struct ptronic_data *ptronic)
 {
-	uint16_t main_dist, left_dist, right_dist;
+	uint32_t now = mdp_tm_ms(), at = dp_tx_ms + dp_period_ms;
 
-	/* No data from sensors */
-	if (!ptronic->valid)
-		return MDP_BEEP_NONE;
+	MDP_PROF_SCOPE(MDP_PROF_DIST_PREDICT);
+
+	if ((int32_t)(at - now) < 0)
+		at = now;
+
+	predicted = *ptronic;
+	distance_track(rear_track, rear_seq, ptronic->distance, ptronic->seq,
+		       predicted.distance, now, at);
+	distance_track(front_track, front_seq, ptronic->front,
+		       ptronic->front_seq, predicted.front, now, at);
+
+	ttc_ms = UINT32_MAX;
+	for (int i = 0; i < MDP_SENSOR_CNT; i++) {
+		ttc_ms = MIN(ttc_ms, mdp_track_ttc_ms(&rear_track[i],
+						      &track_cfg));
+		ttc_ms = MIN(ttc_ms, mdp_track_ttc_ms(&front_track[i],
+						      &track_cfg));
+	}
+
+	return &predicted;
+}
+#endif
+
+#if (MDP_TTC_WARNING == 1)
+/* Distance that gives the same time to contact at the reference speed */
+static uint32_t distance_ttc_cm(void)
+{
+	if (ttc_ms == UINT32_MAX)
+		return UINT32_MAX;
+
+	return ttc_ms * MDP_TTC_REF_SPEED / 1000;
+}
+
+/* Returns true if the display has to be blanked or restored */
+static bool distance_flash_update(void)
+{
+	bool blank = false, changed;
+
+	if (ttc_ms < MDP_TTC_FLASH_MS)
+		flash_on = true;
+	else if (ttc_ms > MDP_TTC_FLASH_OFF_MS)
+		flash_on = false;
+
+	if (flash_on)
+		blank = mdp_tm_ms() / MDP_FLASH_MS & 1;
+
+	changed = blank != flash_blank;
+	flash_blank = blank;
+
+	return changed;
+}
+#endif
+
+static void distance_zones_reset(void)
+{
+	mdp_zone_init(&left_zone, &arrow_zone_cfg);
+	mdp_zone_init(&right_zone, &arrow_zone_cfg);
+	mdp_zone_init(&text_zone, &text_zone_cfg);
+	mdp_zone_init(&beep_zone, &beep_zone_cfg);
+
+	parking_shown = false;
+	beep_applied = false;
+
+#if (MDP_DIST_PREDICT == 1)
+	for (int i = 0; i < MDP_SENSOR_CNT; i++) {
+		mdp_track_reset(&rear_track[i]);
+		mdp_track_reset(&front_track[i]);
+	}
+	ttc_ms = UINT32_MAX;
+#endif
+
+#if (MDP_TTC_WARNING == 1)
+	flash_on = false;
+	flash_blank = false;
+#endif
+}
+
+/* Returns true if the display text has to be rendered again */
+static bool distance_zones_update(struct ptronic_data *ptronic,
+				  bool *beep_changed)
+{
+	uint32_t now = mdp_tm_ms();
+	uint16_t left_dist, right_dist;
+	uint32_t beep_dist;
+	bool changed = false;
 
 	/* Get minimum distance for left and right halfs */
 	left_dist = MIN(ptronic->distance[MDP_SENSOR_A],
 			ptronic->distance[MDP_SENSOR_B]);
 	right_dist = MIN(ptronic->distance[MDP_SENSOR_C],
 			 ptronic->distance[MDP_SENSOR_D]);
-	main_dist = MIN(left_dist, right_dist);
 
-	if (main_dist >= MDP_DIST_BEEP_NONE) {
-		return MDP_BEEP_NONE;
-	} else if (main_dist < MDP_DIST_BEEP_NONE &&
-		   main_dist >= MDP_DIST_BEEP_SLOW) {
-		return MDP_BEEP_SLOW;
-	} else if (main_dist < MDP_DIST_BEEP_SLOW &&
-		   main_dist >= MDP_DIST_BEEP_FAST) {
-		return MDP_BEEP_FAST;
-	}
+	changed |= mdp_zone_update(&left_zone, left_dist, ptronic->valid, now);
+	changed |= mdp_zone_update(&right_zone, right_dist, ptronic->valid,
+				   now);
+	changed |= mdp_zone_update(&text_zone, MIN(left_dist, right_dist),
+				   ptronic->valid, now);
+
+	/* Beeps follow the closest obstacle, front or rear */
+	beep_dist = UINT16_MAX;
+	if (ptronic->valid)
+		beep_dist = distance_min(ptronic->distance);
+	if (ptronic->front_valid)
+		beep_dist = MIN(beep_dist, distance_min(ptronic->front));
+
+#if (MDP_TTC_WARNING == 1)
+	/* Faster approach beeps as if the obstacle was nearer */
+	beep_dist = MIN(beep_dist, distance_ttc_cm());
+#endif
+
+	*beep_changed = mdp_zone_update(&beep_zone, beep_dist,
+					ptronic->valid || ptronic->front_valid,
+					now);
 
-	return MDP_BEEP_CONST;
+	return changed;
 }
 
-static bool get_bit_state_updated(uint8_t byte, uint8_t bit,
-				  struct mdp_state *state)
+static bool get_state_updated(bool on, struct mdp_state *state)
 {
-	if ((byte & BIT(bit)) && !state->curr) {
+	if (on && !state->curr) {
 		state->curr = true;
 		state->prev = false;
 		return true;
 	}
 
-	if (!(byte & BIT(bit)) && state->curr) {
+	if (!on && state->curr) {
 		state->curr = false;
 		state->prev = true;
 		return true;
@@ -238,6 +432,35 @@ static bool get_bit_state_updated(uint8_t byte, uint8_t bit,
 	return false;
 }
 
+#if (MDP_PROFILER_ENABLED == 1)
+static void prof_cmd_handler(const char *args)
+{
+	if (!strcmp(args, "reset")) {
+		mdp_prof_reset();
+		return;
+	}
+
+	mdp_prof_dump();
+}
+
+static const struct mdp_console_cmd prof_cmd = {
+	.name = "prof",
+	.help = "Print profiling table, 'prof reset' to clear it",
+	.handler = prof_cmd_handler
+};
+#endif
+
+static void spibench_cmd_handler(const char *args)
+{
+	mdp_can_spi_bench();
+}
+
+static const struct mdp_console_cmd spibench_cmd = {
+	.name = "spibench",
+	.help = "Run MCP2515 SPI transaction benchmarks",
+	.handler = spibench_cmd_handler
+};
+
 static void app_inited_blink(void)
 {
 	mdp_sysled_toggle();
@@ -272,75 +495,376 @@ static void app_error_blink(void)
 	mdp_tm_msleep(MDP_ERROR_BLINK_DELAY);
 }
 
-static void mdp_can_replace_data(struct mdp_can_msg *msg)
+/* Called from CAN RX interrupt as soon as the status message arrives */
+static void mdp_stat_rx_hook(const struct mdp_can_msg *msg)
 {
-	switch(msg->id) {
-	case MAZDA_DP_MISC_SYMB_ID:
-		/* Turn off all active symbols */
-		/* CD IN/MD IN/ST/Dolby/RPT/RDM/AF symbols  */
-		/* PTY/TA/TP/AUTO-M symbols */
-		/* "":"/"'"/"." symbols */
-		msg->data[MAZDA_DP_MISC_SYMB0] &= MAZDA_DP_MISC_SYMB0_MSK;
-		msg->data[MAZDA_DP_MISC_SYMB1] &= MAZDA_DP_MISC_SYMB1_MSK;
-		msg->data[MAZDA_DP_MISC_SYMB2] &= MAZDA_DP_MISC_SYMB2_MSK;
-		break;
-	case MAZDA_DP_LHALF_ID:
-		memcpy(msg->data, mdp_buffer[MAZDA_DP_LHALF], msg->size);
+	bool rgear = mazda_sig_rgear(msg->data);
+
+	if (rgear && !rgear_isr_prev) {
+		rgear_rx_us = mdp_tm_us();
+		rgear_lat_pending = true;
+	}
+	rgear_isr_prev = rgear;
+
+	mazda_rgear = rgear;
+}
+
+static void mdp_rgear_latency_done(void)
+{
+	rgear_lat_pending = false;
+	rgear_lat_last_us = (uint32_t)(mdp_tm_us() - rgear_rx_us);
+	rgear_lat_max_us = MAX(rgear_lat_max_us, rgear_lat_last_us);
+
+	log_sys("Reverse to display latency %lu us\r\n", rgear_lat_last_us);
+}
+
+static bool mdp_rewrite_active(void)
+{
+	return mdp_display_visible() != MDP_DP_LAYER_NONE;
+}
+
+static bool mdp_rewrite_misc_symb(struct mdp_can_msg *msg)
+{
+	if (!mdp_rewrite_active())
+		return false;
+
+	/* Turn off all active symbols */
+	/* CD IN/MD IN/ST/Dolby/RPT/RDM/AF symbols  */
+	/* PTY/TA/TP/AUTO-M symbols */
+	/* "":"/"'"/"." symbols */
+	msg->data[MAZDA_DP_MISC_SYMB0] &= MAZDA_DP_MISC_SYMB0_MSK;
+	msg->data[MAZDA_DP_MISC_SYMB1] &= MAZDA_DP_MISC_SYMB1_MSK;
+	msg->data[MAZDA_DP_MISC_SYMB2] &= MAZDA_DP_MISC_SYMB2_MSK;
+	return true;
+}
+
+static bool mdp_rewrite_lhalf(struct mdp_can_msg *msg)
+{
+	if (!mdp_rewrite_active())
+		return false;
+
+	memcpy(msg->data, mdp_display_frame(MAZDA_DP_LHALF), msg->size);
+	mdp_sysled_toggle();
+
+#if (MDP_DIST_PREDICT == 1)
+	distance_dp_sent();
+#endif
+
+	if (rgear_state.curr && rgear_lat_pending)
+		mdp_rgear_latency_done();
+
+	return true;
+}
+
+static bool mdp_rewrite_rhalf(struct mdp_can_msg *msg)
+{
+	if (!mdp_rewrite_active())
+		return false;
+
+	memcpy(msg->data, mdp_display_frame(MAZDA_DP_RHALF), msg->size);
+	mdp_sysled_toggle();
+	return true;
+}
+
+/* Inspects frames going to the display at reception time */
+static void mdp_pjb_rx_hook(const struct mdp_can_msg *msg)
+{
+	switch (mdp_vehicle_msg(msg->id)) {
+	case MDP_VEH_MSG_STAT:
+		memcpy(mazda_stat_data, msg->data, sizeof(mazda_stat_data));
+		if (!rgear_in_isr)
+			mdp_stat_rx_hook(msg);
 		break;
-	case MAZDA_DP_RHALF_ID:
-		memcpy(msg->data, mdp_buffer[MAZDA_DP_RHALF], msg->size);
+#if (MDP_OVERRIDE_GREETING == 1)
+	case MDP_VEH_MSG_DP_MISC:
+		/* Expires by itself if the display stops being updated */
+		if (mazda_sig_dp_init(msg->data))
+			mdp_display_show(MDP_DP_LAYER_GREETING,
+					 MDP_GREETING_MESSAGE, MDP_GREETING_TTL);
+		else
+			mdp_display_hide(MDP_DP_LAYER_GREETING);
 		break;
+#endif
 	default:
-		return;
+		break;
 	}
 }
 
-static void mdp_can_transfer(bool replace)
+/* Indexed by the message role of the active vehicle profile */
+static const mdp_gw_rewrite_t pjb_to_dp_rules[MDP_VEH_MSG_COUNT] = {
+	[MDP_VEH_MSG_DP_MISC] = mdp_rewrite_misc_symb,
+	[MDP_VEH_MSG_DP_LHALF] = mdp_rewrite_lhalf,
+	[MDP_VEH_MSG_DP_RHALF] = mdp_rewrite_rhalf,
+};
+
+/* Only display messages are paced, other traffic is not limited */
+static const uint16_t pjb_to_dp_gaps[MDP_VEH_MSG_COUNT] = {
+	[MDP_VEH_MSG_DP_MISC] = MDP_MAGIC_GAP_US,
+	[MDP_VEH_MSG_DP_LHALF] = MDP_MAGIC_GAP_US,
+	[MDP_VEH_MSG_DP_RHALF] = MDP_MAGIC_GAP_US,
+};
+
+static struct mdp_gw_dir pjb_to_dp = {
+	.name = "pjb->dp",
+	.index = 0,
+	.src = &pjb_can,
+	.dst = &dp_can,
+	.class_map = mdp_vehicle_map,
+	.rules = pjb_to_dp_rules,
+	.tx_gaps = pjb_to_dp_gaps,
+	.rules_cnt = ARRAY_SIZE(pjb_to_dp_rules),
+	.on_rx = mdp_pjb_rx_hook,
+};
+
+/* Nothing is rewritten on the way from the display segment */
+static struct mdp_gw_dir dp_to_pjb = {
+	.name = "dp->pjb",
+	.index = 1,
+	.src = &dp_can,
+	.dst = &pjb_can,
+};
+
+static void mdp_can_update_bypass(bool recovering)
+{
+	static bool bypass;
+
+	if (bypass == recovering)
+		return;
+
+	bypass = recovering;
+	mdp_bbox_event(MDP_BBOX_EV_BYPASS, bypass);
+
+#if (MDP_USE_CAN_BYPASS == 1)
+	/* Display is connected directly to PJB while we are recovering */
+	if (bypass)
+		mdp_can_bypass_on();
+	else
+		mdp_can_bypass_off();
+#endif
+}
+
+static void mdp_can_transfer(void)
+{
+	bool pjb_ok, dp_ok;
+
+	MDP_PROF_SCOPE(MDP_PROF_CAN_TRANSFER);
+
+	pjb_ok = mdp_can_recover(&pjb_can);
+	dp_ok = mdp_can_recover(&dp_can);
+
+	mdp_can_update_bypass(!pjb_ok || !dp_ok);
+	if (!pjb_ok || !dp_ok)
+		return;
+
+	mdp_gw_poll(&pjb_to_dp);
+	mdp_gw_poll(&dp_to_pjb);
+}
+
+static void canstat_cmd_handler(const char *args)
+{
+	mdp_can_print_stats(&pjb_can);
+	mdp_can_print_stats(&dp_can);
+	mdp_can_spi_print_stats();
+
+	log_sys("Reverse to display latency: last %lu us, max %lu us\r\n",
+		rgear_lat_last_us, rgear_lat_max_us);
+}
+
+static void sniff_cmd_handler(const char *args)
 {
 	int ret;
 
-	ret = mdp_can_read(&pjb_can);
-	if (ret > 0) {
-		if (pjb_can.msg.id == MAZDA_STAT_ID)
-			mazda_stat = pjb_can.msg.data[MAZDA_STAT_RGEAR_BYTE];
+	log_sys("Sniffer mode, reset the board to exit\r\n");
 
-#if (MDP_OVERRIDE_GREETING == 1)
-		if (pjb_can.msg.id == MAZDA_DP_MISC_SYMB_ID) {
-			greetin_replace = pjb_can.msg.data[MAZDA_DP_MISC_SYMB2];
-			greetin_replace &= BIT(MAZDA_DP_MISC_INIT_BIT);
-			if (greetin_replace)
-				update_display(MDP_GREETING_MESSAGE);
-		}
+#if (MDP_POWER_GOVERNOR == 1)
+	mdp_power_set_mode(MDP_POWER_ACTIVE);
 #endif
-		if (replace || greetin_replace) {
-			mdp_can_replace_data(&pjb_can.msg);
-			mdp_sysled_toggle();
-		}
 
-		memcpy(&dp_can.msg, &pjb_can.msg, sizeof(dp_can.msg));
+#if (MDP_USE_CAN_BYPASS == 1)
+	/* Vehicle and display keep talking directly, nothing is rewritten */
+	mdp_can_bypass_on();
+#endif
+
+	ret = mdp_sniffer_start(&pjb_can, &dp_can);
+	if (ret) {
+		log_err("Sniffer start failed: %d\r\n", ret);
+		error_handler();
+	}
+}
+
+static const struct mdp_console_cmd sniff_cmd = {
+	.name = "sniff",
+	.help = "Stream CAN frames in binary format, until reset",
+	.handler = sniff_cmd_handler
+};
+
+static void edgecap_cmd_handler(const char *args)
+{
+	int ret;
 
-		/* Magic sleep */
-		mdp_tm_msleep(MDP_MAGIC_SLEEP_MS);
+	log_sys("Edge capture mode, reset the board to exit\r\n");
 
-		ret = mdp_can_write(&dp_can);
-		if (ret < 0) {
-			log_err("MDP CAN DP write failed!\r\n");
-			error_handler();
-		}
-	} else if (ret < 0) {
-		log_err("MDP CAN PJB read failed!\r\n");
+#if (MDP_POWER_GOVERNOR == 1)
+	/* Cycle counter rate must not change while capturing */
+	mdp_power_set_mode(MDP_POWER_ACTIVE);
+#endif
+
+#if (MDP_USE_CAN_BYPASS == 1)
+	mdp_can_bypass_on();
+#endif
+
+	ret = mdp_edgecap_start();
+	if (ret) {
+		log_err("Edge capture start failed: %d\r\n", ret);
 		error_handler();
 	}
 }
 
+static const struct mdp_console_cmd edgecap_cmd = {
+	.name = "edgecap",
+	.help = "Stream parktronic line edges in binary format, until reset",
+	.handler = edgecap_cmd_handler
+};
+
+#if (MDP_BBOX_ENABLED == 1)
+static void bbox_cmd_handler(const char *args)
+{
+	if (!strcmp(args, "dump")) {
+		mdp_bbox_dump();
+	} else if (!strcmp(args, "save")) {
+		/* Commit stalls the gateway, see mdp_run() */
+		mdp_can_update_bypass(true);
+		mdp_bbox_commit(MDP_BBOX_EV_TRIGGER);
+	} else if (!strcmp(args, "clear")) {
+		mdp_bbox_clear();
+	} else {
+		log_sys("Usage: bbox dump|save|clear\r\n");
+	}
+}
+
+static const struct mdp_console_cmd bbox_cmd = {
+	.name = "bbox",
+	.help = "Black-box recorder: dump|save|clear",
+	.handler = bbox_cmd_handler
+};
+#endif
+
+static void ptlearn_cmd_handler(const char *args)
+{
+	int ret;
+
+	if (!*args) {
+		ptronic_print_timing();
+	} else if (!strcmp(args, "start")) {
+#if (MDP_POWER_GOVERNOR == 1)
+		/* Pulses are timed by the cycle counter, the core must run */
+		mdp_power_set_mode(MDP_POWER_ACTIVE);
+#endif
+		ptronic_learn_start();
+		log_sys("Learning parktronic timing, keep it on\r\n");
+	} else if (!strcmp(args, "clear")) {
+		ret = ptronic_learn_clear();
+		if (ret)
+			log_err("Timing clear failed: %d\r\n", ret);
+		ptronic_print_timing();
+	} else {
+		log_sys("Usage: ptlearn [start|clear]\r\n");
+	}
+}
+
+static const struct mdp_console_cmd ptlearn_cmd = {
+	.name = "ptlearn",
+	.help = "Print, learn or clear parktronic timing: start|clear",
+	.handler = ptlearn_cmd_handler
+};
+
+static void sig_cmd_handler(const char *args)
+{
+	mdp_can_signal_print(mazda_signals, ARRAY_SIZE(mazda_signals),
+			     MDP_VEH_MSG_STAT, mdp_vehicle_id(MDP_VEH_MSG_STAT),
+			     mazda_stat_data);
+}
+
+static const struct mdp_console_cmd sig_cmd = {
+	.name = "sig",
+	.help = "Print signals of the last status message",
+	.handler = sig_cmd_handler
+};
+
+static const struct mdp_console_cmd canstat_cmd = {
+	.name = "canstat",
+	.help = "Print CAN fault and recovery statistics",
+	.handler = canstat_cmd_handler
+};
+
+static void mdp_vehicle_set_prio_hook(void)
+{
+#if (MDP_RGEAR_IN_ISR == 1)
+	/* Status message is handled at reception time, if supported */
+	rgear_in_isr = !mdp_can_set_prio_hook(&pjb_can,
+					      mdp_vehicle_id(MDP_VEH_MSG_STAT),
+					      mdp_stat_rx_hook);
+#endif
+}
+
+static int mdp_vehicle_init(void)
+{
+	int ret;
+
+	if (strcmp(MDP_VEHICLE_PROFILE, "auto")) {
+		ret = mdp_vehicle_select(MDP_VEHICLE_PROFILE);
+		if (ret)
+			log_err("Unknown vehicle profile: %s\r\n",
+				MDP_VEHICLE_PROFILE);
+		return ret;
+	}
+
+	/* Display keeps working through the bypass while we listen */
+	return mdp_vehicle_detect(&pjb_can);
+}
+
+static void veh_cmd_handler(const char *args)
+{
+	int ret;
+
+	if (!*args) {
+		mdp_vehicle_print();
+		return;
+	}
+
+	ret = mdp_vehicle_select(args);
+	if (ret) {
+		log_err("Unknown vehicle profile: %s\r\n", args);
+		return;
+	}
+
+	/* Service bytes are taken from the profile */
+	mdp_display_invalidate();
+
+	/* Priority filter is applied on start */
+	mdp_vehicle_set_prio_hook();
+	mdp_can_stop(&pjb_can);
+	ret = mdp_can_start(&pjb_can);
+	if (ret)
+		log_err("PJB CAN (%s) restart failed: %d\r\n", pjb_can.name,
+			ret);
+}
+
+static const struct mdp_console_cmd veh_cmd = {
+	.name = "veh",
+	.help = "Print or select vehicle profile: veh [name]",
+	.handler = veh_cmd_handler
+};
+
 void mdp_init(void)
 {
 	int ret;
 
 	log_app_info();
 
-	dp_can = mdp_get_can_spi_interface();
-	pjb_can = mdp_get_can_hal_interface();
+	mdp_bbox_init();
+
+	ptronic_init();
 
 #if (MDP_USE_CAN_BYPASS == 1)
 	/* Bypass all CAN packets through while board is not inited */
@@ -349,8 +873,48 @@ void mdp_init(void)
 	mdp_can_bypass_off();
 #endif
 
+#if (MDP_USE_CAN_BYPASS == 1) && (MDP_CAN_HAL_ROLE == MDP_CAN_ROLE_AUTO)
+	/**
+	 * Segments are separated while traffic is sampled. The vehicle
+	 * segment has plenty of nodes to acknowledge frames, the display
+	 * segment has only the display and nobody acknowledges its frames
+	 * in listen-only mode, so they are not counted.
+	 */
+	mdp_can_bypass_off();
+	ret = mdp_can_assign_roles(&pjb_can, &dp_can);
+	mdp_can_bypass_on();
+#else
+	ret = mdp_can_assign_roles(&pjb_can, &dp_can);
+#endif
+	if (ret) {
+		log_err("CAN roles assignment failed!\r\n");
+		goto exit_error;
+	}
+
+	ret = mdp_vehicle_init();
+	if (ret) {
+		log_err("Vehicle profile init failed!\r\n");
+		goto exit_error;
+	}
+
+	mdp_vehicle_set_prio_hook();
+
 	mdp_sysled_off();
 
+#if (MDP_PROFILER_ENABLED == 1)
+	mdp_console_register(&prof_cmd);
+#endif
+	mdp_console_register(&spibench_cmd);
+	mdp_console_register(&canstat_cmd);
+	mdp_console_register(&sniff_cmd);
+	mdp_console_register(&edgecap_cmd);
+	mdp_console_register(&sig_cmd);
+	mdp_console_register(&veh_cmd);
+	mdp_console_register(&ptlearn_cmd);
+#if (MDP_BBOX_ENABLED == 1)
+	mdp_console_register(&bbox_cmd);
+#endif
+
 #if (MDP_BEEPER_ENABLED == 1)
 	if (!mdp_beeper_init(MDP_BEEP_FREQ))
 		log_err("Beeper init failed\r\n");
@@ -361,70 +925,179 @@ void mdp_init(void)
 
 	ret = mdp_can_start(&dp_can);
 	if (ret) {
-		log_err("DP CAN (SPI) start failed!\r\n");
+		log_err("DP CAN (%s) start failed!\r\n", dp_can.name);
 		goto exit_error;
 	}
 
 	ret = mdp_can_start(&pjb_can);
 	if (ret) {
-		log_err("PJB CAN (HAL) start failed!\r\n");
+		log_err("PJB CAN (%s) start failed!\r\n", pjb_can.name);
 		goto exit_error;
 	}
 
+	mdp_gw_reset_stats(&pjb_to_dp);
+	mdp_gw_reset_stats(&dp_to_pjb);
+
 #if (MDP_USE_CAN_BYPASS == 1)
 	mdp_can_bypass_off();
 #endif
 	app_inited_blink();
 
+#if (MDP_POWER_GOVERNOR == 1)
+	mdp_power_register(mdp_can_spi_update_clock);
+#if (MDP_BEEPER_ENABLED == 1)
+	mdp_power_register(mdp_beeper_update_clock);
+#endif
+	/* Parktronic is off at startup, nothing to do but forward frames */
+	mdp_power_set_mode(MDP_POWER_IDLE);
+#endif
+
 	return;
 
 exit_error:
 	error_handler();
 }
 
-void mdp_run(void)
+static void mdp_update_rgear(void)
 {
 	bool state_updated;
+
+	state_updated = get_state_updated(mazda_rgear, &rgear_state);
+	if (!state_updated)
+		return;
+
+	mdp_bbox_event(MDP_BBOX_EV_RGEAR, rgear_state.curr);
+
+	if (rgear_state.curr) {
+		log_sys("Parktronic enabled!\r\n");
+
+#if (MDP_POWER_GOVERNOR == 1)
+		mdp_power_set_mode(MDP_POWER_ACTIVE);
+#endif
+
+		/* Keep forwarding, distance beeps start after the delay */
+		rgear_on_ms = mdp_tm_ms();
+		distance_zones_reset();
+		mdp_beeper_set_mode(MDP_BEEP_CONST);
+		mdp_display_show(MDP_DP_LAYER_PARKING, MDP_NO_DATA_STR,
+				 MDP_DP_TTL_FOREVER);
+	} else {
+		log_sys("Parktronic disabled!\r\n");
+
+		mdp_display_hide(MDP_DP_LAYER_PARKING);
+		mdp_display_hide(MDP_DP_LAYER_ERROR);
+
+		mdp_beeper_set_mode(MDP_BEEP_NONE);
+
+#if (MDP_POWER_GOVERNOR == 1)
+		mdp_power_set_mode(MDP_POWER_IDLE);
+#endif
+	}
+}
+
+static void mdp_update_learn(void)
+{
+	int ret = ptronic_learn_poll();
+
+	if (ret == -EINPROGRESS)
+		return;
+
+	if (ret) {
+		log_err("Parktronic timing not learned: %d\r\n", ret);
+	} else {
+		ptronic_print_timing();
+	}
+
+#if (MDP_POWER_GOVERNOR == 1)
+	if (!rgear_state.curr)
+		mdp_power_set_mode(MDP_POWER_IDLE);
+#endif
+}
+
+static void mdp_update_parking(void)
+{
 	char dist_str[MAZDA_DP_CHAR_NUM * 2];
 	struct ptronic_data *data;
+	struct mdp_beep_pattern beep;
+	bool init_beep = mdp_tm_ms() - rgear_on_ms < MDP_INIT_BEEP_DELAY;
+	bool text_changed, beep_changed, blank = false;
+
+	if (!mdp_ptronic_is_enabled()) {
+		/* Reverse gear detected but parktronic turned off */
+		if (!init_beep)
+			mdp_beeper_set_mode(MDP_BEEP_NONE);
+		mdp_display_hide(MDP_DP_LAYER_PARKING);
+		mdp_display_show(MDP_DP_LAYER_ERROR, MDP_PARK_ERR_STR,
+				 MDP_PARK_ERR_TTL);
+		log_err("Parktronic signal not detected!\r\n");
+		distance_zones_reset();
+		return;
+	}
 
-	mdp_can_transfer(rgear_state.curr);
+	data = ptronic_read_data();
+#if (MDP_DIST_PREDICT == 1)
+	data = distance_predict(data);
+#endif
+	text_changed = distance_zones_update(data, &beep_changed);
 
-	state_updated = get_bit_state_updated(mazda_stat, MAZDA_STAT_RGEAR_BIT,
-					      &rgear_state);
-	if (state_updated) {
-		if (rgear_state.curr) {
-			log_sys("Parktronic enabled!\r\n");
+	/* Nothing is rebuilt while the readings stay in the same zones */
+	if (!init_beep && (beep_changed || !beep_applied)) {
+		beep = distance_to_beep();
+		mdp_beeper_set_pattern(&beep);
+		beep_applied = true;
+	}
 
-			mdp_beeper_set_mode(MDP_BEEP_CONST);
-			mdp_beeper_beep();
+#if (MDP_TTC_WARNING == 1)
+	text_changed |= distance_flash_update();
+	blank = flash_blank;
+#endif
 
-			mdp_tm_msleep(MDP_INIT_BEEP_DELAY);
+	if (text_changed || !parking_shown) {
+		if (blank)
+			dist_str[0] = '\0';
+		else
+			distance_to_string(dist_str);
+		mdp_display_show(MDP_DP_LAYER_PARKING, dist_str,
+				 MDP_DP_TTL_FOREVER);
+		parking_shown = true;
+	}
+}
 
-			mdp_beeper_set_mode(MDP_BEEP_NONE);
-			mdp_beeper_beep();
-		} else {
-			log_sys("Parktronic disabled!\r\n");
+void mdp_run(void)
+{
+	if (mdp_sniffer_active()) {
+		mdp_sniffer_poll();
+		return;
+	}
 
-			mdp_beeper_set_mode(MDP_BEEP_NONE);
-			mdp_beeper_beep();
-		}
+	if (mdp_edgecap_active()) {
+		mdp_edgecap_poll();
+		return;
 	}
 
-	if (rgear_state.curr) {
-		if (!mdp_ptronic_is_enabled()) {
-			/* Reverse gear detected but parktronic turned off */
-			update_display(MDP_PARK_ERR_STR);
-			log_err("Parktronic signal not detected!\r\n");
-			return;
-		}
+	mdp_console_poll();
 
-		data = ptronic_read_data();
+	/* Display buffer is prepared before the next frame is forwarded */
+	mdp_update_rgear();
+	if (rgear_state.curr)
+		mdp_update_parking();
+	if (ptronic_learning())
+		mdp_update_learn();
+	mdp_display_poll();
 
-		mdp_beeper_set_mode(distance_to_beep(data));
-		mdp_beeper_beep();
+	mdp_can_transfer();
 
-		distance_to_string(data, dist_str);
-		update_display(dist_str);
+	/**
+	 * Flash commit stalls forwarding for 100-300 ms, the display is
+	 * connected to PJB directly meanwhile. The next transfer takes the
+	 * bypass back if both interfaces are operational.
+	 */
+	if (mdp_bbox_due()) {
+		mdp_can_update_bypass(true);
+		mdp_bbox_poll();
 	}
+
+	/* Returns immediately if not in the idle mode */
+	if (!mdp_gw_pending(&pjb_to_dp) && !mdp_gw_pending(&dp_to_pjb))
+		mdp_power_idle();
 }
@@ -31,6 +31,8 @@
 #define __MAZDA_DP_PARKTRONIC_H__
 
 #include "boardinfo.h"
+#include "can_signal.h"
+#include "vehicle.h"
 #include "log.h"
 
 /* Common */
@@ -40,32 +42,51 @@
  * Display
  *     Display update time is about 4 FPS (every 250 ms)
  */
-#define MAZDA_DP_MISC_SYMB_ID	0x28F /* ID of the display misc symbols */
 #define MAZDA_DP_MISC_SYMB0	0 /* CD IN/MD IN/ST/Dolby/RPT/RDM/AF symbols */
 #define MAZDA_DP_MISC_SYMB1	1 /* PTY/TA/TP/AUTO-M symbols */
 #define MAZDA_DP_MISC_SYMB2	3 /* "":"/"'"/"." symbols */
 #define MAZDA_DP_MISC_SYMB0_MSK 0x80 /* Dispay sysmbols mask */
 #define MAZDA_DP_MISC_SYMB1_MSK 0x0F /* Dispay sysmbols mask */
 #define MAZDA_DP_MISC_SYMB2_MSK 0xC9 /* Dispay sysmbols mask */
-#define MAZDA_DP_MISC_INIT_BIT	0 /* Bit to turn off all symbols when ACC on */
 #define MAZDA_DP_LHALF		0 /* ID of the display left half */
 #define MAZDA_DP_RHALF		1 /* ID of the display right half */
 #define MAZDA_DP_REG_NUM	2 /* Number of display registers */
 #define MAZDA_DP_MSG_SIZE	8 /* Display message size */
 #define MAZDA_DP_CHAR_NUM	12 /* Maximum number of characters on display */
-#define MAZDA_DP_LHALF_ID	0x290 /* Message ID of the display left half */
-#define MAZDA_DP_RHALF_ID	0x291 /* Message ID of the display right half */
-#define MAZDA_DP_LHALF_BYTE	0xC0 /* 1st byte of display left half packet */
-#define MAZDA_DP_RHALF_BYTE	0x85 /* 1st byte of display right half packet */
 
-/* Status */
-#define MAZDA_STAT_ID		0x433 /* ID of the status message */
-#define MAZDA_STAT_RGEAR_BYTE	3 /* Reverse gear byte number */
-#define MAZDA_STAT_RGEAR_BIT	1 /* Reverse gear bit number */
-#define MAZDA_STAT_HBRAKE_BYTE	3 /* Hand brake byte number */
-#define MAZDA_STAT_HBRAKE_BIT	0 /* Hand brake bit number */
-#define MAZDA_STAT_FLDOOR_BYTE	0 /* Front left door byte number */
-#define MAZDA_STAT_FLDOOR_BIT	7 /* Front left door bit number */
+/*
+ * Message IDs and display service bytes depend on the car variant,
+ * see vehicle.c for the profiles.
+ *
+ * Signals, see can_signal.h for the bit numbering.
+ * Every signal gets an inline extractor "mazda_sig_<name>(data)".
+ * Messages are given by role, so the table fits every profile.
+ *
+ *	name,		message role,		start, len, order,
+ *	signed,	scale num, scale den, offset
+ */
+#define MAZDA_SIGNALS(X)						\
+	X(dp_init,	MDP_VEH_MSG_DP_MISC,	24, 1, MDP_SIG_LE,	\
+	  false, 1, 1, 0)	/* All symbols off, when ACC on */	\
+	X(fldoor,	MDP_VEH_MSG_STAT,	7, 1, MDP_SIG_LE,	\
+	  false, 1, 1, 0)	/* Front left door open */		\
+	X(hbrake,	MDP_VEH_MSG_STAT,	24, 1, MDP_SIG_LE,	\
+	  false, 1, 1, 0)	/* Hand brake on */			\
+	X(rgear,	MDP_VEH_MSG_STAT,	25, 1, MDP_SIG_LE,	\
+	  false, 1, 1, 0)	/* Reverse gear engaged */
+
+#define __MAZDA_SIG_EXTRACTOR(...)	MDP_SIG_EXTRACTOR(mazda_sig, __VA_ARGS__)
+#define __MAZDA_SIG_ENUM(name, ...)	MAZDA_SIG_##name,
+
+MAZDA_SIGNALS(__MAZDA_SIG_EXTRACTOR)
+
+enum {
+	MAZDA_SIGNALS(__MAZDA_SIG_ENUM)
+	MAZDA_SIG_COUNT
+};
+
+/* Signal table for the generic decoder */
+extern const struct mdp_can_signal mazda_signals[MAZDA_SIG_COUNT];
 
 /**
  * @brief Initialize Mazda Display Parktronic application.
@@ -0,0 +1,69 @@
+/**
+ * @file       flash_intf.h
+ * @brief      Internal flash interface wrapper, the purpose is to use
+ *             different MCU's with the regions reserved in the linker
+ *             script (BBOX, F2616). Region wrappers pass their base
+ *             address.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_FLASH_INTF_H__
+#define __MDP_FLASH_INTF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef STM32F103xB
+#include "stm32f1xx_hal.h"
+#endif /* STM32F103xB */
+
+/* Erases all pages covering size bytes from the page aligned addr */
+static inline bool mdp_intf_flash_erase(uint32_t addr, uint32_t size)
+{
+#ifdef STM32F103xB
+	FLASH_EraseInitTypeDef erase = {
+		.TypeErase = FLASH_TYPEERASE_PAGES,
+		.PageAddress = addr,
+		.NbPages = (size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE,
+	};
+	uint32_t page_err;
+	HAL_StatusTypeDef ret;
+
+	HAL_FLASH_Unlock();
+	ret = HAL_FLASHEx_Erase(&erase, &page_err);
+	HAL_FLASH_Lock();
+
+	return ret == HAL_OK;
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+/* Address and size must be even, flash is programmed by half-words */
+static inline bool mdp_intf_flash_program(uint32_t addr, const uint8_t *data,
+					  uint32_t size)
+{
+#ifdef STM32F103xB
+	HAL_StatusTypeDef ret = HAL_OK;
+	uint16_t hword;
+
+	HAL_FLASH_Unlock();
+
+	for (uint32_t i = 0; i < size && ret == HAL_OK; i += 2) {
+		hword = data[i] | (data[i + 1] << 8);
+		ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr + i,
+					hword);
+	}
+
+	HAL_FLASH_Lock();
+
+	return ret == HAL_OK;
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_FLASH_INTF_H__ */
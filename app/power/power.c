@@ -0,0 +1,79 @@
+/**
+ * @file       power.c
+ * @brief      Power/performance governor implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "power.h"
+#include "power_intf.h"
+#include "boardinfo.h"
+#include "bbox.h"
+
+#include "log.h"
+#include "common.h"
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_power"
+
+#define power_set_clock(x)	mdp_intf_power_set_clock(x)
+#define power_wait()		mdp_intf_power_wait()
+
+static void (*callbacks[MDP_POWER_MAX_CALLBACKS])(void);
+static int callbacks_cnt;
+
+/* System clock is configured for the active mode at startup */
+static mdp_power_mode_t power_mode = MDP_POWER_ACTIVE;
+
+bool mdp_power_register(void (*cb)(void))
+{
+	if (!cb || callbacks_cnt >= MDP_POWER_MAX_CALLBACKS) {
+		log_err("Unable to register callback %p\r\n", cb);
+		return false;
+	}
+
+	callbacks[callbacks_cnt++] = cb;
+	return true;
+}
+
+void mdp_power_set_mode(mdp_power_mode_t mode)
+{
+	uint32_t primask, hz;
+
+	if (mode == power_mode)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	hz = power_set_clock(mode == MDP_POWER_ACTIVE);
+	mdp_tm_set_clock(hz);
+
+	__set_PRIMASK(primask);
+
+	power_mode = mode;
+	mdp_bbox_event(MDP_BBOX_EV_POWER, mode);
+
+	for (int i = 0; i < callbacks_cnt; i++)
+		callbacks[i]();
+
+	log_dbg("%s mode, HCLK %lu MHz\r\n",
+		mode == MDP_POWER_ACTIVE ? "Active" : "Idle", MDP_CLOCK_FREQ_MHZ);
+}
+
+mdp_power_mode_t mdp_power_get_mode(void)
+{
+	return power_mode;
+}
+
+void mdp_power_idle(void)
+{
+	if (power_mode != MDP_POWER_IDLE)
+		return;
+
+	power_wait();
+}
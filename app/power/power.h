@@ -0,0 +1,59 @@
+/**
+ * @file       power.h
+ * @brief      Power/performance governor.
+ *
+ *             The device runs at full speed only while the parking
+ *             sensors are active. The rest of the time it only forwards
+ *             CAN frames, so the core clock is lowered and the core
+ *             sleeps between frames.
+ *
+ *             Modules depending on the bus clocks register a callback,
+ *             which is called after every clock switch.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_POWER_H__
+#define __MDP_POWER_H__
+
+#include <stdbool.h>
+
+#define MDP_POWER_MAX_CALLBACKS	4
+
+typedef enum {
+	MDP_POWER_ACTIVE = 0,
+	MDP_POWER_IDLE,
+} mdp_power_mode_t;
+
+/**
+ * @brief Register clock change callback.
+ *
+ * @param [in] cb Function to call after the clock switch.
+ *
+ * @return true if callback was registered, false otherwise.
+ */
+bool mdp_power_register(void (*cb)(void));
+
+/**
+ * @brief Switch power mode, does nothing if the mode is already set.
+ *
+ * @param [in] mode New power mode.
+ */
+void mdp_power_set_mode(mdp_power_mode_t mode);
+
+/**
+ * @brief Get current power mode.
+ *
+ * @return Current power mode.
+ */
+mdp_power_mode_t mdp_power_get_mode(void);
+
+/**
+ * @brief Sleep until the next CAN frame, console input or SysTick.
+ *        Returns immediately in active mode.
+ */
+void mdp_power_idle(void);
+
+#endif /* __MDP_POWER_H__ */
@@ -0,0 +1,112 @@
+/**
+ * @file       power_intf.h
+ * @brief      Power management interface wrapper, the purpose is to use
+ *             different MCU's with the power governor API.
+ *
+ *             SYSCLK is PLL 72 MHz in both modes, only bus prescalers
+ *             are changed:
+ *                 Active: HCLK = 72 MHz, PCLK1 = 36 MHz, PCLK2 = 72 MHz.
+ *                 Idle:   HCLK = 36 MHz, PCLK1 = 36 MHz, PCLK2 = 36 MHz.
+ *             PCLK1 is the same in both modes, so bxCAN and USART3 bit
+ *             timings are not affected by the switch.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_POWER_INTF_H__
+#define __MDP_POWER_INTF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef STM32F103xB
+#include "stm32f1xx_hal.h"
+
+extern CAN_HandleTypeDef hcan;
+extern UART_HandleTypeDef huart3;
+
+#define __MCU_ACTIVE_CFGR	(RCC_SYSCLK_DIV1 | RCC_HCLK_DIV2)
+#define __MCU_ACTIVE_LATENCY	FLASH_LATENCY_2
+#define __MCU_IDLE_CFGR		(RCC_SYSCLK_DIV2 | RCC_HCLK_DIV1)
+#define __MCU_IDLE_LATENCY	FLASH_LATENCY_1
+#elif defined(MDP_HOST)
+#include "host.h"
+
+#define __HOST_ACTIVE_HCLK	72000000
+#define __HOST_IDLE_HCLK	36000000
+#endif /* STM32F103xB */
+
+/**
+ * Must be called with interrupts disabled. Returns new HCLK frequency.
+ */
+static inline uint32_t mdp_intf_power_set_clock(bool active)
+{
+#ifdef STM32F103xB
+	/**
+	 * HPRE and PPRE1 are changed with a single write, unlike
+	 * HAL_RCC_ClockConfig() which passes through PCLK1 = HCLK / 16
+	 * and would corrupt a frame being received by bxCAN.
+	 * Flash latency is raised before and lowered after the switch.
+	 */
+	if (active) {
+		__HAL_FLASH_SET_LATENCY(__MCU_ACTIVE_LATENCY);
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_PPRE1,
+			   __MCU_ACTIVE_CFGR);
+	} else {
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_PPRE1,
+			   __MCU_IDLE_CFGR);
+		__HAL_FLASH_SET_LATENCY(__MCU_IDLE_LATENCY);
+	}
+
+	SystemCoreClockUpdate();
+	HAL_InitTick(uwTickPrio);
+
+	return SystemCoreClock;
+#elif defined(MDP_HOST)
+	host_set_hclk(active ? __HOST_ACTIVE_HCLK : __HOST_IDLE_HCLK);
+	return HAL_RCC_GetHCLKFreq();
+#else
+	return 0;
+#endif /* STM32F103xB */
+}
+
+static inline void mdp_intf_power_wait(void)
+{
+#ifdef STM32F103xB
+	uint32_t primask = __get_PRIMASK();
+
+	/**
+	 * WFI wakes up on a pending enabled interrupt even if PRIMASK
+	 * is set. Wake up sources are enabled only for the sleep time
+	 * and disabled again before interrupts are unmasked, so their
+	 * handlers are never called.
+	 *
+	 * SysTick and decoder EXTI wake up the core as usual.
+	 */
+	__disable_irq();
+
+	__HAL_CAN_ENABLE_IT(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING);
+	__HAL_UART_ENABLE_IT(&huart3, UART_IT_RXNE);
+	NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+	NVIC_EnableIRQ(USART3_IRQn);
+
+	__DSB();
+	__WFI();
+
+	__HAL_CAN_DISABLE_IT(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING);
+	__HAL_UART_DISABLE_IT(&huart3, UART_IT_RXNE);
+	NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+	NVIC_DisableIRQ(USART3_IRQn);
+	NVIC_ClearPendingIRQ(USB_LP_CAN1_RX0_IRQn);
+	NVIC_ClearPendingIRQ(USART3_IRQn);
+
+	__set_PRIMASK(primask);
+#elif defined(MDP_HOST)
+	/* SysTick or a bxCAN frame wakes up, the same as on the MCU */
+	host_sleep();
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_POWER_INTF_H__ */
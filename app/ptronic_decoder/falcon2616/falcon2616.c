@@ -8,13 +8,29 @@
  */
 
 #include "falcon2616.h"
+#include "falcon2616_internal.h"
 #include "falcon2616_gpio_intf.h"
+#include "falcon2616_flash_intf.h"
+#include "boardinfo.h"
 #include "common.h"
+#include "log.h"
+#include "prof.h"
 #include "time.h"
 
+#include <errno.h>
 #include <string.h>
 
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_f2616"
+
 #define read_gpio()		f2616_intf_gpio_read()
+#define read_gpio2()		f2616_intf_gpio2_read()
+
+#define timing_flash()		mdp_intf_f2616_flash()
+#define timing_erase()		mdp_intf_f2616_erase()
+#define timing_program(x, y, z)	mdp_intf_f2616_program(x, y, z)
 
 #define F2616_SNS_OK		1
 #define F2616_SNS_INVAL		0x80000000
@@ -34,6 +50,12 @@
 #define PTRONIC_HIGH_BIT_TIME_MIN	450 /* microseconds */
 #define PTRONIC_HIGH_BIT_TIME_MAX	600 /* microseconds */
 
+/* Stored timing, magic is written last */
+struct f2616_timing_rec {
+	uint32_t magic;
+	struct f2616_timing t;
+};
+
 #define PTRONIC_READY_MASK 0xF /* Four bits for every sensor */
 
 typedef enum {
@@ -59,40 +81,93 @@ typedef enum {
 } f2616_distance_t;
 
 static void f2616_gpio_irq(void);
+static void f2616_gpio_learn_irq(void);
+static void f2616_gpio2_irq(void);
 void (*__F2616_GPIO_IRQ_CB)(void) = f2616_gpio_irq;
+void (*__F2616_GPIO2_IRQ_CB)(void) = f2616_gpio2_irq;
+
+/* Decoder state of one data line */
+struct f2616_line {
+	struct mdp_time tm, low_tm;
+	bool read_frame, after_idle;
+	int read_data;
+	uint32_t frame;
+	volatile uint32_t ready;
+	volatile uint32_t distance_cm[F2616_SNS_CNT];
+	volatile uint8_t seq[F2616_SNS_CNT];
+};
+
+static const struct f2616_timing timing_default = {
+	.start_min = PTRONIC_START_BIT_TIME_MIN,
+	.start_max = PTRONIC_START_BIT_TIME_MAX,
+	.one_min = PTRONIC_HIGH_BIT_TIME_MIN,
+	.one_max = PTRONIC_HIGH_BIT_TIME_MAX,
+	.frame_bits = PTRONIC_FRAME_SIZE,
+};
+
+static struct f2616_timing timing = timing_default;
+
+/* Windows of the interrupt as start and width, one compare for each */
+struct f2616_windows {
+	uint32_t start_min;
+	uint32_t start_span;
+	uint32_t one_min;
+	uint32_t one_span;
+	uint32_t frame_end;	/* read_data after the last bit */
+};
+
+#define IN_WINDOW(x, min, span)	((uint32_t)((x) - (min)) <= (span))
+
+static struct f2616_windows windows = {
+	.start_min = PTRONIC_START_BIT_TIME_MIN,
+	.start_span = PTRONIC_START_BIT_TIME_MAX - PTRONIC_START_BIT_TIME_MIN,
+	.one_min = PTRONIC_HIGH_BIT_TIME_MIN,
+	.one_span = PTRONIC_HIGH_BIT_TIME_MAX - PTRONIC_HIGH_BIT_TIME_MIN,
+	.frame_end = PTRONIC_FRAME_SIZE + 1,
+};
+
+static struct f2616_line lines[F2616_LINE_CNT] = {
+	/* Front unit is optional, it has no data until the first frame */
+	[F2616_LINE_FRONT] = {
+		.distance_cm = {
+			F2616_SNS_INVAL, F2616_SNS_INVAL,
+			F2616_SNS_INVAL, F2616_SNS_INVAL,
+		},
+	},
+};
 
-static struct mdp_time tm;
-static bool read_frame;
-static int read_data;
-static uint16_t frame;
-static volatile uint32_t ptronic_ready;
-static volatile uint32_t distance_cm[F2616_SNS_CNT];
 static struct f2616_distance f2616_distance;
 
-static void f2616_convert_distance(uint16_t data)
+static void f2616_convert_distance(struct f2616_line *l, uint32_t data)
 {
 	uint8_t idx = F2616_GET_SNS(data), distance = data;
 
 	if (F2616_GET_SNS_STAT(data) != F2616_SNS_OK) {
-		distance_cm[idx] |= F2616_SNS_INVAL;
+		l->distance_cm[idx] |= F2616_SNS_INVAL;
 		return;
 	}
 
 	if (distance == F2616_DIST_0p0m)
-		distance_cm[idx] = 0;
+		l->distance_cm[idx] = 0;
 	else if (IN_RANGE(distance, F2616_DIST_0p9m, F2616_DIST_0p3m))
-		distance_cm[idx] = (F2616_DIST_0p0m - distance) * 10;
+		l->distance_cm[idx] = (F2616_DIST_0p0m - distance) * 10;
 	else if (IN_RANGE(distance, F2616_DIST_1p9m, F2616_DIST_1p0m))
-		distance_cm[idx] = (F2616_DIST_1p0m - distance) * 10 + 100;
+		l->distance_cm[idx] = (F2616_DIST_1p0m - distance) * 10 + 100;
 	else if (IN_RANGE(distance, F2616_DIST_2p5m, F2616_DIST_2p0m))
-		distance_cm[idx] = (F2616_DIST_2p0m - distance) * 10 + 200;
+		l->distance_cm[idx] = (F2616_DIST_2p0m - distance) * 10 + 200;
 	else
 		return;
 
-	ptronic_ready |= 1 << idx;
+	l->ready |= 1 << idx;
+	l->seq[idx]++;
 }
 
-static void f2616_gpio_irq(void)
+/**
+ * Inlined into the interrupt of every line, so the line state has
+ * a constant address, the same as with global variables.
+ */
+static inline __attribute__((always_inline))
+void f2616_line_irq(struct f2616_line *l, bool level, bool learn)
 {
 	uint32_t bit_time;
 
@@ -100,64 +175,206 @@ static void f2616_gpio_irq(void)
          * If we read high level on GPIO, then we have rising edge,
          * rising edge means start of data transfer.
          */
-	if (read_gpio()) {
+	if (level) {
 		/* Begin to measure time and detect start bit */
-		mdp_tm_measure_start(&tm);
-		read_frame = true;
+		mdp_tm_measure_start(&l->tm);
+		l->read_frame = true;
+
+		if (learn) {
+			mdp_tm_measure_stop(&l->low_tm);
+			l->after_idle = mdp_tm_measure_get_us(&l->low_tm) >
+					F2616_LEARN_IDLE_US;
+		}
 	/**
          * If we read low level on GPIO,  then we have falling edge,
          * falling edge means end of data transfer.
          */
-	} else if (read_frame) {
+	} else if (l->read_frame) {
 		/* Finish measuring time */
-		mdp_tm_measure_stop(&tm);
-		bit_time = mdp_tm_measure_get_us(&tm);
-		read_frame = false;
+		mdp_tm_measure_stop(&l->tm);
+		bit_time = mdp_tm_measure_get_us(&l->tm);
+		l->read_frame = false;
+
+		if (learn) {
+			mdp_tm_measure_start(&l->low_tm);
+			f2616_learn_pulse(bit_time, l->after_idle);
+		}
 
 		/* If we read the start bit */
-		if (!read_data) {
+		if (!l->read_data) {
 			/* Detect start bit */
-			read_data =
-				IN_RANGE(bit_time, PTRONIC_START_BIT_TIME_MIN,
-					 PTRONIC_START_BIT_TIME_MAX);
+			l->read_data = IN_WINDOW(bit_time, windows.start_min,
+						 windows.start_span);
 		/* If we read the frame data */
 		} else {
-			uint8_t bit =
-				IN_RANGE(bit_time, PTRONIC_HIGH_BIT_TIME_MIN,
-					 PTRONIC_HIGH_BIT_TIME_MAX);
-			frame |= bit << (read_data - 1);
-			read_data++;
+			uint32_t bit = IN_WINDOW(bit_time, windows.one_min,
+						 windows.one_span);
+			l->frame |= bit << (l->read_data - 1);
+			l->read_data++;
 
 			/* If we read all bits from the frame */
-			if (read_data == PTRONIC_FRAME_SIZE + 1) {
-				f2616_convert_distance(frame);
-				frame = 0;
-				read_data = false;
+			if (l->read_data == windows.frame_end) {
+				f2616_convert_distance(l, l->frame);
+				l->frame = 0;
+				l->read_data = false;
 			}
 		}
 	}
 }
 
+static void f2616_gpio_irq(void)
+{
+	MDP_PROF_SCOPE(MDP_PROF_F2616_IRQ);
+
+	f2616_line_irq(&lines[F2616_LINE_REAR], read_gpio(), false);
+}
+
+/* Timing is learned from the rear unit */
+static void f2616_gpio_learn_irq(void)
+{
+	MDP_PROF_SCOPE(MDP_PROF_F2616_IRQ);
+
+	f2616_line_irq(&lines[F2616_LINE_REAR], read_gpio(), true);
+}
+
+void f2616_learn_irq(bool on)
+{
+	__F2616_GPIO_IRQ_CB = on ? f2616_gpio_learn_irq : f2616_gpio_irq;
+}
+
+static void f2616_gpio2_irq(void)
+{
+	MDP_PROF_SCOPE(MDP_PROF_F2616_IRQ);
+
+	f2616_line_irq(&lines[F2616_LINE_FRONT], read_gpio2(), false);
+}
+
 bool f2616_ready(void)
 {
-	return (ptronic_ready & PTRONIC_READY_MASK);
+	return (lines[F2616_LINE_REAR].ready & PTRONIC_READY_MASK) ||
+	       (lines[F2616_LINE_FRONT].ready & PTRONIC_READY_MASK);
+}
+
+/* Data is valid if any sensor of the unit works */
+static bool f2616_read_line(const struct f2616_line *l, uint32_t *cm,
+			    uint8_t *seq)
+{
+	bool valid = false;
+
+	for (int i = 0; i < F2616_SNS_CNT; i++) {
+		seq[i] = l->seq[i];
+		cm[i] = l->distance_cm[i];
+		if (!(cm[i] & F2616_SNS_INVAL))
+			valid = true;
+	}
+
+	return valid;
 }
 
 struct f2616_distance *f2616_read_distance(void)
 {
-	if (distance_cm[F2616_SNS_A] & F2616_SNS_INVAL &&
-	    distance_cm[F2616_SNS_B] & F2616_SNS_INVAL &&
-	    distance_cm[F2616_SNS_C] & F2616_SNS_INVAL &&
-	    distance_cm[F2616_SNS_D] & F2616_SNS_INVAL) {
-		f2616_distance.valid_data = false;
-		return &f2616_distance;
+	struct f2616_distance *d = &f2616_distance;
+
+	d->valid_data = f2616_read_line(&lines[F2616_LINE_REAR], d->cm,
+					d->seq);
+	d->front_valid = f2616_read_line(&lines[F2616_LINE_FRONT],
+					 d->front_cm, d->front_seq);
+
+	return d;
+}
+
+static bool f2616_timing_valid(const struct f2616_timing *t)
+{
+	return t->one_min <= t->one_max && t->one_max < t->start_min &&
+	       t->start_min <= t->start_max &&
+	       IN_RANGE(t->frame_bits, F2616_FRAME_BITS_MIN,
+			F2616_FRAME_BITS_MAX);
+}
+
+void f2616_init(void)
+{
+	const struct f2616_timing_rec *rec = (const void *)timing_flash();
+
+#if (MDP_PTRONIC_FRONT == 1)
+	f2616_intf_gpio2_init();
+#endif
+
+	if (!rec || rec->magic != F2616_TIMING_MAGIC)
+		return;
+
+	if (f2616_set_timing(&rec->t)) {
+		log_err("Stored timing is invalid, using documented one\r\n");
+		return;
+	}
+
+	f2616_print_timing();
+}
+
+void f2616_print_timing(void)
+{
+	log_sys("%s timing: start %u..%u us, '1' %u..%u us, %u bits\r\n",
+		timing.learned ? "Learned" : "Documented", timing.start_min,
+		timing.start_max, timing.one_min, timing.one_max,
+		timing.frame_bits);
+}
+
+const struct f2616_timing *f2616_get_timing(void)
+{
+	return &timing;
+}
+
+int f2616_set_timing(const struct f2616_timing *t)
+{
+	uint32_t primask;
+
+	if (!t)
+		t = &timing_default;
+
+	if (!f2616_timing_valid(t))
+		return -EINVAL;
+
+	/* Frame in progress was started with the old windows */
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	timing = *t;
+	windows.start_min = t->start_min;
+	windows.start_span = t->start_max - t->start_min;
+	windows.one_min = t->one_min;
+	windows.one_span = t->one_max - t->one_min;
+	windows.frame_end = t->frame_bits + 1;
+	for (int i = 0; i < F2616_LINE_CNT; i++) {
+		lines[i].read_data = 0;
+		lines[i].frame = 0;
 	}
 
-	f2616_distance.valid_data = true;
-	f2616_distance.cm[F2616_SNS_A] = distance_cm[F2616_SNS_A];
-	f2616_distance.cm[F2616_SNS_B] = distance_cm[F2616_SNS_B];
-	f2616_distance.cm[F2616_SNS_C] = distance_cm[F2616_SNS_C];
-	f2616_distance.cm[F2616_SNS_D] = distance_cm[F2616_SNS_D];
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int f2616_save_timing(void)
+{
+	struct f2616_timing_rec rec = {
+		.magic = F2616_TIMING_MAGIC,
+		.t = timing,
+	};
+
+	if (!timing_erase())
+		return -EIO;
+
+	if (!timing_program(sizeof(rec.magic), (uint8_t *)&rec.t,
+			    sizeof(rec.t)) ||
+	    !timing_program(0, (uint8_t *)&rec.magic, sizeof(rec.magic)))
+		return -EIO;
+
+	return 0;
+}
+
+int f2616_clear_timing(void)
+{
+	if (!timing_erase())
+		return -EIO;
 
-	return &f2616_distance;
+	return f2616_set_timing(NULL);
 }
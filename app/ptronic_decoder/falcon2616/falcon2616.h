@@ -42,6 +42,14 @@
  *              239..230 - 1.0m..1.9m;
  *              223..218 - 2.0m..2.5m.
  *
+ * Units built on the same base may use other pulse widths and frame
+ * length. The timing can be learned from the line (see f2616_learn_start)
+ * and is kept in flash, the documented timing is used otherwise.
+ *
+ * A second unit for the front bumper can be connected to its own data
+ * line (MDP_PTRONIC_FRONT), both lines are decoded independently with
+ * the same timing, which is learned from the rear unit.
+ *
  * @date       April 29, 2021
  * @author     Eduard Chaika <rampopula@gmail.com>
  * @copyright  Copyright (c) 2021 Eduard Chaika
@@ -60,13 +68,109 @@
 #define F2616_SNS_C	2
 #define F2616_SNS_D	1
 
+/* Two units may be connected, each one has its own data line */
+#define F2616_LINE_REAR		0
+#define F2616_LINE_FRONT	1
+#define F2616_LINE_CNT		2
+
+#define F2616_FRAME_BITS_MIN	12	/* Status, sensor and distance */
+#define F2616_FRAME_BITS_MAX	32
+
+#define F2616_LEARN_MS		3000	/* Default learning time */
+#define F2616_LEARN_MAX_PULSES	512	/* ~30 frames */
+
+#define F2616_TIMING_MAGIC	0x54504D44	/* "MDPT" */
+
 struct f2616_distance {
 	bool valid_data;
-	uint32_t cm[F2616_SNS_CNT];
+	uint32_t cm[F2616_SNS_CNT];		/* Rear unit */
+	bool front_valid;
+	uint32_t front_cm[F2616_SNS_CNT];
+	uint8_t seq[F2616_SNS_CNT];		/* Readings count, wraps */
+	uint8_t front_seq[F2616_SNS_CNT];
 };
 
+/* Pulse high time windows, microseconds, shorter pulses are '0' */
+struct f2616_timing {
+	uint16_t start_min;
+	uint16_t start_max;
+	uint16_t one_min;
+	uint16_t one_max;
+	uint16_t frame_bits;	/* Data bits after the start bit */
+	uint16_t learned;	/* 1 - learned from the line */
+};
+
+/**
+ * @brief Initialize decoder, the stored timing is used if valid.
+ */
+void f2616_init(void);
+
 bool f2616_ready(void);
 
 struct f2616_distance *f2616_read_distance(void);
 
+/**
+ * @brief Get timing used by the decoder.
+ *
+ * @return Current timing.
+ */
+const struct f2616_timing *f2616_get_timing(void);
+
+/**
+ * @brief Set timing used by the decoder.
+ *
+ * @param [in] t New timing, NULL - the documented one.
+ *
+ * @return 0 on success, -EINVAL if windows overlap or frame is too
+ *         short to carry distance.
+ */
+int f2616_set_timing(const struct f2616_timing *t);
+
+/**
+ * @brief Print timing used by the decoder.
+ */
+void f2616_print_timing(void);
+
+/**
+ * @brief Save current timing to flash.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int f2616_save_timing(void);
+
+/**
+ * @brief Erase stored timing, the documented one is used after reset.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int f2616_clear_timing(void);
+
+/**
+ * @brief Start collecting pulse widths from the rear unit line. The decoder
+ *        keeps running with the current timing meanwhile.
+ *
+ * @param [in] ms Learning time, the line must carry frames all along.
+ */
+void f2616_learn_start(uint32_t ms);
+
+/**
+ * @brief Finish learning once the time is over. Pulse widths are
+ *        clustered into start, '1' and '0' classes, the frame length
+ *        is the most common number of pulses between start pulses.
+ *
+ * @param [out] t Learned timing, set if 0 is returned.
+ *
+ * @return -EINPROGRESS while collecting, 0 when learned, -ENODATA if
+ *         not enough pulses were seen, -EINVAL if the widths can't be
+ *         split into three classes or frames differ in length.
+ */
+int f2616_learn_poll(struct f2616_timing *t);
+
+/**
+ * @brief Check if learning is in progress.
+ *
+ * @return true if pulse widths are being collected.
+ */
+bool f2616_learning(void);
+
 #endif /* __MDP_F2616_DECODER_H__ */
@@ -0,0 +1,59 @@
+/**
+ * @file       falcon2616_flash_intf.h
+ * @brief      Flash interface wrapper, the purpose is to use different
+ *             MCU's with the Falcon 2616 decoder timing storage.
+ *
+ *             Timing is kept in one flash page reserved in the linker
+ *             script (F2616 memory region).
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_F2616_FLASH_INTF_H__
+#define __MDP_F2616_FLASH_INTF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "flash_intf.h"
+
+#ifdef STM32F103xB
+extern uint8_t __f2616_start[];
+
+#define __MCU_F2616_FLASH_ADDR ((uint32_t)__f2616_start)
+#endif /* STM32F103xB */
+
+static inline const uint8_t *mdp_intf_f2616_flash(void)
+{
+#ifdef STM32F103xB
+	return (const uint8_t *)__MCU_F2616_FLASH_ADDR;
+#else
+	return NULL;
+#endif /* STM32F103xB */
+}
+
+static inline bool mdp_intf_f2616_erase(void)
+{
+#ifdef STM32F103xB
+	return mdp_intf_flash_erase(__MCU_F2616_FLASH_ADDR, FLASH_PAGE_SIZE);
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+/* Offset and size must be even, flash is programmed by half-words */
+static inline bool mdp_intf_f2616_program(uint32_t offset, const uint8_t *data,
+					  uint32_t size)
+{
+#ifdef STM32F103xB
+	return mdp_intf_flash_program(__MCU_F2616_FLASH_ADDR + offset, data,
+				      size);
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_F2616_FLASH_INTF_H__ */
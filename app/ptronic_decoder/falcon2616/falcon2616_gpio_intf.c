@@ -11,16 +11,46 @@
 
 inline uint8_t f2616_intf_gpio_read(void)
 {
-	uint8_t data;
-#ifdef STM32F103xB
+	uint8_t data = 0;
+#if defined(STM32F103xB) || defined(MDP_HOST)
 	data = HAL_GPIO_ReadPin(__MCU_PTRONIC_DATA_GPIO_PORT,
 				__MCU_PTRONIC_DATA_GPIO_PIN);
-#endif /* STM32F103xB */
+#endif /* STM32F103xB || MDP_HOST */
+	return data;
+}
+
+inline uint8_t f2616_intf_gpio2_read(void)
+{
+	uint8_t data = 0;
+#if defined(STM32F103xB) || defined(MDP_HOST)
+	data = HAL_GPIO_ReadPin(__MCU_PTRONIC_DATA2_GPIO_PORT,
+				__MCU_PTRONIC_DATA2_GPIO_PIN);
+#endif /* STM32F103xB || MDP_HOST */
 	return data;
 }
 
+void f2616_intf_gpio2_init(void)
+{
+#ifdef STM32F103xB
+	/* Same as the rear line: both edges, pulled down if disconnected */
+	GPIO_InitTypeDef init = {
+		.Pin = __MCU_PTRONIC_DATA2_GPIO_PIN,
+		.Mode = GPIO_MODE_IT_RISING_FALLING,
+		.Pull = GPIO_PULLDOWN,
+	};
+
+	HAL_GPIO_Init(__MCU_PTRONIC_DATA2_GPIO_PORT, &init);
+#endif /* STM32F103xB */
+}
+
 inline void __GPIO_DATA_READ_IRQ(void)
 {
 	if (__F2616_GPIO_IRQ_CB)
 		__F2616_GPIO_IRQ_CB();
 }
+
+inline void __GPIO_DATA2_READ_IRQ(void)
+{
+	if (__F2616_GPIO2_IRQ_CB)
+		__F2616_GPIO2_IRQ_CB();
+}
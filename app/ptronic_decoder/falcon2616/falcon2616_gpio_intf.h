@@ -14,12 +14,15 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#ifdef STM32F103xB
+/* Host shim provides the same GPIO, levels are driven by the host */
+#if defined(STM32F103xB) || defined(MDP_HOST)
 #include "stm32f1xx_hal.h"
 
 #define __MCU_PTRONIC_DATA_GPIO_PORT	GPIOB
 #define __MCU_PTRONIC_DATA_GPIO_PIN	GPIO_PIN_12
-#endif /* STM32F103xB */
+#define __MCU_PTRONIC_DATA2_GPIO_PORT	GPIOB
+#define __MCU_PTRONIC_DATA2_GPIO_PIN	GPIO_PIN_13
+#endif /* STM32F103xB || MDP_HOST */
 
 /**
  * @brief Used-end GPIO IRQ callback function.
@@ -29,8 +32,24 @@
  */
 extern void (*__F2616_GPIO_IRQ_CB)(void);
 
+/**
+ * @brief Used-end GPIO IRQ callback function of the front unit line.
+ *
+ *         NOTE: This function is called from
+ *               __GPIO_DATA2_READ_IRQ function.
+ */
+extern void (*__F2616_GPIO2_IRQ_CB)(void);
+
 uint8_t f2616_intf_gpio_read(void);
 
+uint8_t f2616_intf_gpio2_read(void);
+
+/**
+ * @brief Configure the front unit line, the rear one is configured
+ *        by CubeMX. Both lines share EXTI15_10 interrupt.
+ */
+void f2616_intf_gpio2_init(void);
+
 /**
  * @brief GPIO IRQ callback function.
  *
@@ -40,4 +59,13 @@ uint8_t f2616_intf_gpio_read(void);
  */
 void __GPIO_DATA_READ_IRQ(void);
 
+/**
+ * @brief GPIO IRQ callback function of the front unit line.
+ *
+ *         NOTE: This function must be called
+ *               inside the HAL Library for the
+ *               __MCU_PTRONIC_DATA2_GPIO_PIN.
+ */
+void __GPIO_DATA2_READ_IRQ(void);
+
 #endif /* __MDP_F2616_GPIO_INTF_H__ */
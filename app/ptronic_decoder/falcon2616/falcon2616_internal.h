@@ -0,0 +1,36 @@
+/**
+ * @file       falcon2616_internal.h
+ * @brief      Falcon 2616 decoder internal definitions shared with the
+ *             timing learner.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_F2616_INTERNAL_H__
+#define __MDP_F2616_INTERNAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Low time before a pulse longer than this separates frames */
+#define F2616_LEARN_IDLE_US	5000
+
+/**
+ * @brief Switch the rear line interrupt to the one that passes pulse
+ *        widths to the learner, so decoding alone doesn't test for it.
+ *
+ * @param [in] on true while the learner collects pulse widths.
+ */
+void f2616_learn_irq(bool on);
+
+/**
+ * @brief Collect pulse width, called from the line interrupt.
+ *
+ * @param [in] us High time of the pulse.
+ * @param [in] after_idle true if the line was idle before the pulse.
+ */
+void f2616_learn_pulse(uint32_t us, bool after_idle);
+
+#endif /* __MDP_F2616_INTERNAL_H__ */
@@ -0,0 +1,215 @@
+/**
+ * @file       falcon2616_learn.c
+ * @brief      Falcon 2616 decoder timing learner.
+ *
+ *             Pulse widths are collected by the line interrupt and put
+ *             in a histogram with F2616_LEARN_BIN_US bins. Runs of
+ *             populated bins are the width classes, sparse bins are
+ *             glitches and noise. The shortest class is '0', the longest
+ *             is the start bit. Window edges are placed in the middle
+ *             of the gaps between the classes, the start window gets
+ *             the same margin above the class as below it.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "falcon2616.h"
+#include "falcon2616_internal.h"
+#include "common.h"
+#include "time.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define F2616_LEARN_BIN_US	10
+#define F2616_LEARN_BINS	256	/* Up to 2.56 ms */
+#define F2616_LEARN_BIN_MIN	2	/* Pulses in a populated bin */
+#define F2616_LEARN_GAP_BINS	1	/* Empty bins allowed in a class */
+#define F2616_LEARN_CLASS_PCT	2	/* Smaller classes are noise */
+#define F2616_LEARN_MIN_FRAMES	8
+
+#define F2616_LEARN_IDLE_FLAG	0x8000
+#define F2616_LEARN_WIDTH_MASK	0x7FFF
+
+enum {
+	F2616_CLASS_ZERO = 0,
+	F2616_CLASS_ONE,
+	F2616_CLASS_START,
+	F2616_CLASS_CNT,
+};
+
+struct f2616_class {
+	uint16_t min_us;
+	uint16_t max_us;
+	uint32_t cnt;
+};
+
+/* Widths in the line order, bit 15 - the line was idle before */
+static uint16_t pulses[F2616_LEARN_MAX_PULSES];
+static volatile uint32_t pulse_cnt;
+static uint32_t learn_start_ms, learn_ms;
+static bool learn_pending;
+
+static uint16_t hist[F2616_LEARN_BINS];
+
+void f2616_learn_pulse(uint32_t us, bool after_idle)
+{
+	if (pulse_cnt == F2616_LEARN_MAX_PULSES)
+		return;
+
+	pulses[pulse_cnt++] = MIN(us, F2616_LEARN_WIDTH_MASK) |
+			      (after_idle ? F2616_LEARN_IDLE_FLAG : 0);
+}
+
+static int f2616_learn_classes(struct f2616_class *cls)
+{
+	uint32_t gap = 0, cnt = 0, min_cnt;
+	struct f2616_class c = { 0 };
+	bool in_class = false;
+	uint32_t w;
+
+	memset(hist, 0, sizeof(hist));
+	for (uint32_t i = 0; i < pulse_cnt; i++) {
+		w = (pulses[i] & F2616_LEARN_WIDTH_MASK) / F2616_LEARN_BIN_US;
+		if (w < F2616_LEARN_BINS)
+			hist[w]++;
+	}
+
+	min_cnt = pulse_cnt * F2616_LEARN_CLASS_PCT / 100;
+
+	/* One more empty bin past the end closes the last class */
+	for (uint32_t b = 0; b <= F2616_LEARN_BINS; b++) {
+		if (b < F2616_LEARN_BINS && hist[b] >= F2616_LEARN_BIN_MIN) {
+			if (!in_class) {
+				c.min_us = b * F2616_LEARN_BIN_US;
+				c.cnt = 0;
+				in_class = true;
+			}
+			c.max_us = (b + 1) * F2616_LEARN_BIN_US - 1;
+			c.cnt += hist[b];
+			gap = 0;
+			continue;
+		}
+
+		if (!in_class || ++gap <= F2616_LEARN_GAP_BINS)
+			continue;
+
+		in_class = false;
+		if (c.cnt < min_cnt)
+			continue;
+
+		if (cnt == F2616_CLASS_CNT)
+			return -EINVAL;
+		cls[cnt++] = c;
+	}
+
+	return cnt == F2616_CLASS_CNT ? 0 : -EINVAL;
+}
+
+/* Most common number of data pulses between start pulses */
+static int f2616_learn_frame_bits(const struct f2616_timing *t)
+{
+	uint8_t lens[F2616_FRAME_BITS_MAX + 1];
+	uint32_t frames = 0, best = 0, bits = 0;
+	bool in_frame = false;
+	uint32_t w;
+
+	memset(lens, 0, sizeof(lens));
+
+	for (uint32_t i = 0; i < pulse_cnt; i++) {
+		w = pulses[i] & F2616_LEARN_WIDTH_MASK;
+
+		/* Frame ends at the next start bit or idle line */
+		if (in_frame && (IN_RANGE(w, t->start_min, t->start_max) ||
+				 pulses[i] & F2616_LEARN_IDLE_FLAG)) {
+			if (bits <= F2616_FRAME_BITS_MAX)
+				lens[bits]++;
+			frames++;
+			in_frame = false;
+		}
+
+		if (IN_RANGE(w, t->start_min, t->start_max)) {
+			in_frame = true;
+			bits = 0;
+		} else if (in_frame) {
+			bits++;
+		}
+	}
+
+	for (uint32_t i = 1; i <= F2616_FRAME_BITS_MAX; i++) {
+		if (lens[i] > lens[best])
+			best = i;
+	}
+
+	/* Truncated frames are tolerated, as long as most are complete */
+	if (frames < F2616_LEARN_MIN_FRAMES || lens[best] * 2 < frames)
+		return -EINVAL;
+
+	return best;
+}
+
+void f2616_learn_start(uint32_t ms)
+{
+	f2616_learn_irq(false);
+	pulse_cnt = 0;
+
+	learn_start_ms = mdp_tm_ms();
+	learn_ms = ms;
+	learn_pending = true;
+
+	f2616_learn_irq(true);
+}
+
+int f2616_learn_poll(struct f2616_timing *t)
+{
+	struct f2616_class cls[F2616_CLASS_CNT];
+	struct f2616_class *zero, *one, *start;
+	uint32_t mid;
+	int ret;
+
+	if (!learn_pending)
+		return -ENODATA;
+
+	if (mdp_tm_ms() - learn_start_ms < learn_ms)
+		return -EINPROGRESS;
+
+	f2616_learn_irq(false);
+	learn_pending = false;
+
+	if (pulse_cnt < F2616_LEARN_MIN_FRAMES * F2616_FRAME_BITS_MIN)
+		return -ENODATA;
+
+	ret = f2616_learn_classes(cls);
+	if (ret)
+		return ret;
+
+	zero = &cls[F2616_CLASS_ZERO];
+	one = &cls[F2616_CLASS_ONE];
+	start = &cls[F2616_CLASS_START];
+
+	memset(t, 0, sizeof(*t));
+
+	mid = (zero->max_us + one->min_us) / 2;
+	t->one_min = mid + 1;
+
+	mid = (one->max_us + start->min_us) / 2;
+	t->one_max = mid;
+	t->start_min = mid + 1;
+	t->start_max = start->max_us + (start->min_us - t->start_min);
+
+	ret = f2616_learn_frame_bits(t);
+	if (ret < 0)
+		return ret;
+
+	t->frame_bits = ret;
+	t->learned = 1;
+
+	return 0;
+}
+
+bool f2616_learning(void)
+{
+	return learn_pending;
+}
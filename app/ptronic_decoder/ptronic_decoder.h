@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
 
 #include "boardinfo.h"
 
@@ -33,11 +34,23 @@
 #error "Parktronic is not specified!"
 #endif
 
+/* Layout matches the decoder data, distance in centimeters */
 struct ptronic_data {
 	bool valid;
-	uint32_t distance[MDP_SENSOR_CNT]; /* Distance in centimeters */
+	uint32_t distance[MDP_SENSOR_CNT]; /* Rear unit */
+	bool front_valid;
+	uint32_t front[MDP_SENSOR_CNT];
+	uint8_t seq[MDP_SENSOR_CNT];	/* New reading if changed */
+	uint8_t front_seq[MDP_SENSOR_CNT];
 };
 
+static inline void ptronic_init(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	f2616_init();
+#endif
+}
+
 static inline bool ptronic_ready(void)
 {
 #ifdef MDP_PTRONIC_F2616
@@ -55,4 +68,55 @@ static inline struct ptronic_data *ptronic_read_data(void)
 #endif
 }
 
+static inline void ptronic_learn_start(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	f2616_learn_start(F2616_LEARN_MS);
+#endif
+}
+
+static inline bool ptronic_learning(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	return f2616_learning();
+#endif
+	return false;
+}
+
+/**
+ * Learned timing is applied and saved, see f2616_learn_poll() for
+ * the return codes.
+ */
+static inline int ptronic_learn_poll(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	struct f2616_timing t;
+	int ret;
+
+	ret = f2616_learn_poll(&t);
+	if (!ret)
+		ret = f2616_set_timing(&t);
+	if (!ret)
+		ret = f2616_save_timing();
+
+	return ret;
+#endif
+	return -ENOTSUP;
+}
+
+static inline int ptronic_learn_clear(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	return f2616_clear_timing();
+#endif
+	return -ENOTSUP;
+}
+
+static inline void ptronic_print_timing(void)
+{
+#ifdef MDP_PTRONIC_F2616
+	f2616_print_timing();
+#endif
+}
+
 #endif /* __MDP_DECODER_H__ */
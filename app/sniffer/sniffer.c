@@ -0,0 +1,176 @@
+/**
+ * @file       sniffer.c
+ * @brief      Listen-only CAN bus sniffer implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "sniffer.h"
+#include "sniffer_intf.h"
+
+#include "log.h"
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_sniffer"
+
+#define MDP_SNIFFER_REC_HDR	9	/* Sync, seq, info, id, timestamp */
+
+#define sniffer_init(x)		mdp_intf_sniffer_init(x)
+#define sniffer_busy()		mdp_intf_sniffer_busy()
+#define sniffer_send(x, y)	mdp_intf_sniffer_send(x, y)
+
+static bool active;
+static struct mdp_can *buses[MDP_SNIFFER_BUS_NUM];
+
+/* One buffer is filled while the other one is sent by DMA */
+static uint8_t buf[2][MDP_SNIFFER_BUF_SIZE];
+static uint32_t buf_len;
+static int buf_idx;
+
+static uint8_t seq;
+static uint32_t lost[MDP_SNIFFER_BUS_NUM];	/* Controller count seen */
+
+uint8_t mdp_sniffer_crc8(const uint8_t *data, uint32_t size)
+{
+	uint8_t crc = 0;
+
+	while (size--) {
+		crc ^= *data++;
+		for (int i = 0; i < 8; i++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+
+	return crc;
+}
+
+static void sniffer_flush(void)
+{
+	if (!buf_len || sniffer_busy())
+		return;
+
+	sniffer_send(buf[buf_idx], buf_len);
+	buf_idx ^= 1;
+	buf_len = 0;
+}
+
+static void sniffer_put(int bus, const struct mdp_can_msg *msg, uint32_t us)
+{
+	uint8_t *rec;
+	uint32_t size = MDP_SNIFFER_REC_HDR + msg->size + 1;
+
+	/* Sequence number counts dropped frames too */
+	seq++;
+
+	if (buf_len + size > MDP_SNIFFER_BUF_SIZE) {
+		sniffer_flush();
+		if (buf_len + size > MDP_SNIFFER_BUF_SIZE)
+			return;
+	}
+
+	rec = &buf[buf_idx][buf_len];
+	rec[0] = MDP_SNIFFER_SYNC;
+	rec[1] = seq;
+	rec[2] = (bus << MDP_SNIFFER_INFO_BUS) |
+		 (msg->size & MDP_SNIFFER_INFO_DLC);
+	rec[3] = msg->id & 0xFF;
+	rec[4] = (msg->id >> 8) & 0xFF;
+	rec[5] = us & 0xFF;
+	rec[6] = (us >> 8) & 0xFF;
+	rec[7] = (us >> 16) & 0xFF;
+	rec[8] = (us >> 24) & 0xFF;
+	memcpy(&rec[MDP_SNIFFER_REC_HDR], msg->data, msg->size);
+	rec[size - 1] = mdp_sniffer_crc8(&rec[1], size - 2);
+
+	buf_len += size;
+}
+
+/* Frames lost before they could be read only move the sequence number */
+static void sniffer_skip_lost(int bus)
+{
+	uint32_t cnt = mdp_can_rx_lost(buses[bus]);
+
+	seq += cnt - lost[bus];
+	lost[bus] = cnt;
+}
+
+int mdp_sniffer_start(struct mdp_can *bus0, struct mdp_can *bus1)
+{
+	int ret;
+
+	buses[0] = bus0;
+	buses[1] = bus1;
+
+	for (int i = 0; i < MDP_SNIFFER_BUS_NUM; i++) {
+		mdp_can_stop(buses[i]);
+
+		ret = mdp_can_set_listen(buses[i], true);
+		if (!ret)
+			ret = mdp_can_start(buses[i]);
+		if (ret) {
+			log_err("%s: listen-only start failed: %d\r\n",
+				buses[i]->name, ret);
+			return ret;
+		}
+
+		lost[i] = mdp_can_rx_lost(buses[i]);
+	}
+
+	log_sys("Streaming %s (bus 0), %s (bus 1) at %d baud\r\n",
+		bus0->name, bus1->name, MDP_SNIFFER_UART_SPEED);
+
+	if (!sniffer_init(MDP_SNIFFER_UART_SPEED))
+		return -EIO;
+
+	/* Logs would corrupt the stream from now on */
+	active = true;
+	return 0;
+}
+
+void mdp_sniffer_poll(void)
+{
+	bool pending;
+	int ret;
+
+	if (!active)
+		return;
+
+	/* Take one frame from every bus in turn, so none is starved */
+	do {
+		pending = false;
+
+		for (int i = 0; i < MDP_SNIFFER_BUS_NUM; i++) {
+			ret = mdp_can_read(buses[i]);
+			if (!ret)
+				continue;
+
+			/* Frame being read may be gone, the host sees a gap */
+			if (ret < 0) {
+				seq++;
+				continue;
+			}
+
+			sniffer_put(i, &buses[i]->msg,
+				    mdp_can_rx_us(buses[i]));
+			pending = true;
+		}
+	} while (pending);
+
+	/* Overrun frames were newer than the ones just read */
+	for (int i = 0; i < MDP_SNIFFER_BUS_NUM; i++)
+		sniffer_skip_lost(i);
+
+	sniffer_flush();
+}
+
+bool mdp_sniffer_active(void)
+{
+	return active;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file       sniffer.h
+ * @brief      Listen-only CAN bus sniffer.
+ *
+ *             Both CAN controllers are switched to listen-only mode and
+ *             every received frame is streamed out of the debug UART in
+ *             a compact binary format. tools/mdp_sniff2candump.py
+ *             converts the stream to candump log format.
+ *
+ *             Record format, multi-byte fields are little-endian:
+ *
+ *             | 0xA5 | seq | info | id[2] | us[4] | data[dlc] | crc8 |
+ *
+ *             seq  - incremented for every received frame, including
+ *                    frames dropped because UART was too slow, frames
+ *                    lost on controller RX overrun and failed reads, so
+ *                    the host sees a gap if anything was lost. An
+ *                    overrun is flagged, not counted by the controllers,
+ *                    so it makes a gap of at least one frame.
+ *             info - bit 7: bus index, bits 3..0: DLC.
+ *             us   - reception time, microseconds (DWT). bxCAN frames
+ *                    are stamped in the RX interrupt. MCP2515 frames
+ *                    are polled and stamped when read, so they are late
+ *                    by up to one main loop pass plus the reads of the
+ *                    frames ahead of them, with no stall ~20 us.
+ *             crc8 - polynomial 0x07, over all bytes after 0xA5.
+ *
+ *             A fully loaded 125 kbit/s bus carries at most ~2500
+ *             frames/s (DLC 0), which is ~23 KB/s of records per bus.
+ *             MDP_SNIFFER_UART_SPEED gives ~100 KB/s.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_SNIFFER_H__
+#define __MDP_SNIFFER_H__
+
+#include <stdbool.h>
+
+#include "can_bus.h"
+
+#define MDP_SNIFFER_UART_SPEED	1000000	/* Exact with 36 MHz PCLK1 */
+#define MDP_SNIFFER_BUF_SIZE	512	/* Size of each of two UART buffers */
+#define MDP_SNIFFER_BUS_NUM	2
+
+#define MDP_SNIFFER_SYNC	0xA5
+#define MDP_SNIFFER_INFO_BUS	7	/* Bus index bit in info byte */
+#define MDP_SNIFFER_INFO_DLC	0x0F	/* DLC mask in info byte */
+
+/**
+ * @brief Enter sniffer mode. Interfaces are restarted in listen-only
+ *        mode, the debug UART is switched to MDP_SNIFFER_UART_SPEED
+ *        and the console and logs are not available until reset.
+ *
+ * @param [in] bus0 Interface reported as bus 0.
+ * @param [in] bus1 Interface reported as bus 1.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_sniffer_start(struct mdp_can *bus0, struct mdp_can *bus1);
+
+/**
+ * @brief Read frames from both buses and send them to UART.
+ *        This function must be called constantly in the main loop.
+ */
+void mdp_sniffer_poll(void);
+
+/**
+ * @brief Check if the sniffer mode is active.
+ *
+ * @return true if the debug UART is used by the sniffer.
+ */
+bool mdp_sniffer_active(void);
+
+/**
+ * @brief CRC-8 (polynomial 0x07) of the record bytes. Shared by all
+ *        records sent to the sniffer UART.
+ *
+ * @param [in] data Record bytes.
+ * @param [in] size Number of bytes.
+ *
+ * @return CRC value.
+ */
+uint8_t mdp_sniffer_crc8(const uint8_t *data, uint32_t size);
+
+#endif /* __MDP_SNIFFER_H__ */
@@ -0,0 +1,90 @@
+/**
+ * @file       sniffer_intf.h
+ * @brief      Sniffer UART interface wrapper, the purpose is to use
+ *             different MCU's with the sniffer API.
+ *
+ *             Records are sent from USART3 by DMA1 channel 2 (USART3_TX
+ *             request). The channel is driven at register level and
+ *             polled, no DMA interrupt is used.
+ *
+ *             Host build (MDP_HOST) sends to the UART model instead.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_SNIFFER_INTF_H__
+#define __MDP_SNIFFER_INTF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef STM32F103xB
+#include "stm32f1xx_hal.h"
+
+extern UART_HandleTypeDef huart3;
+
+#define __MCU_SNIFFER_UART (&huart3)
+#define __MCU_SNIFFER_DMA (DMA1_Channel2)
+#elif defined(MDP_HOST)
+#include "uart_emu.h"
+#endif /* STM32F103xB */
+
+static inline bool mdp_intf_sniffer_init(uint32_t baud)
+{
+#ifdef STM32F103xB
+	DMA_Channel_TypeDef *dma = __MCU_SNIFFER_DMA;
+
+	/* Wait for the last log message to leave the shift register */
+	while (!__HAL_UART_GET_FLAG(__MCU_SNIFFER_UART, UART_FLAG_TC))
+		;
+
+	__MCU_SNIFFER_UART->Init.BaudRate = baud;
+	if (HAL_UART_Init(__MCU_SNIFFER_UART) != HAL_OK)
+		return false;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	dma->CCR = 0;
+	dma->CPAR = (uint32_t)&__MCU_SNIFFER_UART->Instance->DR;
+
+	SET_BIT(__MCU_SNIFFER_UART->Instance->CR3, USART_CR3_DMAT);
+	return true;
+#elif defined(MDP_HOST)
+	return uart_emu_init(baud);
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+static inline bool mdp_intf_sniffer_busy(void)
+{
+#ifdef STM32F103xB
+	/* Counter reaches zero when the last byte is taken by USART */
+	return __MCU_SNIFFER_DMA->CNDTR != 0;
+#elif defined(MDP_HOST)
+	return uart_emu_busy();
+#else
+	return false;
+#endif /* STM32F103xB */
+}
+
+static inline void mdp_intf_sniffer_send(const uint8_t *data, uint16_t size)
+{
+#ifdef STM32F103xB
+	DMA_Channel_TypeDef *dma = __MCU_SNIFFER_DMA;
+
+	/* Channel can be reprogrammed only while it is disabled */
+	dma->CCR = 0;
+	DMA1->IFCR = DMA_IFCR_CGIF2;
+
+	dma->CMAR = (uint32_t)data;
+	dma->CNDTR = size;
+	dma->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN;
+#elif defined(MDP_HOST)
+	uart_emu_send(data, size);
+#endif /* STM32F103xB */
+}
+
+#endif /* __MDP_SNIFFER_INTF_H__ */
@@ -0,0 +1,74 @@
+/**
+ * @file       track.c
+ * @brief      Fixed-point alpha-beta distance tracker implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "track.h"
+#include "common.h"
+
+/* Distance covered at speed v in ms, 1/256 cm */
+static int32_t track_move(int32_t v, uint32_t ms)
+{
+	return v * (int32_t)ms / 1000;
+}
+
+void mdp_track_update(struct mdp_track *t, const struct mdp_track_cfg *cfg,
+		      uint32_t cm, uint32_t now_ms)
+{
+	const int32_t v_max = cfg->speed_max * MDP_TRACK_ONE;
+	uint32_t dt = now_ms - t->t_ms;
+	int32_t z = cm * MDP_TRACK_ONE;
+	int32_t r;
+
+	t->t_ms = now_ms;
+
+	/* Nothing to take the speed from */
+	if (!t->valid || dt > cfg->gap_ms) {
+		t->valid = true;
+		t->x = z;
+		t->v = 0;
+		return;
+	}
+
+	dt = MAX(dt, 1U);
+
+	t->x += track_move(t->v, dt);
+	r = z - t->x;
+
+	t->x += r * cfg->alpha / MDP_TRACK_ONE;
+	t->v += r * cfg->beta / MDP_TRACK_ONE * 1000 / (int32_t)dt;
+
+	t->v = MIN(MAX(t->v, -v_max), v_max);
+	t->x = MAX(t->x, 0);
+}
+
+uint32_t mdp_track_predict(const struct mdp_track *t,
+			   const struct mdp_track_cfg *cfg, uint32_t at_ms)
+{
+	const int32_t v_min = cfg->speed_min * MDP_TRACK_ONE;
+	uint32_t lead = MIN(at_ms - t->t_ms, (uint32_t)cfg->lead_max_ms);
+	int32_t x = t->x;
+
+	if (t->v < -v_min)
+		x += track_move(t->v, lead);
+
+	x = MIN(MAX(x, 0), cfg->cm_max * MDP_TRACK_ONE);
+
+	return (x + MDP_TRACK_ONE / 2) / MDP_TRACK_ONE;
+}
+
+uint32_t mdp_track_ttc_ms(const struct mdp_track *t,
+			  const struct mdp_track_cfg *cfg)
+{
+	const int32_t v_min = cfg->speed_min * MDP_TRACK_ONE;
+
+	if (!t->valid || t->v >= -v_min)
+		return UINT32_MAX;
+
+	/* Both are in 1/256 units, the fraction cancels out */
+	return (uint32_t)t->x * 1000 / (uint32_t)-t->v;
+}
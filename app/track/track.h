@@ -0,0 +1,102 @@
+/**
+ * @file       track.h
+ * @brief      Fixed-point alpha-beta distance tracker.
+ *
+ *             One tracker follows one sensor. Every new reading corrects
+ *             the distance estimate by alpha of the residual and the
+ *             speed estimate by beta of the residual per second, then the
+ *             distance can be extrapolated to a moment in the future,
+ *             e.g. when the next display frame goes out. Only an
+ *             approaching obstacle is extrapolated, a receding or still
+ *             one is reported as estimated, so the prediction never makes
+ *             the car look farther away than it was seen.
+ *
+ *             Distance is kept in 1/256 cm, speed in 1/256 cm/s, all math
+ *             is 32-bit integer.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_TRACK_H__
+#define __MDP_TRACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MDP_TRACK_Q		8	/* Fraction bits */
+#define MDP_TRACK_ONE		(1 << MDP_TRACK_Q)
+
+/* Tuned on host/bench/bench_track.c, parking speeds up to 1 m/s */
+#define MDP_TRACK_CFG_DEFAULT						\
+	{								\
+		.alpha = 192, .beta = 32, .gap_ms = 500,		\
+		.lead_max_ms = 400, .speed_max = 200, .speed_min = 10,	\
+		.cm_max = 255,						\
+	}
+
+struct mdp_track_cfg {
+	uint16_t alpha;		/* Distance gain, 1/256 */
+	uint16_t beta;		/* Speed gain, 1/256 */
+	uint16_t gap_ms;	/* Longer gap between readings restarts */
+	uint16_t lead_max_ms;	/* Extrapolation limit */
+	uint16_t speed_max;	/* Speed limit, cm/s */
+	uint16_t speed_min;	/* Slower approach is not extrapolated */
+	uint16_t cm_max;	/* Farthest distance reported */
+};
+
+struct mdp_track {
+	bool valid;
+	int32_t x;		/* Distance, 1/256 cm */
+	int32_t v;		/* Speed, 1/256 cm/s, negative - approach */
+	uint32_t t_ms;		/* Time of the last reading */
+};
+
+/**
+ * @brief Forget the history, the next reading starts a new track.
+ *
+ * @param [out] t Tracker.
+ */
+static inline void mdp_track_reset(struct mdp_track *t)
+{
+	t->valid = false;
+}
+
+/**
+ * @brief Correct the estimate with a new reading.
+ *
+ * @param [in] t Tracker.
+ * @param [in] cfg Filter parameters.
+ * @param [in] cm Distance in centimeters.
+ * @param [in] now_ms Time of the reading in milliseconds.
+ */
+void mdp_track_update(struct mdp_track *t, const struct mdp_track_cfg *cfg,
+		      uint32_t cm, uint32_t now_ms);
+
+/**
+ * @brief Get distance expected at the given moment.
+ *
+ * @param [in] t Tracker, must have a reading.
+ * @param [in] cfg Filter parameters.
+ * @param [in] at_ms Moment in milliseconds, not before the last reading.
+ *
+ * @return Distance in centimeters.
+ */
+uint32_t mdp_track_predict(const struct mdp_track *t,
+			   const struct mdp_track_cfg *cfg, uint32_t at_ms);
+
+/**
+ * @brief Get time from the last reading until the obstacle is reached
+ *        at the current approach speed.
+ *
+ * @param [in] t Tracker.
+ * @param [in] cfg Filter parameters.
+ *
+ * @return Time in milliseconds, UINT32_MAX if there is no reading or
+ *         the obstacle is not approaching faster than speed_min.
+ */
+uint32_t mdp_track_ttc_ms(const struct mdp_track *t,
+			  const struct mdp_track_cfg *cfg);
+
+#endif /* __MDP_TRACK_H__ */
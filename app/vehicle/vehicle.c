@@ -0,0 +1,135 @@
+/**
+ * @file       vehicle.c
+ * @brief      Vehicle profiles implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "vehicle.h"
+
+#include "log.h"
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_vehicle"
+
+/**
+ * New variants are added here, the first one is the default.
+ * Mazda 3 (BK, since 03.2006) MS CAN, see mdp.h for references.
+ */
+static const struct mdp_vehicle profiles[] = {
+	{
+		.name = "mazda3_bk",
+		.ids = {
+			[MDP_VEH_MSG_DP_MISC] = 0x28F,
+			[MDP_VEH_MSG_DP_LHALF] = 0x290,
+			[MDP_VEH_MSG_DP_RHALF] = 0x291,
+			[MDP_VEH_MSG_STAT] = 0x433,
+		},
+		.lhalf_byte = 0xC0,
+		.rhalf_byte = 0x85,
+	},
+};
+
+const struct mdp_vehicle *mdp_vehicle = &profiles[0];
+uint8_t mdp_vehicle_map[MDP_VEHICLE_ID_NUM];
+
+static void vehicle_apply(const struct mdp_vehicle *veh)
+{
+	/* Roles of the previous profile are removed first */
+	for (int i = MDP_VEH_MSG_NONE + 1; i < MDP_VEH_MSG_COUNT; i++)
+		mdp_vehicle_map[mdp_vehicle->ids[i]] = MDP_VEH_MSG_NONE;
+
+	for (int i = MDP_VEH_MSG_NONE + 1; i < MDP_VEH_MSG_COUNT; i++)
+		mdp_vehicle_map[veh->ids[i]] = i;
+
+	mdp_vehicle = veh;
+	log_sys("Vehicle profile: %s\r\n", veh->name);
+}
+
+int mdp_vehicle_select(const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(profiles); i++) {
+		if (!strcmp(profiles[i].name, name)) {
+			vehicle_apply(&profiles[i]);
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+int mdp_vehicle_detect(struct mdp_can *can)
+{
+	static uint8_t seen[MDP_VEHICLE_ID_NUM / 8];
+	const struct mdp_vehicle *best = &profiles[0];
+	uint32_t start_ms, id;
+	int ret, hits, best_hits = 0;
+
+	if (ARRAY_SIZE(profiles) == 1) {
+		vehicle_apply(best);
+		return 0;
+	}
+
+	memset(seen, 0, sizeof(seen));
+
+	ret = mdp_can_set_listen(can, true);
+	if (!ret)
+		ret = mdp_can_start(can);
+
+	start_ms = mdp_tm_ms();
+	while (!ret && mdp_tm_ms() - start_ms < MDP_VEHICLE_DETECT_MS) {
+		ret = mdp_can_read(can);
+		if (ret <= 0)
+			continue;
+
+		id = can->msg.id;
+		if (id < MDP_VEHICLE_ID_NUM)
+			seen[id / 8] |= BIT(id % 8);
+		ret = 0;
+	}
+
+	mdp_can_stop(can);
+	mdp_can_set_listen(can, false);
+
+	if (ret) {
+		log_err("%s: sampling failed: %d\r\n", can->name, ret);
+		return ret;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(profiles); i++) {
+		hits = 0;
+		for (int j = MDP_VEH_MSG_NONE + 1; j < MDP_VEH_MSG_COUNT; j++) {
+			id = profiles[i].ids[j];
+			if (seen[id / 8] & BIT(id % 8))
+				hits++;
+		}
+
+		log_dbg("%s: %d IDs seen\r\n", profiles[i].name, hits);
+		if (hits > best_hits) {
+			best_hits = hits;
+			best = &profiles[i];
+		}
+	}
+
+	if (!best_hits)
+		log_sys("No known IDs seen, using default profile\r\n");
+
+	vehicle_apply(best);
+	return 0;
+}
+
+void mdp_vehicle_print(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(profiles); i++) {
+		log_sys("%c %s\r\n", &profiles[i] == mdp_vehicle ? '*' : ' ',
+			profiles[i].name);
+	}
+}
@@ -0,0 +1,102 @@
+/**
+ * @file       vehicle.h
+ * @brief      Vehicle profiles: message IDs and service bytes of every
+ *             supported car variant.
+ *
+ *             Profiles are const tables in flash. The active profile is
+ *             expanded into an ID map, indexed by the 11-bit message ID,
+ *             so classifying a frame is a single table load, no matter
+ *             how many profiles there are.
+ *
+ *             Profile is either selected at runtime or detected at
+ *             startup: the vehicle segment is sampled in listen-only mode
+ *             and the profile with most of its IDs seen wins.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_VEHICLE_H__
+#define __MDP_VEHICLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "can_bus.h"
+
+#define MDP_VEHICLE_ID_NUM	2048	/* Standard 11-bit IDs */
+#define MDP_VEHICLE_DETECT_MS	1000	/* Traffic sampling time */
+
+/* Message roles, index in the profile ID table and value of the ID map */
+typedef enum {
+	MDP_VEH_MSG_NONE = 0,
+	MDP_VEH_MSG_DP_MISC,	/* Display misc symbols */
+	MDP_VEH_MSG_DP_LHALF,	/* Display left half */
+	MDP_VEH_MSG_DP_RHALF,	/* Display right half */
+	MDP_VEH_MSG_STAT,	/* Status: reverse gear, doors, etc */
+	MDP_VEH_MSG_COUNT,
+} mdp_veh_msg_t;
+
+struct mdp_vehicle {
+	const char *name;
+	uint16_t ids[MDP_VEH_MSG_COUNT];
+	uint8_t lhalf_byte;	/* 1st byte of display left half packet */
+	uint8_t rhalf_byte;	/* 1st byte of display right half packet */
+};
+
+extern const struct mdp_vehicle *mdp_vehicle;
+extern uint8_t mdp_vehicle_map[MDP_VEHICLE_ID_NUM];
+
+/**
+ * @brief Classify message by the active profile.
+ *
+ * @param [in] id Message ID.
+ *
+ * @return Message role, MDP_VEH_MSG_NONE if it has no role.
+ */
+static inline mdp_veh_msg_t mdp_vehicle_msg(uint32_t id)
+{
+	return id < MDP_VEHICLE_ID_NUM ? mdp_vehicle_map[id] : MDP_VEH_MSG_NONE;
+}
+
+/**
+ * @brief Get message ID of the role in the active profile.
+ *
+ * @param [in] msg Message role.
+ *
+ * @return Message ID.
+ */
+static inline uint32_t mdp_vehicle_id(mdp_veh_msg_t msg)
+{
+	return mdp_vehicle->ids[msg];
+}
+
+/**
+ * @brief Select profile by name.
+ *
+ * @param [in] name Profile name.
+ *
+ * @return 0 on success, -ENOENT if there is no such profile.
+ */
+int mdp_vehicle_select(const char *name);
+
+/**
+ * @brief Detect profile by the traffic on the vehicle segment. The
+ *        interface is started in listen-only mode for
+ *        MDP_VEHICLE_DETECT_MS and returned stopped. The first profile
+ *        is selected if nothing matches. With a single profile there is
+ *        nothing to choose, so it is applied without sampling.
+ *
+ * @param [in] can Interface facing the vehicle segment.
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int mdp_vehicle_detect(struct mdp_can *can);
+
+/**
+ * @brief Print all profiles, the active one is marked.
+ */
+void mdp_vehicle_print(void);
+
+#endif /* __MDP_VEHICLE_H__ */
@@ -0,0 +1,75 @@
+/**
+ * @file       zone.c
+ * @brief      Distance zone classifier implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "zone.h"
+#include "common.h"
+
+static uint32_t zone_of(const struct mdp_zone_cfg *cfg, uint32_t cm)
+{
+	uint32_t zone = (cm + cfg->step_cm - 1) / cfg->step_cm;
+
+	return MIN(zone, (uint32_t)cfg->cnt - 1);
+}
+
+/* Hysteresis of the far boundary of zone k */
+static uint32_t zone_hyst(const struct mdp_zone_cfg *cfg, uint32_t k)
+{
+	return cfg->band_hyst_cm ? cfg->band_hyst_cm[k] : cfg->hyst_cm;
+}
+
+void mdp_zone_init(struct mdp_zone *z, const struct mdp_zone_cfg *cfg)
+{
+	z->cfg = cfg;
+	z->zone = MDP_ZONE_INVALID;
+	z->pending = false;
+}
+
+bool mdp_zone_update(struct mdp_zone *z, uint32_t cm, bool valid,
+		     uint32_t now_ms)
+{
+	const struct mdp_zone_cfg *cfg = z->cfg;
+	uint32_t zone, edge;
+
+	if (!valid || z->zone == MDP_ZONE_INVALID) {
+		zone = valid ? zone_of(cfg, cm) : MDP_ZONE_INVALID;
+		z->pending = false;
+		goto change;
+	}
+
+	zone = zone_of(cfg, cm);
+
+	if (zone < z->zone) {
+		z->pending = false;
+		goto change;
+	}
+
+	/* Boundary is the far edge of the current zone */
+	edge = z->zone * cfg->step_cm;
+	if (zone == z->zone || cm <= edge + zone_hyst(cfg, z->zone)) {
+		z->pending = false;
+		return false;
+	}
+
+	if (!z->pending) {
+		z->pending = true;
+		z->pending_ms = now_ms;
+	}
+
+	if (now_ms - z->pending_ms < cfg->dwell_ms)
+		return false;
+
+	z->pending = false;
+
+change:
+	if (zone == z->zone)
+		return false;
+
+	z->zone = zone;
+	return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file       zone.h
+ * @brief      Distance zone classifier with hysteresis and dwell time.
+ *
+ *             Distance is split into zones of equal width: zone 0 is
+ *             exactly 0 cm, zone k covers (step * (k - 1), step * k] and
+ *             the last zone is open-ended. Readings jump by one decoder
+ *             step (10 cm) back and forth on a zone boundary, so a
+ *             farther zone is taken only if the distance is above the
+ *             boundary by its hysteresis and stays there for the dwell
+ *             time. A nearer zone and loss of data are reported right
+ *             away, an approaching obstacle is never delayed.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_ZONE_H__
+#define __MDP_ZONE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MDP_ZONE_INVALID	0xFF	/* No data */
+
+struct mdp_zone_cfg {
+	uint16_t step_cm;		/* Zone width */
+	uint8_t cnt;			/* Number of zones */
+	uint8_t hyst_cm;		/* Hysteresis of every boundary */
+	const uint8_t *band_hyst_cm;	/* Per boundary, NULL - hyst_cm */
+	uint16_t dwell_ms;		/* Farther zone must hold that long */
+};
+
+struct mdp_zone {
+	const struct mdp_zone_cfg *cfg;
+	uint8_t zone;
+	bool pending;			/* Farther zone is seen */
+	uint32_t pending_ms;
+};
+
+/**
+ * @brief Initialize classifier, the zone is invalid until the first
+ *        update with data.
+ *
+ * @param [out] z Classifier.
+ * @param [in] cfg Zones description, must stay valid.
+ */
+void mdp_zone_init(struct mdp_zone *z, const struct mdp_zone_cfg *cfg);
+
+/**
+ * @brief Classify the next reading.
+ *
+ * @param [in] z Classifier.
+ * @param [in] cm Distance in centimeters.
+ * @param [in] valid false if there is no data, cm is ignored.
+ * @param [in] now_ms Current time in milliseconds.
+ *
+ * @return true if the zone has changed.
+ */
+bool mdp_zone_update(struct mdp_zone *z, uint32_t cm, bool valid,
+		     uint32_t now_ms);
+
+/**
+ * @brief Get current zone.
+ *
+ * @param [in] z Classifier.
+ *
+ * @return Zone index or MDP_ZONE_INVALID.
+ */
+static inline uint8_t mdp_zone_get(const struct mdp_zone *z)
+{
+	return z->zone;
+}
+
+/**
+ * @brief Get distance the current zone stands for, its far boundary.
+ *
+ * @param [in] z Classifier, zone must be valid.
+ *
+ * @return Distance in centimeters.
+ */
+static inline uint32_t mdp_zone_cm(const struct mdp_zone *z)
+{
+	return z->zone * z->cfg->step_cm;
+}
+
+#endif /* __MDP_ZONE_H__ */
@@ -23,6 +23,7 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "boardinfo.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -56,6 +57,7 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern CAN_HandleTypeDef hcan;
 
 /* USER CODE BEGIN EV */
 
@@ -188,7 +190,8 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-
+  extern void mdp_tm_systick(void);
+  mdp_tm_systick();
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -209,13 +212,36 @@ void EXTI15_10_IRQHandler(void)
     extern void __GPIO_DATA_READ_IRQ(void);
     __GPIO_DATA_READ_IRQ();
   }
+#if (MDP_PTRONIC_FRONT == 1)
+  /* Front unit line, not checked on every rear edge if not fitted */
+  if(__HAL_GPIO_EXTI_GET_FLAG(GPIO_PIN_13)) {
+    extern void __GPIO_DATA2_READ_IRQ(void);
+    __GPIO_DATA2_READ_IRQ();
+  }
+#endif
   /* USER CODE END EXTI15_10_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_12);
   /* USER CODE BEGIN EXTI15_10_IRQn 1 */
-
+#if (MDP_PTRONIC_FRONT == 1)
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_13);
+#endif
   /* USER CODE END EXTI15_10_IRQn 1 */
 }
 
+/**
+  * @brief This function handles CAN RX1 interrupt.
+  */
+void CAN1_RX1_IRQHandler(void)
+{
+  /* USER CODE BEGIN CAN1_RX1_IRQn 0 */
+
+  /* USER CODE END CAN1_RX1_IRQn 0 */
+  HAL_CAN_IRQHandler(&hcan);
+  /* USER CODE BEGIN CAN1_RX1_IRQn 1 */
+
+  /* USER CODE END CAN1_RX1_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
 /* USER CODE END 1 */
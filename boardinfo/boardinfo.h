@@ -16,9 +16,35 @@
 #define MDP_APP_DEBUG		0
 #endif
 
+#ifndef MDP_PROFILER_ENABLED
+#define MDP_PROFILER_ENABLED	0
+#endif
+
+/* Detect reverse gear in the CAN RX1 interrupt, 0 - in the main loop */
+#ifndef MDP_RGEAR_IN_ISR
+#define MDP_RGEAR_IN_ISR	0
+#endif
+
 #define MDP_PTRONIC_F2616
+#define MDP_PTRONIC_FRONT	0	/* Second unit on the front data line */
+#define MDP_DIST_PREDICT	1	/* Show distance at the frame time */
+#define MDP_TTC_WARNING		1	/* Warn by time to contact, needs above */
 #define MDP_BEEPER_ENABLED	1
 #define MDP_USE_CAN_BYPASS	1
+#define MDP_POWER_GOVERNOR	1	/* Lower clock and sleep when idle */
+#define MDP_BBOX_ENABLED	1	/* Record CAN traffic, save it on errors */
+
+/* Bus segment served by the on-chip bxCAN, MCP2515 serves the other one */
+#define MDP_CAN_ROLE_PJB	0
+#define MDP_CAN_ROLE_DP		1
+#define MDP_CAN_ROLE_AUTO	2	/* Opt-in, bxCAN gets the busier one */
+#define MDP_CAN_HAL_ROLE	MDP_CAN_ROLE_PJB
+
+/* Vehicle profile name, "auto" - detect by the traffic at startup */
+#define MDP_VEHICLE_PROFILE	"mazda3_bk"
+
+/* Register-level SPI for short MCP2515 transactions, 0 - HAL only */
+#define MDP_MCP2515_SPI_FAST	1
 
 #define MDP_OVERRIDE_GREETING	1
 #define MDP_GREETING_MESSAGE	"  MDP v0.2b "
@@ -18,6 +18,7 @@
 
 #define IN_RANGE(a, x, y)	((a) >= (x) && (a) <= (y))
 #define ARRAY_SIZE(x)		(sizeof(x) / sizeof((x)[0]))
+#define ALIGN_UP(x, a)		(((x) + (a) - 1) & ~((a) - 1))
 
 
 #endif /* __MDP_COMMON_H__ */
@@ -0,0 +1,83 @@
+/**
+ * @file       prof.c
+ * @brief      Cycle-count profiler implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "prof.h"
+#include "log.h"
+
+#include <string.h>
+
+#ifdef MDP_MODULE
+#undef MDP_MODULE
+#endif
+#define MDP_MODULE "mdp_prof"
+
+#if (MDP_PROFILER_ENABLED == 1)
+struct mdp_prof_zone {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+};
+
+static struct mdp_prof_zone prof_table[__MDP_PROF_ZONE_COUNT];
+
+static const char *prof_names[__MDP_PROF_ZONE_COUNT] = {
+	[MDP_PROF_CAN_TRANSFER] = "mdp_can_transfer",
+	[MDP_PROF_MCP2515_TX] = "mcp2515_tx_message",
+	[MDP_PROF_MCP2515_RX] = "mcp2515_rx_message",
+	[MDP_PROF_F2616_IRQ] = "f2616_gpio_irq",
+	[MDP_PROF_DIST_TO_STR] = "distance_to_string",
+	[MDP_PROF_DIST_PREDICT] = "distance_predict",
+};
+
+void mdp_prof_record(mdp_prof_zone_t zone, uint32_t cycles)
+{
+	struct mdp_prof_zone *z = &prof_table[zone];
+
+	if (!z->count || cycles < z->min)
+		z->min = cycles;
+	if (cycles > z->max)
+		z->max = cycles;
+
+	z->total += cycles;
+	z->count++;
+}
+
+void mdp_prof_dump(void)
+{
+	struct mdp_prof_zone z;
+	uint32_t primask;
+
+	log_sys("Profiling table (cycles @ %lu MHz):\r\n", MDP_CLOCK_FREQ_MHZ);
+	log_sys("%-20s %10s %8s %8s %8s\r\n", "zone", "count", "min", "avg",
+		"max");
+
+	for (int i = 0; i < __MDP_PROF_ZONE_COUNT; i++) {
+		/* Zone can be updated from the interrupt, take a snapshot */
+		primask = __get_PRIMASK();
+		__disable_irq();
+		z = prof_table[i];
+		__set_PRIMASK(primask);
+
+		log_sys("%-20s %10lu %8lu %8lu %8lu\r\n", prof_names[i],
+			z.count, z.min,
+			z.count ? (uint32_t)(z.total / z.count) : 0, z.max);
+	}
+}
+
+void mdp_prof_reset(void)
+{
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	memset(prof_table, 0, sizeof(prof_table));
+	__set_PRIMASK(primask);
+}
+#endif /* MDP_PROFILER_ENABLED */
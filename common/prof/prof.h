@@ -0,0 +1,79 @@
+/**
+ * @file       prof.h
+ * @brief      Cycle-count profiler for the hot paths.
+ *
+ *             Every profiling zone collects call count, minimum, maximum
+ *             and total number of core cycles spent inside the zone.
+ *             A zone is opened with MDP_PROF_SCOPE() and closed
+ *             automatically when the enclosing scope is left.
+ *
+ *             If MDP_PROFILER_ENABLED is 0 the profiler compiles
+ *             out to nothing.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_PROF_H__
+#define __MDP_PROF_H__
+
+#include <stdint.h>
+
+#include "boardinfo.h"
+
+typedef enum {
+	MDP_PROF_CAN_TRANSFER = 0,
+	MDP_PROF_MCP2515_TX,
+	MDP_PROF_MCP2515_RX,
+	MDP_PROF_F2616_IRQ,
+	MDP_PROF_DIST_TO_STR,
+	MDP_PROF_DIST_PREDICT,
+	__MDP_PROF_ZONE_COUNT
+} mdp_prof_zone_t;
+
+#if (MDP_PROFILER_ENABLED == 1)
+#include "stm32f1xx_hal.h"
+
+struct mdp_prof_scope {
+	mdp_prof_zone_t zone;
+	uint32_t start;
+};
+
+/**
+ * @brief Account cycles spent in the profiling zone.
+ *
+ * @param [in] zone Profiling zone.
+ * @param [in] cycles Number of core cycles.
+ */
+void mdp_prof_record(mdp_prof_zone_t zone, uint32_t cycles);
+
+/**
+ * @brief Print profiling table.
+ */
+void mdp_prof_dump(void);
+
+/**
+ * @brief Reset profiling table.
+ */
+void mdp_prof_reset(void);
+
+static inline void __mdp_prof_scope_end(struct mdp_prof_scope *scope)
+{
+	mdp_prof_record(scope->zone, DWT->CYCCNT - scope->start);
+}
+
+#define MDP_PROF_SCOPE(__zone) \
+	struct mdp_prof_scope __prof_scope \
+	__attribute__((cleanup(__mdp_prof_scope_end))) = { \
+		.zone = __zone, \
+		.start = DWT->CYCCNT \
+	}
+#else
+#define MDP_PROF_SCOPE(zone)
+#define mdp_prof_record(zone, cycles)
+#define mdp_prof_dump()
+#define mdp_prof_reset()
+#endif /* MDP_PROFILER_ENABLED */
+
+#endif /* __MDP_PROF_H__ */
@@ -12,40 +12,174 @@
 
 #include <stdbool.h>
 
-#define ARM_CM_DEMCR		(*(uint32_t *)0xE000EDFC)
-#define ARM_CM_DWT_CTRL		(*(uint32_t *)0xE0001000)
-#define ARM_CM_DWT_CYCCNT	(*(volatile uint32_t *)0xE0001004)
+#define dwt_cycles()		(DWT->CYCCNT)
+
+struct mdp_tm_clock {
+	uint32_t hz;
+	uint32_t cyc_per_ms;
+	uint32_t us_mult;	/* 2^32 / cycles per usec, rounded up */
+};
 
 static bool _inited = false;
+static struct mdp_tm_clock tm_clk;
+
+/**
+ * State below is updated from the SysTick interrupt with interrupts
+ * disabled. Readers take a snapshot and retry if tm_seq has changed.
+ */
+static volatile uint32_t tm_seq;
+static volatile uint32_t tm_cyc_hi;	/* DWT counter overflows */
+static volatile uint32_t tm_cyc_last;	/* DWT counter at the last tick */
+static volatile uint32_t tm_epoch_cyc;	/* DWT counter at tm_epoch_ms */
+static volatile uint64_t tm_epoch_ms;
+
+static void time_clock_setup(struct mdp_tm_clock *clk, uint32_t hz)
+{
+	clk->hz = hz;
+	clk->cyc_per_ms = hz / __MDP_MSEC_IN_SEC;
+	clk->us_mult = (uint32_t)((((uint64_t)1 << 32) * 1000000 + hz - 1) /
+				  hz);
+}
 
-static inline void time_init(void)
+void mdp_tm_init(void)
 {
-	if (_inited && ARM_CM_DWT_CTRL)
+	if (_inited && (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
 		return;
 
-	ARM_CM_DEMCR |= 1 << 24;
-	ARM_CM_DWT_CYCCNT = 0;
-	ARM_CM_DWT_CTRL |= 1 << 0;
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	time_clock_setup(&tm_clk, MDP_CLOCK_FREQ_HZ);
+
+	/* Continue from the HAL tick, so the log time starts at boot */
+	tm_cyc_hi = 0;
+	tm_cyc_last = 0;
+	tm_epoch_cyc = 0;
+	tm_epoch_ms = HAL_GetTick();
 
 	_inited = true;
 }
 
-void mdp_tm_measure_start(struct mdp_time *tm)
+void mdp_tm_set_clock(uint32_t hz)
+{
+	struct mdp_tm_clock clk;
+	uint32_t primask, now, elapsed, rem;
+
+	if (!_inited || hz == tm_clk.hz)
+		return;
+
+	time_clock_setup(&clk, hz);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/**
+	 * Part of the current millisecond elapsed so far is carried
+	 * into the new clock domain, so no time is lost or gained.
+	 */
+	now = dwt_cycles();
+	elapsed = now - tm_epoch_cyc;
+	if (elapsed >= tm_clk.cyc_per_ms)
+		elapsed = tm_clk.cyc_per_ms - 1;
+	rem = (uint32_t)((uint64_t)elapsed * clk.cyc_per_ms /
+			 tm_clk.cyc_per_ms);
+	tm_epoch_cyc = now - rem;
+	tm_clk = clk;
+	tm_seq++;
+
+	__set_PRIMASK(primask);
+}
+
+void mdp_tm_systick(void)
 {
+	uint32_t primask, now;
+
 	if (!_inited)
-		time_init();
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	now = dwt_cycles();
+	if (now < tm_cyc_last)
+		tm_cyc_hi++;
+	tm_cyc_last = now;
+
+	/**
+	 * Milliseconds are counted by SysTick, DWT only interpolates
+	 * inside the current millisecond. The core clock (and DWT) is
+	 * stopped during WFI, SysTick keeps counting.
+	 */
+	tm_epoch_cyc = now;
+	tm_epoch_ms++;
 
-	tm->start = ARM_CM_DWT_CYCCNT;
+	tm_seq++;
+
+	__set_PRIMASK(primask);
+}
+
+uint64_t mdp_tm_cycles(void)
+{
+	uint32_t seq, hi, last, now;
+
+	do {
+		seq = tm_seq;
+		hi = tm_cyc_hi;
+		last = tm_cyc_last;
+		now = dwt_cycles();
+	} while (seq != tm_seq);
+
+	/* Counter has wrapped after the last tick */
+	if (now < last)
+		hi++;
+
+	return ((uint64_t)hi << 32) | now;
+}
+
+uint64_t mdp_tm_us(void)
+{
+	uint32_t seq, epoch_cyc, us_mult, now, sub_us;
+	uint64_t epoch_ms;
+
+	do {
+		seq = tm_seq;
+		epoch_ms = tm_epoch_ms;
+		epoch_cyc = tm_epoch_cyc;
+		us_mult = tm_clk.us_mult;
+		now = dwt_cycles();
+	} while (seq != tm_seq);
+
+	sub_us = ((uint64_t)(now - epoch_cyc) * us_mult) >> 32;
+	if (sub_us >= __MDP_USEC_IN_MSEC)
+		sub_us = __MDP_USEC_IN_MSEC - 1;
+
+	return epoch_ms * __MDP_USEC_IN_MSEC + sub_us;
+}
+
+uint32_t mdp_tm_ms(void)
+{
+	return (uint32_t)tm_epoch_ms;
+}
+
+uint32_t mdp_tm_cycles_to_us(uint32_t cycles)
+{
+	return ((uint64_t)cycles * tm_clk.us_mult) >> 32;
+}
+
+void mdp_tm_measure_start(struct mdp_time *tm)
+{
+	tm->start = dwt_cycles();
 }
 
 void mdp_tm_measure_stop(struct mdp_time *tm)
 {
-	tm->cycles = ARM_CM_DWT_CYCCNT - tm->start;
+	tm->cycles = dwt_cycles() - tm->start;
 }
 
 uint32_t mdp_tm_measure_get_us(struct mdp_time *tm)
 {
-	return tm->cycles / MDP_CLOCK_FREQ_MHZ;
+	return mdp_tm_cycles_to_us(tm->cycles);
 }
 
 void mdp_tm_msleep(uint32_t msecs)
@@ -55,7 +189,9 @@ void mdp_tm_msleep(uint32_t msecs)
 
 bool mdp_tm_elapsed(struct mdp_timestamp *ts, uint32_t interval_ms)
 {
-	if (MDP_TIMESTAMP.ticks - ts->ticks >= interval_ms) {
+	uint32_t now = mdp_tm_ms();
+
+	if (now - ts->ticks >= interval_ms) {
 		*ts = MDP_TIMESTAMP;
 		return true;
 	}
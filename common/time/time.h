@@ -2,6 +2,12 @@
  * @file       time.h
  * @brief      Simple helper functions for working with time.
  *
+ *             Milliseconds are counted by the SysTick interrupt, the DWT
+ *             cycle counter interpolates microseconds inside the current
+ *             millisecond and is extended to 64 bits by the same
+ *             interrupt. Conversions use reciprocals precomputed for the
+ *             current core clock, so no division is done at runtime.
+ *
  * @date       August 17, 2021
  * @author     Eduard Chaika <rampopula@gmail.com>
  * @copyright  Copyright (c) 2021 Eduard Chaika
@@ -15,19 +21,19 @@
 
 #include "stm32f1xx_hal.h"
 
-#define __MDP_SEC_SHIFT 	10	/* Will consider 1 sec is 1024 msec */
 #define __MDP_MSEC_IN_SEC	1000
+#define __MDP_USEC_IN_MSEC	1000
+
+/* Exact n / 1000 for any 32-bit n: n * ceil(2^38 / 1000) >> 38 */
+#define __MDP_DIV1000(n) \
+	((uint32_t)(((uint64_t)(n) * 0x10624DD3ULL) >> 38))
 
 #define MDP_TIMESTAMP \
 	({ \
 		struct mdp_timestamp __ts; \
-		__ts.ticks = HAL_GetTick(); \
-		__ts.sec = __ts.ticks >> __MDP_SEC_SHIFT; \
-		__ts.msec = __ts.ticks - (__ts.sec << __MDP_SEC_SHIFT); \
-		if (__ts.msec >= __MDP_MSEC_IN_SEC) { \
-			__ts.msec -= __MDP_MSEC_IN_SEC; \
-			__ts.sec++; \
-		} \
+		__ts.ticks = mdp_tm_ms(); \
+		__ts.sec = __MDP_DIV1000(__ts.ticks); \
+		__ts.msec = __ts.ticks - __ts.sec * __MDP_MSEC_IN_SEC; \
 		__ts; \
 	})
 
@@ -42,6 +48,60 @@ struct mdp_timestamp {
 	uint32_t ticks;
 };
 
+/**
+ * @brief Initialize time base.
+ *        Must be called once after the system clock is configured.
+ */
+void mdp_tm_init(void);
+
+/**
+ * @brief Notify time base about the core clock change.
+ *        Time elapsed so far is preserved, conversion
+ *        factors are recomputed for the new clock.
+ *
+ * @param [in] hz New core clock frequency in Hz.
+ */
+void mdp_tm_set_clock(uint32_t hz);
+
+/**
+ * @brief SysTick hook, extends the cycle counter and advances
+ *        the millisecond epoch. Must be called every millisecond
+ *        from the SysTick interrupt.
+ */
+void mdp_tm_systick(void);
+
+/**
+ * @brief Get 64-bit monotonic cycle counter.
+ *        Note, the cycle rate follows the core clock and
+ *        the counter is stopped while the core sleeps.
+ *
+ * @return Number of core cycles since mdp_tm_init().
+ */
+uint64_t mdp_tm_cycles(void);
+
+/**
+ * @brief Get 64-bit monotonic time in microseconds.
+ *
+ * @return Time in microseconds.
+ */
+uint64_t mdp_tm_us(void);
+
+/**
+ * @brief Get monotonic time in milliseconds.
+ *
+ * @return Time in milliseconds (wraps after ~49 days).
+ */
+uint32_t mdp_tm_ms(void);
+
+/**
+ * @brief Convert core cycles to microseconds using current core clock.
+ *
+ * @param [in] cycles Number of core cycles.
+ *
+ * @return Time in microseconds.
+ */
+uint32_t mdp_tm_cycles_to_us(uint32_t cycles);
+
 /**
  * @brief Start measuring time.
  *        Call this function before the piece of code
@@ -62,9 +122,6 @@ void mdp_tm_measure_stop(struct mdp_time *tm);
 
 /**
  * @brief Get execution time in microseconds.
- *        For this function to work, the MDP_CLOCK_FREQ_MHZ must be defined.
- *        If the MDP_CLOCK_FREQ_MHZ is not defined, the default value
- *        of 16 MHz will be taken.
  *
  * @param [in] tm Valid time context.
  *
@@ -0,0 +1,41 @@
+/**
+ * @file       bench.h
+ * @brief      Host benchmarks.
+ *
+ *             A benchmark runs a number of operations and checks their
+ *             results, so it doubles as a regression test. Host time
+ *             per operation is measured by the runner, and so is the
+ *             virtual MCU time, for code that advances it (bus accesses,
+ *             delays).
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_HOST_BENCH_H__
+#define __MDP_HOST_BENCH_H__
+
+#include <stdint.h>
+
+struct host_bench {
+	const char *name;
+	const char *op;		/* What is counted as one operation */
+	uint32_t ops;		/* Number of operations to run */
+	/* Returns 0 if all results are correct, negative error otherwise */
+	int (*run)(uint32_t ops);
+	/* Optional, prints details below the result line */
+	void (*report)(void);
+};
+
+extern const struct host_bench host_bench_signal;
+extern const struct host_bench host_bench_display;
+extern const struct host_bench host_bench_gateway;
+extern const struct host_bench host_bench_mcp2515;
+extern const struct host_bench host_bench_busload;
+extern const struct host_bench host_bench_f2616;
+extern const struct host_bench host_bench_track;
+extern const struct host_bench host_bench_rgear;
+extern const struct host_bench host_bench_sniffer;
+
+#endif /* __MDP_HOST_BENCH_H__ */
@@ -0,0 +1,190 @@
+/**
+ * @file       bench_busload.c
+ * @brief      Bus load benchmark: the vehicle segment carries synthetic
+ *             125 kbit/s traffic at a given load, the application main
+ *             loop forwards it to the display segment and frames lost
+ *             on bxCAN FIFO overrun are counted apart from the ones
+ *             dropped by the gateway (the display segment runs at the
+ *             same rate, so a fully loaded bus leaves it no slack).
+ *
+ *             Traffic comes in bursts of back to back frames with idle
+ *             time between them to get the load. Every scenario is run
+ *             with the plain main loop and with extra time spent in it,
+ *             standing in for blocking work. With no extra time no frame
+ *             may be lost in the FIFO up to the full load.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "bxcan_emu.h"
+#include "common.h"
+#include "mdp.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_BL_ID_BASE	0x100	/* Not rewritten by any profile */
+#define BENCH_BL_BURST		8	/* Back to back frames */
+#define BENCH_BL_QUIET_NS	20000000ULL	/* No output: all forwarded */
+#define BENCH_BL_TIMEOUT_NS	60000000000ULL
+
+struct bench_bl_scenario {
+	uint32_t load;		/* Percent of the bus bandwidth */
+	uint32_t stall_us;	/* Extra time spent per main loop */
+};
+
+struct bench_bl_result {
+	uint32_t frames;
+	uint32_t lost;		/* Not forwarded for any reason */
+	uint32_t fifo_ovr;	/* Lost on FIFO overrun */
+	uint32_t max_level;
+};
+
+static const struct bench_bl_scenario scenarios[] = {
+	{ .load = 50, .stall_us = 0 },
+	{ .load = 100, .stall_us = 0 },
+	{ .load = 50, .stall_us = 2000 },
+	{ .load = 100, .stall_us = 2000 },
+	{ .load = 50, .stall_us = 5000 },
+	{ .load = 100, .stall_us = 5000 },
+};
+
+static struct bench_bl_result results[ARRAY_SIZE(scenarios)];
+
+static void bench_bl_frame(struct mdp_can_msg *msg, uint32_t seq)
+{
+	msg->id = BENCH_BL_ID_BASE + seq % 64;
+	msg->size = MAZDA_MAX_MSG_SIZE;
+	memset(msg->data, 0xA5, sizeof(msg->data));
+	memcpy(msg->data, &seq, sizeof(seq));
+}
+
+/* Forwarded frames must be the sent ones, in order, some may be missing */
+static int bench_bl_collect(uint32_t *next, uint32_t frames,
+			    struct bench_bl_result *res)
+{
+	struct mdp_can_msg out, ref;
+	uint32_t seq;
+	int got = 0;
+
+	while (host_can_collect(HOST_CAN_SPI, &out)) {
+		memcpy(&seq, out.data, sizeof(seq));
+		if (seq < *next || seq >= frames)
+			return -EINVAL;
+
+		bench_bl_frame(&ref, seq);
+		if (out.id != ref.id || out.size != ref.size ||
+		    memcmp(out.data, ref.data, out.size))
+			return -EINVAL;
+
+		res->lost += seq - *next;
+		*next = seq + 1;
+		got++;
+	}
+
+	return got;
+}
+
+static int bench_bl_run_one(const struct bench_bl_scenario *sc,
+			    uint32_t frames, struct bench_bl_result *res)
+{
+	uint64_t frame_ns = BXCAN_EMU_FRAME_NS(MAZDA_MAX_MSG_SIZE);
+	uint64_t gap_ns = BENCH_BL_BURST * frame_ns * (100 - sc->load) /
+			  sc->load;
+	uint64_t at, start, last_ns;
+	struct mdp_can_msg msg;
+	uint32_t seq, next = 0;
+	int got;
+
+	memset(res, 0, sizeof(*res));
+	res->frames = frames;
+	bxcan_emu_clear_stats();
+
+	start = host_time_ns();
+	at = start;
+	for (seq = 0; seq < frames; seq++) {
+		if (seq && !(seq % BENCH_BL_BURST))
+			at += gap_ns;
+		at += frame_ns;
+
+		bench_bl_frame(&msg, seq);
+		if (!bxcan_emu_schedule(&msg, at))
+			return -ENOBUFS;
+	}
+
+	last_ns = at;
+	while (bxcan_emu_scheduled() ||
+	       host_time_ns() - last_ns < BENCH_BL_QUIET_NS) {
+		if (host_time_ns() - start > BENCH_BL_TIMEOUT_NS)
+			return -ETIMEDOUT;
+
+		mdp_run();
+		if (sc->stall_us)
+			host_advance_us(sc->stall_us);
+
+		got = bench_bl_collect(&next, frames, res);
+		if (got < 0)
+			return got;
+		if (got)
+			last_ns = MAX(last_ns, host_time_ns());
+	}
+
+	/* Frames missing at the end are lost too */
+	res->lost += frames - next;
+	res->fifo_ovr = bxcan_emu_stats()->rx_ovr[CAN_RX_FIFO0];
+	res->max_level = bxcan_emu_stats()->rx_max_level[CAN_RX_FIFO0];
+
+	if (res->fifo_ovr > res->lost)
+		return -EPROTO;
+
+	if (!sc->stall_us && res->fifo_ovr)
+		return -EOVERFLOW;
+
+	return 0;
+}
+
+static int bench_busload_run(uint32_t ops)
+{
+	uint32_t frames = ops / ARRAY_SIZE(scenarios);
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		ret = bench_bl_run_one(&scenarios[i], frames, &results[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static void bench_busload_report(void)
+{
+	const struct bench_bl_result *res;
+
+	printf("  %-6s %-9s %8s %10s %10s %10s %10s\n", "load", "stall",
+	       "frames", "fifo lost", "gw lost", "lost %", "max level");
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->frames)
+			break;
+
+		printf("  %3u %%  %5u us  %8u %10u %10u %10.2f %10u\n",
+		       scenarios[i].load, scenarios[i].stall_us, res->frames,
+		       res->fifo_ovr, res->lost - res->fifo_ovr,
+		       100.0 * res->lost / res->frames, res->max_level);
+	}
+}
+
+const struct host_bench host_bench_busload = {
+	.name = "busload",
+	.op = "frame",
+	.ops = 12000,
+	.run = bench_busload_run,
+	.report = bench_busload_report,
+};
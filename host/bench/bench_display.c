@@ -0,0 +1,51 @@
+/**
+ * @file       bench_display.c
+ * @brief      Display compositor benchmark: the main loop pattern of one
+ *             update and two frame fetches, with the text changing every
+ *             eighth update.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "display.h"
+#include "mdp.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+static int bench_display_run(uint32_t ops)
+{
+	char text[MAZDA_DP_CHAR_NUM * 2];
+	const uint8_t *lhalf, *rhalf;
+	int ret = 0;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		sprintf(text, "    %lu.%lum    ", (unsigned long)(i >> 3) % 10,
+			(unsigned long)(i >> 6) % 10);
+		mdp_display_show(MDP_DP_LAYER_PARKING, text,
+				 MDP_DP_TTL_FOREVER);
+
+		lhalf = mdp_display_frame(MAZDA_DP_LHALF);
+		rhalf = mdp_display_frame(MAZDA_DP_RHALF);
+
+		/* Digits are at 4 and 6, the right half starts at 5 */
+		if (lhalf[5] != text[4] || rhalf[2] != text[6]) {
+			ret = -EINVAL;
+			break;
+		}
+	}
+
+	mdp_display_hide(MDP_DP_LAYER_PARKING);
+	return ret;
+}
+
+const struct host_bench host_bench_display = {
+	.name = "display",
+	.op = "update",
+	.ops = 1000000,
+	.run = bench_display_run,
+};
@@ -0,0 +1,332 @@
+/**
+ * @file       bench_f2616.c
+ * @brief      Falcon 2616 decoder benchmark: synthesized pulse trains are
+ *             fed edge by edge through the decoder interrupt on the
+ *             virtual clock, and every frame is checked against the
+ *             distance of its sensor.
+ *
+ *             Frame outcome: decoded, wrong (other value or invalid) or
+ *             missed (previous value kept). Accuracy is counted over the
+ *             frames that were not truncated. Interrupt time per edge is
+ *             host time of the interrupt calls, less the same calls with
+ *             no callback installed. The decoder must be exact on clean
+ *             and jittered lines, on two units sending at once on the
+ *             rear and front lines, and on a unit with other timing once
+ *             the timing is learned from the line.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "f2616_synth.h"
+#include "falcon2616.h"
+#include "falcon2616_gpio_intf.h"
+#include "common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_F2616_MAX_FRAMES	2000	/* Per scenario */
+
+struct bench_f2616_scenario {
+	const char *name;
+	struct f2616_synth_cfg cfg;
+	bool exact;		/* Every frame must be decoded */
+	bool learn;		/* Learn timing before decoding */
+	bool dual;		/* Front unit sends at the same time */
+};
+
+struct bench_f2616_result {
+	uint32_t frames;
+	uint32_t ok;
+	uint32_t wrong;
+	uint32_t missed;
+	uint32_t cut;
+	uint32_t edges;
+	uint64_t isr_ns;
+	uint64_t virt_ns;
+	struct f2616_timing timing;
+};
+
+static const struct bench_f2616_scenario scenarios[] = {
+	{ .name = "clean", .exact = true, .cfg = { .seed = 1 } },
+	{ .name = "jitter", .exact = true,
+	  .cfg = { .jitter_us = 40, .seed = 2 } },
+	{ .name = "glitch", .cfg = { .glitch_pct = 10, .seed = 3 } },
+	{ .name = "truncated", .cfg = { .trunc_pct = 10, .seed = 4 } },
+	{ .name = "noise", .cfg = { .noise_pct = 20, .seed = 5 } },
+	{ .name = "all", .cfg = { .jitter_us = 40, .glitch_pct = 5,
+				  .trunc_pct = 5, .noise_pct = 10,
+				  .seed = 6 } },
+	{ .name = "dual", .exact = true, .dual = true,
+	  .cfg = { .jitter_us = 40, .seed = 8 } },
+	{ .name = "scaled", .cfg = { .jitter_us = 20, .scale_pct = 130,
+				     .seed = 7 } },
+	{ .name = "learned", .exact = true, .learn = true,
+	  .cfg = { .jitter_us = 20, .scale_pct = 130, .seed = 7 } },
+};
+
+static struct bench_f2616_result results[ARRAY_SIZE(scenarios)];
+static struct f2616_synth_frame frames[BENCH_F2616_MAX_FRAMES];
+
+static uint64_t bench_f2616_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Edge of the line with the earliest one goes first */
+static uint64_t bench_f2616_edge(const struct f2616_synth_frame *f[],
+				 uint32_t idx[], uint32_t at[])
+{
+	static const uint16_t pins[F2616_LINE_CNT] = {
+		[F2616_LINE_REAR] = GPIO_PIN_12,
+		[F2616_LINE_FRONT] = GPIO_PIN_13,
+	};
+	const struct f2616_synth_edge *e;
+	uint32_t now = MIN(at[F2616_LINE_REAR], at[F2616_LINE_FRONT]);
+	uint64_t t;
+	int line;
+
+	line = at[F2616_LINE_REAR] == now ? F2616_LINE_REAR :
+					    F2616_LINE_FRONT;
+	e = &f[line]->edges[idx[line]];
+
+	host_gpio_set_input(GPIOB, pins[line], e->level ? GPIO_PIN_SET :
+							   GPIO_PIN_RESET);
+
+	t = bench_f2616_ns();
+	if (line == F2616_LINE_REAR)
+		__GPIO_DATA_READ_IRQ();
+	else
+		__GPIO_DATA2_READ_IRQ();
+	t = bench_f2616_ns() - t;
+
+	if (++idx[line] < f[line]->edge_cnt)
+		at[line] += f[line]->edges[idx[line]].dt_us;
+	else
+		at[line] = UINT32_MAX;
+
+	return t;
+}
+
+/**
+ * Frames of both lines start together, front may be NULL.
+ * Returns host time spent in the interrupts.
+ */
+static uint64_t bench_f2616_feed(const struct f2616_synth_frame *rear,
+				 const struct f2616_synth_frame *front)
+{
+	const struct f2616_synth_frame *f[F2616_LINE_CNT] = { rear, front };
+	uint32_t idx[F2616_LINE_CNT] = { 0 }, at[F2616_LINE_CNT];
+	uint32_t now = 0;
+	uint64_t ns = 0;
+
+	for (int i = 0; i < F2616_LINE_CNT; i++)
+		at[i] = f[i] && f[i]->edge_cnt ? f[i]->edges[0].dt_us :
+						 UINT32_MAX;
+
+	while (MIN(at[F2616_LINE_REAR], at[F2616_LINE_FRONT]) != UINT32_MAX) {
+		host_advance_us(MIN(at[F2616_LINE_REAR],
+				    at[F2616_LINE_FRONT]) - now);
+		now = MIN(at[F2616_LINE_REAR], at[F2616_LINE_FRONT]);
+		ns += bench_f2616_edge(f, idx, at);
+	}
+
+	return ns;
+}
+
+static void bench_f2616_check(const struct f2616_synth_frame *f, int line,
+			      uint32_t prev, struct bench_f2616_result *res)
+{
+	struct f2616_distance *d = f2616_read_distance();
+	uint32_t cm = UINT32_MAX;
+
+	if (line == F2616_LINE_REAR && d->valid_data)
+		cm = d->cm[f->sensor];
+	else if (line == F2616_LINE_FRONT && d->front_valid)
+		cm = d->front_cm[f->sensor];
+
+	if (f->truncated)
+		res->cut++;
+	else if (cm == f->cm)
+		res->ok++;
+	else if (cm == prev)
+		res->missed++;
+	else
+		res->wrong++;
+}
+
+/* Line carries frames until the learner is done */
+static int bench_f2616_learn(struct f2616_synth *synth)
+{
+	struct f2616_synth_frame *f = &frames[0];
+	struct f2616_timing t;
+	uint32_t i = 0;
+	int ret;
+
+	f2616_learn_start(F2616_LEARN_MS);
+	do {
+		f2616_synth_next(synth, i++ % F2616_SNS_CNT,
+				 f2616_synth_random_cm(synth), f);
+		bench_f2616_feed(f, NULL);
+		ret = f2616_learn_poll(&t);
+	} while (ret == -EINPROGRESS);
+
+	return ret ? ret : f2616_set_timing(&t);
+}
+
+static uint32_t bench_f2616_cm(const struct f2616_distance *d, int line,
+			       uint8_t sensor)
+{
+	return line == F2616_LINE_REAR ? d->cm[sensor] : d->front_cm[sensor];
+}
+
+static int bench_f2616_run_one(const struct bench_f2616_scenario *sc,
+			       uint32_t cnt, struct bench_f2616_result *res)
+{
+	void (*isr)(void) = __F2616_GPIO_IRQ_CB;
+	void (*isr2)(void) = __F2616_GPIO2_IRQ_CB;
+	uint32_t prev[F2616_LINE_CNT][F2616_SNS_CNT], cm;
+	uint32_t lines = sc->dual ? F2616_LINE_CNT : 1;
+	struct f2616_synth synth[F2616_LINE_CNT];
+	struct f2616_synth_cfg cfg = sc->cfg;
+	const struct f2616_synth_frame *f;
+	uint64_t base_ns, ns;
+	uint8_t sensor;
+	int ret, line;
+
+	/* Frames of all lines are kept one after another */
+	cnt -= cnt % lines;
+
+	memset(res, 0, sizeof(*res));
+	res->frames = cnt;
+	for (int i = 0; i < F2616_LINE_CNT; i++) {
+		cfg.seed = sc->cfg.seed + i * 1000;
+		f2616_synth_init(&synth[i], &cfg);
+	}
+
+	if (sc->learn) {
+		ret = bench_f2616_learn(&synth[F2616_LINE_REAR]);
+		if (ret)
+			return ret;
+	}
+	res->timing = *f2616_get_timing();
+
+	for (int l = 0; l < F2616_LINE_CNT; l++) {
+		for (int i = 0; i < F2616_SNS_CNT; i++)
+			prev[l][i] = bench_f2616_cm(f2616_read_distance(), l,
+						    i);
+	}
+
+	/* Sensor changes its distance every frame, so a miss is seen */
+	for (uint32_t i = 0; i < cnt; i++) {
+		line = i % lines;
+		sensor = i / lines % F2616_SNS_CNT;
+		do {
+			cm = f2616_synth_random_cm(&synth[line]);
+		} while (i >= F2616_SNS_CNT * lines &&
+			 cm == frames[i - F2616_SNS_CNT * lines].cm);
+
+		f2616_synth_next(&synth[line], sensor, cm, &frames[i]);
+		res->edges += frames[i].edge_cnt;
+	}
+
+	/* Same edges without the decoder: cost of the measurement */
+	__F2616_GPIO_IRQ_CB = NULL;
+	__F2616_GPIO2_IRQ_CB = NULL;
+	base_ns = 0;
+	for (uint32_t i = 0; i < cnt; i += lines)
+		base_ns += bench_f2616_feed(&frames[i], sc->dual ?
+					    &frames[i + 1] : NULL);
+	__F2616_GPIO_IRQ_CB = isr;
+	__F2616_GPIO2_IRQ_CB = isr2;
+
+	res->virt_ns = host_time_ns();
+	ns = 0;
+	for (uint32_t i = 0; i < cnt; i += lines) {
+		ns += bench_f2616_feed(&frames[i], sc->dual ?
+				       &frames[i + 1] : NULL);
+
+		for (line = 0; line < lines; line++) {
+			f = &frames[i + line];
+			bench_f2616_check(f, line, prev[line][f->sensor], res);
+			prev[line][f->sensor] =
+				bench_f2616_cm(f2616_read_distance(), line,
+					       f->sensor);
+		}
+	}
+	res->virt_ns = host_time_ns() - res->virt_ns;
+	res->isr_ns = ns > base_ns ? ns - base_ns : 0;
+
+	f2616_set_timing(NULL);
+
+	if (sc->exact && res->ok != res->frames)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int bench_f2616_run(uint32_t ops)
+{
+	uint32_t cnt = MIN(ops / ARRAY_SIZE(scenarios),
+			   BENCH_F2616_MAX_FRAMES);
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		ret = bench_f2616_run_one(&scenarios[i], cnt, &results[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static void bench_f2616_report(void)
+{
+	const struct bench_f2616_result *res;
+	uint32_t whole;
+
+	printf("  %-10s %7s %7s %7s %7s %7s %9s %8s %7s\n", "line", "frames",
+	       "ok", "wrong", "missed", "cut", "accuracy", "ns/edge", "fps");
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->frames)
+			break;
+
+		whole = res->frames - res->cut;
+		printf("  %-10s %7u %7u %7u %7u %7u %8.2f%% %8.1f %7.2f\n",
+		       scenarios[i].name, res->frames, res->ok, res->wrong,
+		       res->missed, res->cut,
+		       whole ? 100.0 * res->ok / whole : 0.0,
+		       res->edges ? (double)res->isr_ns / res->edges : 0.0,
+		       res->virt_ns ? res->ok * 1e9 / res->virt_ns : 0.0);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->frames || !res->timing.learned)
+			continue;
+
+		printf("  %s: start %u..%u us, '1' %u..%u us, %u bits\n",
+		       scenarios[i].name, res->timing.start_min,
+		       res->timing.start_max, res->timing.one_min,
+		       res->timing.one_max, res->timing.frame_bits);
+	}
+}
+
+const struct host_bench host_bench_f2616 = {
+	.name = "f2616",
+	.op = "frame",
+	.ops = 9000,
+	.run = bench_f2616_run,
+	.report = bench_f2616_report,
+};
@@ -0,0 +1,57 @@
+/**
+ * @file       bench_gateway.c
+ * @brief      End-to-end forwarding benchmark: frames are put on the
+ *             vehicle segment and the application main loop is run until
+ *             they come out on the display segment unchanged.
+ *
+ *             Both segments are idle during the role detection at boot,
+ *             so the default assignment is used: bxCAN on the vehicle
+ *             side, MCP2515 on the display side.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "mdp.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define BENCH_GW_MAX_LOOPS	100000	/* Main loops to wait for a frame */
+#define BENCH_GW_ID_BASE	0x100	/* Not rewritten by any profile */
+
+static int bench_gateway_run(uint32_t ops)
+{
+	struct mdp_can_msg in = { .size = MAZDA_MAX_MSG_SIZE }, out;
+	uint32_t loops;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		in.id = BENCH_GW_ID_BASE + i % 64;
+		memcpy(in.data, &i, sizeof(i));
+
+		if (!host_can_inject(HOST_CAN_HAL, &in))
+			return -ENETDOWN;
+
+		for (loops = 0; !host_can_collect(HOST_CAN_SPI, &out); loops++) {
+			if (loops == BENCH_GW_MAX_LOOPS)
+				return -ETIMEDOUT;
+			mdp_run();
+		}
+
+		if (out.id != in.id || out.size != in.size ||
+		    memcmp(out.data, in.data, in.size))
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+const struct host_bench host_bench_gateway = {
+	.name = "gateway",
+	.op = "frame",
+	.ops = 10000,
+	.run = bench_gateway_run,
+};
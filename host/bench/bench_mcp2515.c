@@ -0,0 +1,210 @@
+/**
+ * @file       bench_mcp2515.c
+ * @brief      MCP2515 driver benchmark: the real driver runs against the
+ *             MCP2515 model and the SPI traffic is reported per
+ *             instruction.
+ *
+ *             Each operation is a burst of frames written back to back,
+ *             so several TX buffers are pending at once and must still
+ *             go out in order, and one frame received. Writes refused
+ *             with -EBUSY are retried and counted.
+ *
+ *             Frames received back to back with rollover must be read in
+ *             the order they arrived: both RX buffers are kept full, so
+ *             RXB1 often holds an older frame than RXB0. A frame can
+ *             also roll over to RXB1 while RXB0 is being read, and the
+ *             next one goes to RXB0: it must come out after the former.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "can_spi.h"
+#include "mcp2515_emu.h"
+#include "mdp.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_MCP_MAX_TRIES	100000	/* Driver calls to wait for a frame */
+#define BENCH_MCP_ID_BASE	0x100
+#define BENCH_MCP_BURST		3	/* Frames written per op */
+#define BENCH_MCP_ORDER_ID	0x200
+
+static uint32_t bench_mcp2515_frames;
+static uint32_t bench_mcp2515_busy;
+
+static bool bench_mcp2515_same(const struct mdp_can_msg *a,
+			       const struct mdp_can_msg *b)
+{
+	return a->id == b->id && a->size == b->size &&
+	       !memcmp(a->data, b->data, a->size);
+}
+
+static int bench_mcp2515_write(struct mdp_can_msg *msg)
+{
+	int ret;
+
+	for (uint32_t tries = 0; tries < BENCH_MCP_MAX_TRIES; tries++) {
+		ret = mdp_can_spi_write(msg->id, msg->data, msg->size);
+		if (ret != -EBUSY)
+			return ret;
+		bench_mcp2515_busy++;
+	}
+
+	return -ETIMEDOUT;
+}
+
+static int bench_mcp2515_read(struct mdp_can_msg *msg)
+{
+	int ret;
+
+	for (uint32_t tries = 0; tries < BENCH_MCP_MAX_TRIES; tries++) {
+		ret = mdp_can_spi_read(&msg->id, msg->data, &msg->size);
+		if (ret)
+			return ret < 0 ? ret : 0;
+	}
+
+	return -ETIMEDOUT;
+}
+
+/* Two RX buffers are topped up before every read, every 4th is a drain */
+static int bench_mcp2515_order(uint32_t ops)
+{
+	struct mdp_can_msg in = {
+		.id = BENCH_MCP_ORDER_ID,
+		.size = MAZDA_MAX_MSG_SIZE,
+	}, out;
+	uint32_t sent = 0, rcvd = 0, seq;
+	int ret;
+
+	for (uint32_t i = 0; i < ops || rcvd != sent; i++) {
+		while (i < ops && i % 4 != 3 && sent - rcvd < 2) {
+			memcpy(in.data, &sent, sizeof(sent));
+			if (!host_can_inject(HOST_CAN_SPI, &in))
+				return -ENETDOWN;
+			sent++;
+		}
+
+		if (rcvd == sent)
+			continue;
+
+		ret = bench_mcp2515_read(&out);
+		if (ret)
+			return ret;
+
+		memcpy(&seq, out.data, sizeof(seq));
+		if (out.id != BENCH_MCP_ORDER_ID || seq != rcvd)
+			return -EINVAL;
+		rcvd++;
+	}
+
+	bench_mcp2515_frames += rcvd;
+	return 0;
+}
+
+/* Frame rolls over to RXB1 while RXB0 is read, the next goes to RXB0 */
+static int bench_mcp2515_race(uint32_t ops)
+{
+	struct mdp_can_msg msg[3], out;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		for (int j = 0; j < 3; j++) {
+			msg[j].id = BENCH_MCP_ORDER_ID + j;
+			msg[j].size = MAZDA_MAX_MSG_SIZE;
+			memcpy(msg[j].data, &i, sizeof(i));
+		}
+
+		if (!host_can_inject(HOST_CAN_SPI, &msg[0]))
+			return -ENETDOWN;
+		mcp2515_emu_receive_in_read(&msg[1]);
+
+		for (int j = 0; j < 3; j++) {
+			if (bench_mcp2515_read(&out))
+				return -ETIMEDOUT;
+			if (!bench_mcp2515_same(&out, &msg[j]))
+				return -EINVAL;
+
+			if (!j && !host_can_inject(HOST_CAN_SPI, &msg[2]))
+				return -ENETDOWN;
+		}
+	}
+
+	bench_mcp2515_frames += ops * 3;
+	return 0;
+}
+
+static int bench_mcp2515_run(uint32_t ops)
+{
+	struct mdp_can_msg tx[BENCH_MCP_BURST], rx, out;
+	uint32_t tries;
+	int ret;
+
+	mcp2515_emu_clear_stats();
+	bench_mcp2515_frames = 0;
+	bench_mcp2515_busy = 0;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		for (int j = 0; j < BENCH_MCP_BURST; j++) {
+			tx[j].id = BENCH_MCP_ID_BASE + j;
+			tx[j].size = MAZDA_MAX_MSG_SIZE;
+			memset(tx[j].data, j, sizeof(tx[j].data));
+			memcpy(tx[j].data, &i, sizeof(i));
+
+			ret = bench_mcp2515_write(&tx[j]);
+			if (ret)
+				return ret;
+		}
+
+		rx.id = BENCH_MCP_ID_BASE + BENCH_MCP_BURST + i % 64;
+		rx.size = MAZDA_MAX_MSG_SIZE;
+		memcpy(rx.data, &i, sizeof(i));
+		if (!host_can_inject(HOST_CAN_SPI, &rx))
+			return -ENETDOWN;
+
+		ret = bench_mcp2515_read(&out);
+		if (ret)
+			return ret;
+		if (!bench_mcp2515_same(&out, &rx))
+			return -EINVAL;
+
+		/* Whole burst must come out, in the order it was written */
+		for (int j = 0; j < BENCH_MCP_BURST; j++) {
+			for (tries = 0; !host_can_collect(HOST_CAN_SPI, &out);
+			     tries++) {
+				if (tries == BENCH_MCP_MAX_TRIES)
+					return -ETIMEDOUT;
+				host_advance_us(1);
+			}
+
+			if (!bench_mcp2515_same(&out, &tx[j]))
+				return -EINVAL;
+		}
+
+		bench_mcp2515_frames += BENCH_MCP_BURST + 1;
+	}
+
+	ret = bench_mcp2515_order(ops);
+	if (ret)
+		return ret;
+
+	return bench_mcp2515_race(ops);
+}
+
+static void bench_mcp2515_report(void)
+{
+	mcp2515_emu_print_stats(bench_mcp2515_frames);
+	printf("  writes refused with -EBUSY: %u\n", bench_mcp2515_busy);
+}
+
+const struct host_bench host_bench_mcp2515 = {
+	.name = "mcp2515",
+	.op = "burst",
+	.ops = 10000,
+	.run = bench_mcp2515_run,
+	.report = bench_mcp2515_report,
+};
@@ -0,0 +1,246 @@
+/**
+ * @file       bench_rgear.c
+ * @brief      Reverse gear latency benchmark: the vehicle segment carries
+ *             the status message and the display messages every
+ *             BENCH_RG_PERIOD_MS, the reverse bit is set and cleared
+ *             again, and the time from the end of the first status frame
+ *             with the bit to the first rewritten display frame on the
+ *             display segment is measured.
+ *
+ *             Display messages follow the status message within a few
+ *             milliseconds, so the first of them can be rewritten only
+ *             if the reverse gear is seen before it is forwarded. Every
+ *             engagement where it is not is counted as missed, it waits
+ *             for the next period. The busy scenario adds bursts of
+ *             other frames ahead of the status message, the stall one
+ *             spends extra time in every main loop, standing in for
+ *             blocking work, so the status and display frames are often
+ *             read by the same loop.
+ *
+ *             Periods and gaps are chosen for the benchmark, they are
+ *             not taken from a vehicle.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "bxcan_emu.h"
+#include "common.h"
+#include "mdp.h"
+#include "vehicle.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_RG_PERIOD_MS	100
+#define BENCH_RG_ON_PERIODS	5	/* Reverse engaged, then released */
+#define BENCH_RG_PERIODS	10	/* Per engagement */
+#define BENCH_RG_GAP_US		2000	/* Status to display frames, max */
+#define BENCH_RG_BURST		8	/* Other frames ahead of the status */
+#define BENCH_RG_BURST_MS	10	/* Burst period */
+#define BENCH_RG_ID_BASE	0x100	/* Not rewritten by any profile */
+
+struct bench_rg_scenario {
+	const char *name;
+	bool busy;
+	uint32_t stall_us;	/* Extra time spent per main loop */
+};
+
+struct bench_rg_result {
+	uint32_t runs;
+	uint32_t seen;		/* Engagements shown on the display */
+	uint32_t missed;	/* First display frame not rewritten */
+	uint64_t lat_sum;	/* Microseconds */
+	uint32_t lat_min;
+	uint32_t lat_max;
+};
+
+static const struct bench_rg_scenario scenarios[] = {
+	{ .name = "quiet", .busy = false, .stall_us = 0 },
+	{ .name = "busy", .busy = true, .stall_us = 0 },
+	{ .name = "stall", .busy = false, .stall_us = 2000 },
+};
+
+static struct bench_rg_result results[ARRAY_SIZE(scenarios)];
+
+static uint32_t rng = 1;
+
+static uint32_t bench_rg_rand(void)
+{
+	rng = rng * 1103515245 + 12345;
+	return rng >> 16;
+}
+
+static void bench_rg_msg(struct mdp_can_msg *msg, mdp_veh_msg_t role)
+{
+	msg->id = mdp_vehicle_id(role);
+	msg->size = MAZDA_MAX_MSG_SIZE;
+	memset(msg->data, ' ', sizeof(msg->data));
+}
+
+/* Schedules one engagement, returns time of the first status with it */
+static int bench_rg_schedule(const struct bench_rg_scenario *sc,
+			     uint64_t start, uint64_t *rev_ns)
+{
+	const struct mdp_can_signal *sig = &mazda_signals[MAZDA_SIG_rgear];
+	const uint64_t frame_ns = BXCAN_EMU_FRAME_NS(MAZDA_MAX_MSG_SIZE);
+	static const mdp_veh_msg_t dp[] = {
+		MDP_VEH_MSG_DP_MISC, MDP_VEH_MSG_DP_LHALF,
+		MDP_VEH_MSG_DP_RHALF,
+	};
+	struct mdp_can_msg msg;
+	uint64_t at = start, period;
+	bool ok = true;
+
+	for (uint32_t p = 0; p < BENCH_RG_PERIODS; p++) {
+		period = start + (uint64_t)p * BENCH_RG_PERIOD_MS * 1000000;
+		at = MAX(at, period);
+
+		for (uint32_t b = 0; sc->busy &&
+		     b < BENCH_RG_PERIOD_MS / BENCH_RG_BURST_MS; b++) {
+			at = MAX(at, period + b * BENCH_RG_BURST_MS *
+					 1000000ULL);
+			msg.id = BENCH_RG_ID_BASE + b;
+			msg.size = MAZDA_MAX_MSG_SIZE;
+			memset(msg.data, 0, sizeof(msg.data));
+
+			/* Last burst is right ahead of the status */
+			for (uint32_t i = 0; i < BENCH_RG_BURST; i++) {
+				at += frame_ns;
+				ok &= bxcan_emu_schedule(&msg, at);
+			}
+		}
+
+		bench_rg_msg(&msg, MDP_VEH_MSG_STAT);
+		if (p < BENCH_RG_ON_PERIODS)
+			msg.data[sig->start / 8] |= BIT(sig->start % 8);
+		at += frame_ns;
+		ok &= bxcan_emu_schedule(&msg, at);
+		if (!p)
+			*rev_ns = at;
+
+		at += bench_rg_rand() % BENCH_RG_GAP_US * 1000ULL;
+		for (size_t i = 0; i < ARRAY_SIZE(dp); i++) {
+			bench_rg_msg(&msg, dp[i]);
+			at += frame_ns;
+			ok &= bxcan_emu_schedule(&msg, at);
+		}
+	}
+
+	return ok ? 0 : -ENOBUFS;
+}
+
+static int bench_rg_run_one(const struct bench_rg_scenario *sc,
+			    struct bench_rg_result *res)
+{
+	uint32_t lhalf = mdp_vehicle_id(MDP_VEH_MSG_DP_LHALF);
+	uint64_t start, end, rev_ns = 0, lat;
+	struct mdp_can_msg in, out;
+	uint32_t frames = 0;
+	bool seen = false;
+	int ret;
+
+	bench_rg_msg(&in, MDP_VEH_MSG_DP_LHALF);
+
+	/* Frames of the previous run are forwarded first */
+	start = host_time_ns() + BENCH_RG_PERIOD_MS * 1000000ULL;
+	while (host_time_ns() < start) {
+		mdp_run();
+		while (host_can_collect(HOST_CAN_SPI, &out))
+			;
+	}
+	end = start + BENCH_RG_PERIODS * BENCH_RG_PERIOD_MS * 1000000ULL;
+
+	ret = bench_rg_schedule(sc, start, &rev_ns);
+	if (ret)
+		return ret;
+
+	while (bxcan_emu_scheduled() || host_time_ns() < end) {
+		mdp_run();
+		if (sc->stall_us)
+			host_advance_us(sc->stall_us);
+
+		while (host_can_collect(HOST_CAN_SPI, &out)) {
+			if (out.id != lhalf || host_time_ns() < rev_ns ||
+			    seen)
+				continue;
+
+			frames++;
+			if (!memcmp(out.data, in.data, out.size))
+				continue;
+
+			lat = (host_time_ns() - rev_ns) / 1000;
+			res->lat_sum += lat;
+			res->lat_min = MIN(res->lat_min, (uint32_t)lat);
+			res->lat_max = MAX(res->lat_max, (uint32_t)lat);
+			res->missed += frames > 1;
+			res->seen++;
+			seen = true;
+		}
+	}
+
+	res->runs++;
+	return 0;
+}
+
+static int bench_rgear_run(uint32_t ops)
+{
+	uint32_t runs = ops / ARRAY_SIZE(scenarios);
+	struct bench_rg_result *res;
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		memset(res, 0, sizeof(*res));
+		res->lat_min = UINT32_MAX;
+
+		for (uint32_t r = 0; r < runs; r++) {
+			ret = bench_rg_run_one(&scenarios[i], res);
+			if (ret)
+				return ret;
+		}
+
+		if (res->seen != res->runs)
+			return -ETIMEDOUT;
+
+#if (MDP_RGEAR_IN_ISR == 1)
+		/* Armed at reception, the next display frame is rewritten */
+		if (res->missed)
+			return -EINVAL;
+#endif
+	}
+
+	return 0;
+}
+
+static void bench_rgear_report(void)
+{
+	const struct bench_rg_result *res;
+
+	printf("  %-6s %6s %6s %6s %9s %9s %9s\n", "bus", "runs", "seen",
+	       "missed", "min us", "avg us", "max us");
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->runs)
+			break;
+
+		printf("  %-6s %6u %6u %6u %9u %9.0f %9u\n",
+		       scenarios[i].name, res->runs, res->seen, res->missed,
+		       res->seen ? res->lat_min : 0,
+		       res->seen ? (double)res->lat_sum / res->seen : 0.0,
+		       res->lat_max);
+	}
+}
+
+const struct host_bench host_bench_rgear = {
+	.name = "rgear",
+	.op = "run",
+	.ops = 60,
+	.run = bench_rgear_run,
+	.report = bench_rgear_report,
+};
@@ -0,0 +1,146 @@
+/**
+ * @file       bench_signal.c
+ * @brief      CAN signal extraction benchmark: inline extractors checked
+ *             against the generic table decoder on random payloads.
+ *
+ *             Both are checked first against known answers, worked out
+ *             by hand from the DBC bit numbering for one payload: Intel
+ *             and Motorola signals within a byte, across bytes and up to
+ *             32 bits, signed and scaled ones.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "mdp.h"
+
+#include <errno.h>
+
+#define __BENCH_SIG_CHECK(name, ...) \
+	if (mazda_sig_##name(data) != \
+	    mdp_can_signal_decode(&mazda_signals[MAZDA_SIG_##name], data)) \
+		return -EINVAL;
+
+/**
+ * Known answers for bench_sig_payload[], the table columns as in
+ * MAZDA_SIGNALS, then the expected raw and physical values.
+ *
+ *	name,		start, len, order,	signed, num, den, offset,
+ *	raw,		physical
+ */
+#define BENCH_SIGNALS(X)						\
+	X(le_bit,	39, 1, MDP_SIG_LE,	false, 1, 1, 0,		\
+	  0x1,		1)						\
+	X(le_12,	4, 12, MDP_SIG_LE,	false, 1, 1, 0,		\
+	  0x341,	833)						\
+	X(le_16,	8, 16, MDP_SIG_LE,	false, 1, 1, 0,		\
+	  0x5634,	22068)						\
+	X(le_20,	28, 20, MDP_SIG_LE,	false, 1, 1, 0,		\
+	  0xBC9A7,	772519)						\
+	X(le_32,	0, 32, MDP_SIG_LE,	false, 1, 1, 0,		\
+	  0x78563412,	0x78563412)					\
+	X(be_8,		5, 8, MDP_SIG_BE,	false, 1, 1, 0,		\
+	  0x48,		72)						\
+	X(be_12,	7, 12, MDP_SIG_BE,	false, 1, 1, 0,		\
+	  0x123,	291)						\
+	X(be_12_low,	3, 12, MDP_SIG_BE,	false, 1, 1, 0,		\
+	  0x234,	564)						\
+	X(be_16,	23, 16, MDP_SIG_BE,	false, 1, 1, 0,		\
+	  0x5678,	22136)						\
+	X(be_32,	7, 32, MDP_SIG_BE,	false, 1, 1, 0,		\
+	  0x12345678,	0x12345678)					\
+	X(le_s8,	56, 8, MDP_SIG_LE,	true, 1, 1, 0,		\
+	  0xF0,		-16)						\
+	X(be_s16,	39, 16, MDP_SIG_BE,	true, 1, 1, 0,		\
+	  0x9ABC,	-25924)						\
+	X(le_scaled,	8, 16, MDP_SIG_LE,	false, 1, 4, -40,	\
+	  0x5634,	5477)						\
+	X(le_s4_scaled,	60, 4, MDP_SIG_LE,	true, 5, 1, 0,		\
+	  0xF,		-5)						\
+	X(be_s16_scaled, 39, 16, MDP_SIG_BE,	true, 3, 10, 100,	\
+	  0x9ABC,	-7677)	/* Rounded towards zero */
+
+#define __BENCH_SIG_EXTRACTOR(name, start, len, order, sgn, num, den,	\
+			      off, raw, phys)				\
+	MDP_SIG_EXTRACTOR(bench_sig, name, 0, start, len, order, sgn,	\
+			  num, den, off)
+#define __BENCH_SIG_ENTRY(name, start, len, order, sgn, num, den, off,	\
+			  raw, phys)					\
+	MDP_SIG_ENTRY(name, 0, start, len, order, sgn, num, den, off)
+#define __BENCH_SIG_ENUM(name, ...)	BENCH_SIG_##name,
+#define __BENCH_SIG_KNOWN(name, start, len, order, sgn, num, den, off,	\
+			  raw, phys)					\
+	if (bench_sig_##name##_raw(bench_sig_payload) != (raw) ||	\
+	    bench_sig_##name(bench_sig_payload) != (phys) ||		\
+	    mdp_can_signal_decode(&bench_signals[BENCH_SIG_##name],	\
+				  bench_sig_payload) != (phys))		\
+		return -EINVAL;
+#define __BENCH_SIG_RANDOM(name, ...) \
+	if (bench_sig_##name(data) != \
+	    mdp_can_signal_decode(&bench_signals[BENCH_SIG_##name], data)) \
+		return -EINVAL;
+
+BENCH_SIGNALS(__BENCH_SIG_EXTRACTOR)
+
+enum {
+	BENCH_SIGNALS(__BENCH_SIG_ENUM)
+	BENCH_SIG_COUNT
+};
+
+static const struct mdp_can_signal bench_signals[BENCH_SIG_COUNT] = {
+	BENCH_SIGNALS(__BENCH_SIG_ENTRY)
+};
+
+static const uint8_t bench_sig_payload[MAZDA_MAX_MSG_SIZE] = {
+	0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0,
+};
+
+static uint32_t lcg = 1;
+
+static uint32_t lcg_next(void)
+{
+	lcg = lcg * 1664525 + 1013904223;
+	return lcg;
+}
+
+static int bench_signal_known(void)
+{
+	BENCH_SIGNALS(__BENCH_SIG_KNOWN)
+
+	return 0;
+}
+
+static int bench_signal_run(uint32_t ops)
+{
+	uint8_t data[MAZDA_MAX_MSG_SIZE];
+	uint32_t w;
+	int ret;
+
+	ret = bench_signal_known();
+	if (ret)
+		return ret;
+
+	for (uint32_t i = 0; i < ops; i++) {
+		for (int j = 0; j < MAZDA_MAX_MSG_SIZE; j += 4) {
+			w = lcg_next();
+			data[j] = w;
+			data[j + 1] = w >> 8;
+			data[j + 2] = w >> 16;
+			data[j + 3] = w >> 24;
+		}
+
+		MAZDA_SIGNALS(__BENCH_SIG_CHECK)
+		BENCH_SIGNALS(__BENCH_SIG_RANDOM)
+	}
+
+	return 0;
+}
+
+const struct host_bench host_bench_signal = {
+	.name = "signal",
+	.op = "payload",
+	.ops = 1000000,
+	.run = bench_signal_run,
+};
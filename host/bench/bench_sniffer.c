@@ -0,0 +1,310 @@
+/**
+ * @file       bench_sniffer.c
+ * @brief      Sniffer benchmark: both buses carry 125 kbit/s traffic
+ *             with DLC 0 to 8, the sniffer streams it out of the UART
+ *             model and the stream is decoded the way
+ *             tools/mdp_sniff2candump.py does.
+ *
+ *             Every frame must either be in the stream, in order, or
+ *             be covered by a gap in the sequence number. With the
+ *             plain poll loop no frame may be lost up to the full load
+ *             on both buses. With extra time spent between polls the
+ *             controllers overrun or the driver queue fills, and the host
+ *             must see it as gaps.
+ *
+ *             The MCP2515 model has no schedule, its frames are put on
+ *             the bus between polls, all of them that are due.
+ *
+ *             Stamp error is the record time minus the end of the frame
+ *             on the bus, the worst one per bus. bxCAN frames are
+ *             stamped in the RX interrupt, MCP2515 ones when polled.
+ *             Sniffer mode lasts until reset, so this benchmark must be
+ *             the last one.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "host.h"
+#include "bxcan_emu.h"
+#include "mcp2515_emu.h"
+#include "uart_emu.h"
+#include "sniffer.h"
+#include "common.h"
+#include "mdp.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SNIFF_ID_BASE	0x100	/* Low byte is the frame number */
+#define BENCH_SNIFF_REC_HDR	9	/* Same as in sniffer.c */
+#define BENCH_SNIFF_STREAM	262144	/* Stream bytes per scenario */
+#define BENCH_SNIFF_QUIET_NS	20000000ULL	/* UART is drained by then */
+#define BENCH_SNIFF_TIMEOUT_NS	60000000000ULL
+#define BENCH_SNIFF_FRAMES_MAX	4096	/* Per bus and scenario */
+
+struct bench_sniff_scenario {
+	uint32_t load;		/* Percent of the bus bandwidth, both buses */
+	uint32_t stall_us;	/* Extra time spent between polls */
+};
+
+struct bench_sniff_result {
+	uint32_t frames;	/* Sent on both buses */
+	uint32_t records;
+	uint32_t lost;		/* Sent, but not in the stream */
+	uint32_t gaps;		/* Frames skipped by the sequence number */
+	uint32_t ovr;		/* Lost on overrun or in the driver queue */
+	uint32_t bytes;
+	uint64_t ns;
+	uint32_t err_us[MDP_SNIFFER_BUS_NUM];	/* Worst stamp error */
+};
+
+static const struct bench_sniff_scenario scenarios[] = {
+	{ .load = 50, .stall_us = 0 },
+	{ .load = 100, .stall_us = 0 },
+	{ .load = 100, .stall_us = 5000 },
+};
+
+static struct bench_sniff_result results[ARRAY_SIZE(scenarios)];
+
+static struct mdp_can buses[MDP_SNIFFER_BUS_NUM];
+static uint8_t stream[BENCH_SNIFF_STREAM];
+static int last_seq = -1;
+
+/* End of every frame on the bus, us */
+static uint32_t arrive_us[MDP_SNIFFER_BUS_NUM][BENCH_SNIFF_FRAMES_MAX];
+
+static uint8_t bench_sniff_crc8(const uint8_t *data, uint32_t size)
+{
+	uint8_t crc = 0;
+
+	while (size--) {
+		crc ^= *data++;
+		for (int i = 0; i < 8; i++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+
+	return crc;
+}
+
+static void bench_sniff_frame(struct mdp_can_msg *msg, uint32_t num)
+{
+	msg->id = BENCH_SNIFF_ID_BASE + (num & 0xFF);
+	msg->size = num % (MAZDA_MAX_MSG_SIZE + 1);
+
+	for (uint32_t i = 0; i < msg->size; i++)
+		msg->data[i] = num + i;
+}
+
+/* End of the next frame, bus is idle for the rest of the load */
+static uint64_t bench_sniff_next(uint64_t at, uint32_t num, uint32_t load)
+{
+	return at + BXCAN_EMU_FRAME_NS(num % (MAZDA_MAX_MSG_SIZE + 1)) *
+		    100 / load;
+}
+
+/* Frames of a bus must come in order, some may be missing */
+static int bench_sniff_check(const uint8_t *rec, uint32_t bus,
+			     uint32_t *next, uint32_t frames,
+			     struct bench_sniff_result *res)
+{
+	uint32_t id = rec[3] | rec[4] << 8;
+	uint32_t dlc = rec[2] & MDP_SNIFFER_INFO_DLC;
+	uint32_t us = rec[5] | rec[6] << 8 | rec[7] << 16 |
+		      (uint32_t)rec[8] << 24;
+	struct mdp_can_msg ref;
+	uint32_t num, err;
+
+	/* Frame number from its low byte, nothing is lost 256 in a row */
+	num = *next + ((id - BENCH_SNIFF_ID_BASE - *next) & 0xFF);
+	if (num >= frames)
+		return -EINVAL;
+
+	bench_sniff_frame(&ref, num);
+	if (id != ref.id || dlc != ref.size ||
+	    memcmp(&rec[BENCH_SNIFF_REC_HDR], ref.data, dlc))
+		return -EINVAL;
+
+	/* Stamp can't be earlier than the frame, but for rounding */
+	err = us - arrive_us[bus][num];
+	if ((int32_t)err < -1)
+		return -ERANGE;
+	if ((int32_t)err > 0)
+		res->err_us[bus] = MAX(res->err_us[bus], err);
+
+	res->lost += num - *next;
+	*next = num + 1;
+	return 0;
+}
+
+static int bench_sniff_decode(uint32_t len, uint32_t frames,
+			      struct bench_sniff_result *res)
+{
+	uint32_t next[MDP_SNIFFER_BUS_NUM] = { 0 };
+	uint32_t pos = 0, size, dlc, bus;
+	const uint8_t *rec;
+	int ret;
+
+	while (pos < len) {
+		rec = &stream[pos];
+		if (rec[0] != MDP_SNIFFER_SYNC || len - pos < 3)
+			return -EPROTO;
+
+		dlc = rec[2] & MDP_SNIFFER_INFO_DLC;
+		size = BENCH_SNIFF_REC_HDR + dlc + 1;
+		if (len - pos < size ||
+		    bench_sniff_crc8(&rec[1], size - 2) != rec[size - 1])
+			return -EPROTO;
+
+		if (last_seq >= 0)
+			res->gaps += (uint8_t)(rec[1] - last_seq - 1);
+		last_seq = rec[1];
+
+		bus = rec[2] >> MDP_SNIFFER_INFO_BUS;
+		ret = bench_sniff_check(rec, bus, &next[bus], frames, res);
+		if (ret)
+			return ret;
+
+		res->records++;
+		pos += size;
+	}
+
+	/* Frames missing at the end are lost too */
+	for (int i = 0; i < MDP_SNIFFER_BUS_NUM; i++)
+		res->lost += frames - next[i];
+
+	return 0;
+}
+
+static int bench_sniff_run_one(const struct bench_sniff_scenario *sc,
+			       uint32_t frames, struct bench_sniff_result *res)
+{
+	uint64_t at, spi_at, start, last_ns;
+	struct mdp_can_msg msg;
+	uint32_t num, spi_num = 0, len = 0, hal_lost;
+
+	if (frames > BENCH_SNIFF_FRAMES_MAX)
+		return -E2BIG;
+
+	memset(res, 0, sizeof(*res));
+	res->frames = frames * MDP_SNIFFER_BUS_NUM;
+	bxcan_emu_clear_stats();
+	mcp2515_emu_clear_stats();
+	hal_lost = mdp_can_rx_lost(&buses[0]);
+
+	start = host_time_ns();
+	at = start;
+	for (num = 0; num < frames; num++) {
+		at = bench_sniff_next(at, num, sc->load);
+
+		bench_sniff_frame(&msg, num);
+		if (!bxcan_emu_schedule(&msg, at))
+			return -ENOBUFS;
+		arrive_us[0][num] = at / 1000;
+	}
+
+	/* Half a frame apart, so the buses are not in lockstep */
+	spi_at = bench_sniff_next(start + BXCAN_EMU_FRAME_NS(0) / 2, 0,
+				  sc->load);
+	last_ns = MAX(at, spi_at);
+
+	while (bxcan_emu_scheduled() || spi_num < frames ||
+	       host_time_ns() - last_ns < BENCH_SNIFF_QUIET_NS) {
+		if (host_time_ns() - start > BENCH_SNIFF_TIMEOUT_NS)
+			return -ETIMEDOUT;
+
+		for (; spi_num < frames && spi_at <= host_time_ns();
+		     spi_num++) {
+			bench_sniff_frame(&msg, spi_num);
+			mcp2515_emu_receive(&msg);
+			arrive_us[1][spi_num] = spi_at / 1000;
+			spi_at = bench_sniff_next(spi_at, spi_num + 1,
+						  sc->load);
+			last_ns = MAX(last_ns, spi_at);
+		}
+
+		mdp_sniffer_poll();
+		if (sc->stall_us)
+			host_advance_us(sc->stall_us);
+
+		len += uart_emu_read(&stream[len], sizeof(stream) - len);
+		if (len == sizeof(stream))
+			return -ENOBUFS;
+	}
+
+	res->ns = host_time_ns() - start;
+	res->bytes = len;
+	/* bxCAN frames are taken in interrupt, they are lost in the queue */
+	res->ovr = bxcan_emu_stats()->rx_ovr[CAN_RX_FIFO0] +
+		   bxcan_emu_stats()->rx_ovr[CAN_RX_FIFO1] +
+		   mdp_can_rx_lost(&buses[0]) - hal_lost +
+		   mcp2515_emu_stats()->rx_ovr;
+
+	return bench_sniff_decode(len, frames, res);
+}
+
+static int bench_sniffer_run(uint32_t ops)
+{
+	uint32_t frames = ops / ARRAY_SIZE(scenarios) / MDP_SNIFFER_BUS_NUM;
+	const struct bench_sniff_result *res;
+	int ret;
+
+	buses[0] = mdp_get_can_hal_interface();
+	buses[1] = mdp_get_can_spi_interface();
+
+	ret = mdp_sniffer_start(&buses[0], &buses[1]);
+	if (ret)
+		return ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+
+		ret = bench_sniff_run_one(&scenarios[i], frames, &results[i]);
+		if (ret)
+			return ret;
+
+		/* Every loss is seen, no gap without a loss */
+		if (res->lost != res->ovr || res->gaps > res->lost ||
+		    (res->lost && !res->gaps))
+			return -EPROTO;
+
+		if (!scenarios[i].stall_us && res->lost)
+			return -EOVERFLOW;
+	}
+
+	return 0;
+}
+
+static void bench_sniffer_report(void)
+{
+	const struct bench_sniff_result *res;
+
+	printf("  %-6s %-9s %8s %8s %8s %8s %8s %8s %8s\n", "load", "stall",
+	       "frames", "streamed", "lost", "seq gap", "uart %", "hal err",
+	       "spi err");
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->frames)
+			break;
+
+		printf("  %3u %%  %5u us  %8u %8u %8u %8u %8.1f %5u us "
+		       "%5u us\n",
+		       scenarios[i].load, scenarios[i].stall_us, res->frames,
+		       res->records, res->lost, res->gaps,
+		       res->ns ? 100.0 * res->bytes * UART_EMU_BYTE_BITS *
+		       1e9 / MDP_SNIFFER_UART_SPEED / res->ns : 0.0,
+		       res->err_us[0], res->err_us[1]);
+	}
+}
+
+const struct host_bench host_bench_sniffer = {
+	.name = "sniffer",
+	.op = "frame",
+	.ops = 12000,
+	.run = bench_sniffer_run,
+	.report = bench_sniffer_report,
+};
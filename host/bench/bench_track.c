@@ -0,0 +1,282 @@
+/**
+ * @file       bench_track.c
+ * @brief      Distance tracker benchmark: the car backs up to an obstacle,
+ *             the sensor reports the distance in 10 cm steps every
+ *             80-100 ms and a display frame goes out every 250 ms. Every
+ *             frame shows either the last reading or the tracker
+ *             prediction for the frame time, both are compared to the
+ *             true distance at that time.
+ *
+ *             Error is the mean absolute error of the shown distance,
+ *             reaction is the time from the obstacle coming closer than
+ *             MDP_BENCH_TRACK_ALERT_CM to the first frame showing that.
+ *             The tracker must be ahead of the raw readings when the car
+ *             moves, and must not move the shown distance when it stands,
+ *             neither still nor after a stop.
+ *
+ *             Tone is the true distance where the constant tone starts,
+ *             by the distance alone and with the time to contact
+ *             escalation of mdp.c. A faster car must get the tone
+ *             farther away, a still one never (0 cm). Cost is host time
+ *             of one reading: update, prediction and time to contact.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bench.h"
+#include "track.h"
+#include "common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_TRACK_SENSOR_MS	80	/* Reading period, plus up to 20 ms */
+#define BENCH_TRACK_FRAME_MS	250	/* Display frame period */
+#define BENCH_TRACK_RUN_MS	10000
+#define BENCH_TRACK_ALERT_CM	60
+#define BENCH_TRACK_STILL_ERR	10	/* Allowed error of a still car */
+#define BENCH_TRACK_COST_CNT	1000000
+
+/* Same as in mdp.c */
+#define BENCH_TRACK_TONE_CM	30
+#define BENCH_TRACK_REF_SPEED	30
+
+static const struct mdp_track_cfg track_cfg = MDP_TRACK_CFG_DEFAULT;
+
+struct bench_track_scenario {
+	const char *name;
+	uint32_t start_cm;
+	uint32_t speed;		/* Approach speed, cm/s */
+	uint32_t stop_cm;	/* Car stops there */
+};
+
+struct bench_track_result {
+	uint32_t runs;
+	uint64_t frames;
+	uint64_t raw_err;	/* Sum of absolute errors, cm */
+	uint64_t trk_err;
+	uint64_t raw_react;	/* Sum of reaction times, ms */
+	uint64_t trk_react;
+	uint32_t reacts;
+	uint32_t trk_err_max;	/* While standing */
+	uint64_t dist_tone;	/* Sum of tone start distances, 1/10 cm */
+	uint64_t ttc_tone;
+	uint32_t dist_tones;	/* Runs with the tone */
+	uint32_t ttc_tones;
+};
+
+static const struct bench_track_scenario scenarios[] = {
+	{ .name = "still", .start_cm = 120, .speed = 0, .stop_cm = 120 },
+	{ .name = "slow", .start_cm = 250, .speed = 30, .stop_cm = 30 },
+	{ .name = "walk", .start_cm = 250, .speed = 60, .stop_cm = 30 },
+	{ .name = "fast", .start_cm = 250, .speed = 100, .stop_cm = 30 },
+	{ .name = "stop", .start_cm = 250, .speed = 80, .stop_cm = 50 },
+};
+
+static struct bench_track_result results[ARRAY_SIZE(scenarios)];
+static double cost_ns;
+
+static uint64_t bench_track_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t bench_track_rand(uint32_t *rng)
+{
+	*rng = *rng * 1103515245 + 12345;
+	return *rng >> 16;
+}
+
+/* True distance at ms, 1/10 cm */
+static uint32_t bench_track_true(const struct bench_track_scenario *sc,
+				 uint32_t ms)
+{
+	uint32_t moved = sc->speed * ms / 100;
+
+	return MAX(sc->start_cm * 10 - MIN(moved, sc->start_cm * 10),
+		   sc->stop_cm * 10);
+}
+
+/* Sensor reports 10 cm steps and nothing between 0 and 30 cm */
+static uint32_t bench_track_reading(uint32_t mm)
+{
+	uint32_t cm = (mm + 50) / 100 * 10;
+
+	return cm < 30 ? 0 : MIN(cm, 250U);
+}
+
+static void bench_track_run_one(const struct bench_track_scenario *sc,
+				uint32_t seed, struct bench_track_result *res)
+{
+	uint32_t next_reading = 0, next_frame = BENCH_TRACK_FRAME_MS;
+	uint32_t alert_ms = UINT32_MAX, raw_ms = 0, trk_ms = 0;
+	uint32_t dist_tone = 0, ttc_tone = 0, ttc;
+	uint32_t rng = seed, raw = 0, trk, mm, err;
+	struct mdp_track t;
+
+	mdp_track_reset(&t);
+
+	for (uint32_t ms = 0; ms < BENCH_TRACK_RUN_MS; ms++) {
+		mm = bench_track_true(sc, ms);
+		if (alert_ms == UINT32_MAX && mm < BENCH_TRACK_ALERT_CM * 10)
+			alert_ms = ms;
+
+		if (ms == next_reading) {
+			raw = bench_track_reading(mm);
+			mdp_track_update(&t, &track_cfg, raw, ms);
+			next_reading += BENCH_TRACK_SENSOR_MS +
+					bench_track_rand(&rng) % 21;
+		}
+
+		if (ms != next_frame)
+			continue;
+		next_frame += BENCH_TRACK_FRAME_MS;
+
+		trk = mdp_track_predict(&t, &track_cfg, ms);
+		ttc = mdp_track_ttc_ms(&t, &track_cfg);
+		if (ttc != UINT32_MAX)
+			ttc = ttc * BENCH_TRACK_REF_SPEED / 1000;
+
+		if (!dist_tone && trk < BENCH_TRACK_TONE_CM)
+			dist_tone = mm;
+		if (!ttc_tone && MIN(trk, ttc) < BENCH_TRACK_TONE_CM)
+			ttc_tone = mm;
+
+		err = abs((int)(trk * 10) - (int)mm);
+		if (mm == sc->stop_cm * 10) {
+			res->trk_err_max = MAX(res->trk_err_max, err / 10);
+		} else {
+			res->frames++;
+			res->raw_err += abs((int)(raw * 10) - (int)mm);
+			res->trk_err += err;
+		}
+
+		if (!raw_ms && raw < BENCH_TRACK_ALERT_CM)
+			raw_ms = ms;
+		if (!trk_ms && trk < BENCH_TRACK_ALERT_CM)
+			trk_ms = ms;
+	}
+
+	res->runs++;
+	if (dist_tone) {
+		res->dist_tone += dist_tone;
+		res->dist_tones++;
+	}
+	if (ttc_tone) {
+		res->ttc_tone += ttc_tone;
+		res->ttc_tones++;
+	}
+
+	if (alert_ms == UINT32_MAX || !raw_ms || !trk_ms)
+		return;
+
+	res->raw_react += raw_ms - alert_ms;
+	res->trk_react += MAX(trk_ms, alert_ms) - alert_ms;
+	res->reacts++;
+}
+
+/* Same work as for every new reading in mdp.c */
+static void bench_track_cost(void)
+{
+	struct mdp_track t;
+	volatile uint32_t out;
+	uint64_t ns;
+
+	mdp_track_reset(&t);
+
+	ns = bench_track_ns();
+	for (uint32_t i = 0; i < BENCH_TRACK_COST_CNT; i++) {
+		mdp_track_update(&t, &track_cfg, 250 - i % 220, i * 90);
+		out = mdp_track_predict(&t, &track_cfg, i * 90 + 100);
+		out = mdp_track_ttc_ms(&t, &track_cfg);
+	}
+	ns = bench_track_ns() - ns;
+
+	(void)out;
+	cost_ns = (double)ns / BENCH_TRACK_COST_CNT;
+}
+
+static int bench_track_run(uint32_t ops)
+{
+	const struct bench_track_result *res;
+	uint32_t runs = ops / ARRAY_SIZE(scenarios);
+
+	memset(results, 0, sizeof(results));
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		for (uint32_t r = 0; r < runs; r++)
+			bench_track_run_one(&scenarios[i], r + 1, &results[i]);
+	}
+	bench_track_cost();
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+
+		if (res->trk_err_max > BENCH_TRACK_STILL_ERR)
+			return -EINVAL;
+
+		if (!scenarios[i].speed) {
+			if (res->ttc_tones)
+				return -EINVAL;
+			continue;
+		}
+
+		/* Time to contact never warns later than the distance */
+		if (res->ttc_tones != res->runs ||
+		    res->ttc_tone < res->dist_tone)
+			return -EINVAL;
+
+		/* Moving car, the prediction must be closer to the truth */
+		if (res->reacts != res->runs || res->trk_err >= res->raw_err ||
+		    res->trk_react > res->raw_react)
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void bench_track_report(void)
+{
+	const struct bench_track_result *res;
+
+	printf("  %-6s %6s %8s %8s %7s %7s %8s %8s %8s\n", "car",
+	       "frames", "raw err", "trk err", "raw ms", "trk ms", "stop err",
+	       "tone", "ttc tone");
+
+	for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++) {
+		res = &results[i];
+		if (!res->runs)
+			break;
+
+		printf("  %-6s %6llu %6.1fcm %6.1fcm %7.0f %7.0f %6ucm "
+		       "%6.0fcm %6.0fcm\n",
+		       scenarios[i].name, (unsigned long long)res->frames,
+		       res->frames ? res->raw_err / 10.0 / res->frames : 0.0,
+		       res->frames ? res->trk_err / 10.0 / res->frames : 0.0,
+		       res->reacts ? (double)res->raw_react / res->reacts : 0.0,
+		       res->reacts ? (double)res->trk_react / res->reacts : 0.0,
+		       res->trk_err_max,
+		       res->dist_tones ?
+		       res->dist_tone / 10.0 / res->dist_tones : 0.0,
+		       res->ttc_tones ?
+		       res->ttc_tone / 10.0 / res->ttc_tones : 0.0);
+	}
+
+	printf("  cost %.1f ns/reading\n", cost_ns);
+}
+
+const struct host_bench host_bench_track = {
+	.name = "track",
+	.op = "run",
+	.ops = 500,
+	.run = bench_track_run,
+	.report = bench_track_report,
+};
@@ -0,0 +1,526 @@
+/**
+ * @file       bxcan_emu.c
+ * @brief      Behavioural bxCAN model implementation.
+ *
+ *             Follows the bxCAN chapter of the STM32F1 reference manual
+ *             (RM0008, section 24) and the HAL CAN driver semantics of
+ *             the calls used by the application.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "bxcan_emu.h"
+#include "host.h"
+#include "common.h"
+
+#include <string.h>
+
+#define EMU_BANK_NUM		14
+#define EMU_MAILBOX_NUM		3
+
+/* Standard ID position in 32-bit and 16-bit filter registers */
+#define EMU_STID_SHIFT32	21
+#define EMU_STID_SHIFT16	5
+
+struct bxcan_emu_bank {
+	bool active;
+	uint32_t mode;
+	uint32_t scale;
+	uint32_t fifo;
+	uint32_t fr1;
+	uint32_t fr2;
+};
+
+struct bxcan_emu_fifo {
+	struct mdp_can_msg msg[BXCAN_EMU_FIFO_LEN];
+	uint32_t match[BXCAN_EMU_FIFO_LEN];
+	uint32_t level;
+	bool ovr;		/* FOVR flag */
+};
+
+struct bxcan_emu_sched {
+	struct mdp_can_msg msg;
+	uint64_t at_ns;
+};
+
+struct bxcan_emu {
+	HAL_CAN_StateTypeDef state;
+	CAN_HandleTypeDef *hcan;	/* Passed to interrupt callbacks */
+	uint32_t ints;
+
+	struct bxcan_emu_bank banks[EMU_BANK_NUM];
+	struct bxcan_emu_fifo fifo[2];
+
+	struct bxcan_emu_sched sched[BXCAN_EMU_SCHED_LEN];
+	uint32_t sched_head, sched_tail;
+
+	/* Transmission */
+	bool mailbox_pending[EMU_MAILBOX_NUM];
+	struct mdp_can_msg mailbox[EMU_MAILBOX_NUM];
+	int tx_cur;		/* Mailbox being sent, -1 if none */
+	uint64_t tx_end_ns;
+	uint64_t bus_free_ns;
+
+	struct mdp_can_msg tx_queue[BXCAN_EMU_TX_QUEUE];
+	uint32_t tx_head, tx_tail;
+
+	struct bxcan_emu_stats stats;
+};
+
+CAN_TypeDef host_can1;
+
+static struct bxcan_emu emu = { .state = HAL_CAN_STATE_READY, .tx_cur = -1 };
+
+static bool emu_ready(CAN_HandleTypeDef *hcan)
+{
+	/* The call itself takes time, frames may arrive meanwhile */
+	host_advance_cycles(BXCAN_EMU_CALL_CYCLES);
+
+	hcan->State = emu.state;
+	if (emu.state == HAL_CAN_STATE_READY ||
+	    emu.state == HAL_CAN_STATE_LISTENING)
+		return true;
+
+	hcan->ErrorCode |= HAL_CAN_ERROR_NOT_INITIALIZED;
+	return false;
+}
+
+static void emu_tx_complete(void)
+{
+	struct mdp_can_msg *msg = &emu.mailbox[emu.tx_cur];
+
+	emu.mailbox_pending[emu.tx_cur] = false;
+	emu.bus_free_ns = emu.tx_end_ns;
+	emu.tx_cur = -1;
+	emu.stats.tx++;
+
+	/* Silent mode: the frame is looped back internally only */
+	if (host_can1.BTR & CAN_BTR_SILM) {
+		emu.stats.tx_silent++;
+		return;
+	}
+
+	if (emu.tx_head - emu.tx_tail >= BXCAN_EMU_TX_QUEUE) {
+		emu.stats.tx_dropped++;
+		return;
+	}
+
+	emu.tx_queue[emu.tx_head++ % BXCAN_EMU_TX_QUEUE] = *msg;
+}
+
+/* Pending mailbox with the lowest ID, the lowest number wins a tie */
+static int emu_tx_next(void)
+{
+	int next = -1;
+
+	for (int i = 0; i < EMU_MAILBOX_NUM; i++) {
+		if (!emu.mailbox_pending[i])
+			continue;
+		if (next < 0 || emu.mailbox[i].id < emu.mailbox[next].id)
+			next = i;
+	}
+
+	return next;
+}
+
+/* Brings own transmissions to the current virtual time */
+static void emu_tx_update(void)
+{
+	uint64_t now = host_time_ns();
+	uint32_t size;
+
+	while (true) {
+		if (emu.tx_cur >= 0) {
+			if (emu.tx_end_ns > now)
+				return;
+			emu_tx_complete();
+		}
+
+		if (emu.state != HAL_CAN_STATE_LISTENING)
+			return;
+
+		emu.tx_cur = emu_tx_next();
+		if (emu.tx_cur < 0)
+			return;
+
+		size = emu.mailbox[emu.tx_cur].size;
+		emu.tx_end_ns = MAX(emu.bus_free_ns, now) +
+				BXCAN_EMU_FRAME_NS(size);
+	}
+}
+
+static bool emu_bank_match(const struct bxcan_emu_bank *b, uint32_t id)
+{
+	uint32_t v32 = id << EMU_STID_SHIFT32;
+	uint32_t v16 = id << EMU_STID_SHIFT16;
+
+	if (b->scale == CAN_FILTERSCALE_32BIT) {
+		if (b->mode == CAN_FILTERMODE_IDLIST)
+			return v32 == b->fr1 || v32 == b->fr2;
+
+		return !((v32 ^ b->fr1) & b->fr2);
+	}
+
+	if (b->mode == CAN_FILTERMODE_IDLIST) {
+		return v16 == (b->fr1 & 0xFFFF) || v16 == (b->fr1 >> 16) ||
+		       v16 == (b->fr2 & 0xFFFF) || v16 == (b->fr2 >> 16);
+	}
+
+	/* ID in the low half-word, mask in the high one */
+	return !((v16 ^ b->fr1) & (b->fr1 >> 16) & 0xFFFF) ||
+	       !((v16 ^ b->fr2) & (b->fr2 >> 16) & 0xFFFF);
+}
+
+/**
+ * Filter priority rules: 32-bit scale over 16-bit, then list mode over
+ * mask mode, then the lower bank number.
+ */
+static int emu_filter(uint32_t id)
+{
+	const struct bxcan_emu_bank *b, *best = NULL;
+	int best_idx = -1;
+
+	for (int i = 0; i < EMU_BANK_NUM; i++) {
+		b = &emu.banks[i];
+		if (!b->active || !emu_bank_match(b, id))
+			continue;
+
+		if (best && b->scale < best->scale)
+			continue;
+		if (best && b->scale == best->scale && b->mode <= best->mode)
+			continue;
+
+		best = b;
+		best_idx = i;
+	}
+
+	return best_idx;
+}
+
+static bool emu_rx(const struct mdp_can_msg *msg)
+{
+	struct bxcan_emu_fifo *f;
+	uint32_t fifo;
+	int bank;
+
+	if (emu.state != HAL_CAN_STATE_LISTENING) {
+		emu.stats.rx_ignored++;
+		return false;
+	}
+
+	bank = emu_filter(msg->id);
+	if (bank < 0) {
+		emu.stats.rx_ignored++;
+		return false;
+	}
+
+	fifo = emu.banks[bank].fifo;
+	f = &emu.fifo[fifo];
+
+	/* FIFO is not locked, the last stored message is overwritten */
+	if (f->level == BXCAN_EMU_FIFO_LEN) {
+		f->msg[f->level - 1] = *msg;
+		f->match[f->level - 1] = bank;
+		emu.stats.rx_ovr[fifo]++;
+		f->ovr = true;
+		return false;
+	}
+
+	f->msg[f->level] = *msg;
+	f->match[f->level] = bank;
+	f->level++;
+	emu.stats.rx[fifo]++;
+	emu.stats.rx_max_level[fifo] = MAX(emu.stats.rx_max_level[fifo],
+					   f->level);
+
+	/* Interrupt is taken while messages are pending and being read */
+	if (fifo == CAN_RX_FIFO1 &&
+	    (emu.ints & CAN_IT_RX_FIFO1_MSG_PENDING)) {
+		for (int i = 0; i < BXCAN_EMU_FIFO_LEN && f->level; i++)
+			HAL_CAN_RxFifo1MsgPendingCallback(emu.hcan);
+	}
+
+	return true;
+}
+
+void bxcan_emu_reset(void)
+{
+	memset(&emu, 0, sizeof(emu));
+	memset(&host_can1, 0, sizeof(host_can1));
+
+	emu.state = HAL_CAN_STATE_READY;
+	emu.tx_cur = -1;
+}
+
+bool bxcan_emu_schedule(const struct mdp_can_msg *msg, uint64_t at_ns)
+{
+	struct bxcan_emu_sched *s;
+
+	if (emu.sched_head - emu.sched_tail >= BXCAN_EMU_SCHED_LEN)
+		return false;
+
+	s = &emu.sched[emu.sched_head++ % BXCAN_EMU_SCHED_LEN];
+	s->msg = *msg;
+	s->at_ns = at_ns;
+	return true;
+}
+
+bool bxcan_emu_receive(const struct mdp_can_msg *msg)
+{
+	/* Scheduled frames come first */
+	bxcan_emu_update();
+
+	return emu_rx(msg);
+}
+
+bool bxcan_emu_collect(struct mdp_can_msg *msg)
+{
+	emu_tx_update();
+
+	if (emu.tx_head == emu.tx_tail)
+		return false;
+
+	*msg = emu.tx_queue[emu.tx_tail++ % BXCAN_EMU_TX_QUEUE];
+	return true;
+}
+
+uint32_t bxcan_emu_scheduled(void)
+{
+	return emu.sched_head - emu.sched_tail;
+}
+
+uint64_t bxcan_emu_next_ns(void)
+{
+	if (emu.sched_head == emu.sched_tail)
+		return BXCAN_EMU_NO_EVENT;
+
+	return emu.sched[emu.sched_tail % BXCAN_EMU_SCHED_LEN].at_ns;
+}
+
+void bxcan_emu_update(void)
+{
+	struct bxcan_emu_sched *s;
+	uint64_t now = host_time_ns();
+
+	while (emu.sched_head != emu.sched_tail) {
+		s = &emu.sched[emu.sched_tail % BXCAN_EMU_SCHED_LEN];
+		if (s->at_ns > now)
+			return;
+
+		emu.sched_tail++;
+		emu_rx(&s->msg);
+	}
+}
+
+bool bxcan_emu_rx_pending(void)
+{
+	return emu.fifo[CAN_RX_FIFO0].level || emu.fifo[CAN_RX_FIFO1].level;
+}
+
+const struct bxcan_emu_stats *bxcan_emu_stats(void)
+{
+	return &emu.stats;
+}
+
+void bxcan_emu_clear_stats(void)
+{
+	memset(&emu.stats, 0, sizeof(emu.stats));
+}
+
+/* HAL CAN driver */
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan,
+				       CAN_FilterTypeDef *sFilterConfig)
+{
+	struct bxcan_emu_bank *b;
+
+	if (!emu_ready(hcan))
+		return HAL_ERROR;
+
+	if (sFilterConfig->FilterBank >= EMU_BANK_NUM) {
+		hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+
+	b = &emu.banks[sFilterConfig->FilterBank];
+	b->mode = sFilterConfig->FilterMode;
+	b->scale = sFilterConfig->FilterScale;
+	b->fifo = sFilterConfig->FilterFIFOAssignment;
+	b->active = sFilterConfig->FilterActivation == ENABLE;
+
+	/* Register layout as written by the HAL driver */
+	if (b->scale == CAN_FILTERSCALE_32BIT) {
+		b->fr1 = ((sFilterConfig->FilterIdHigh & 0xFFFF) << 16) |
+			 (sFilterConfig->FilterIdLow & 0xFFFF);
+		b->fr2 = ((sFilterConfig->FilterMaskIdHigh & 0xFFFF) << 16) |
+			 (sFilterConfig->FilterMaskIdLow & 0xFFFF);
+	} else {
+		b->fr1 = ((sFilterConfig->FilterMaskIdLow & 0xFFFF) << 16) |
+			 (sFilterConfig->FilterIdLow & 0xFFFF);
+		b->fr2 = ((sFilterConfig->FilterMaskIdHigh & 0xFFFF) << 16) |
+			 (sFilterConfig->FilterIdHigh & 0xFFFF);
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan)
+{
+	host_advance_cycles(BXCAN_EMU_CALL_CYCLES);
+
+	if (emu.state != HAL_CAN_STATE_READY) {
+		hcan->ErrorCode |= HAL_CAN_ERROR_NOT_READY;
+		return HAL_ERROR;
+	}
+
+	emu.state = HAL_CAN_STATE_LISTENING;
+	hcan->State = emu.state;
+	hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_Stop(CAN_HandleTypeDef *hcan)
+{
+	host_advance_cycles(BXCAN_EMU_CALL_CYCLES);
+
+	if (emu.state != HAL_CAN_STATE_LISTENING) {
+		hcan->ErrorCode |= HAL_CAN_ERROR_NOT_STARTED;
+		return HAL_ERROR;
+	}
+
+	/* Frame on the wire is finished, then the controller leaves */
+	emu_tx_update();
+	emu.state = HAL_CAN_STATE_READY;
+	hcan->State = emu.state;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan,
+					       uint32_t ActiveITs)
+{
+	if (!emu_ready(hcan))
+		return HAL_ERROR;
+
+	emu.hcan = hcan;
+	emu.ints |= ActiveITs;
+	return HAL_OK;
+}
+
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef *hcan,
+				    uint32_t RxFifo)
+{
+	if (!emu_ready(hcan) || RxFifo > CAN_RX_FIFO1)
+		return 0;
+
+	return emu.fifo[RxFifo].level;
+}
+
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan,
+				       uint32_t RxFifo,
+				       CAN_RxHeaderTypeDef *pHeader,
+				       uint8_t aData[])
+{
+	struct bxcan_emu_fifo *f;
+	struct mdp_can_msg *msg;
+
+	if (!emu_ready(hcan))
+		return HAL_ERROR;
+
+	if (RxFifo > CAN_RX_FIFO1 || !emu.fifo[RxFifo].level) {
+		hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+
+	f = &emu.fifo[RxFifo];
+	msg = &f->msg[0];
+
+	pHeader->StdId = msg->id;
+	pHeader->ExtId = 0;
+	pHeader->IDE = CAN_ID_STD;
+	pHeader->RTR = CAN_RTR_DATA;
+	pHeader->DLC = msg->size;
+	pHeader->Timestamp = 0;
+	pHeader->FilterMatchIndex = f->match[0];
+	memcpy(aData, msg->data, msg->size);
+
+	/* Release the output mailbox */
+	f->level--;
+	memmove(&f->msg[0], &f->msg[1], f->level * sizeof(f->msg[0]));
+	memmove(&f->match[0], &f->match[1], f->level * sizeof(f->match[0]));
+
+	return HAL_OK;
+}
+
+uint32_t host_can_get_flag(CAN_HandleTypeDef *hcan, uint32_t flag)
+{
+	UNUSED(hcan);
+
+	if (flag == CAN_FLAG_FOV0)
+		return emu.fifo[CAN_RX_FIFO0].ovr;
+	if (flag == CAN_FLAG_FOV1)
+		return emu.fifo[CAN_RX_FIFO1].ovr;
+
+	return 0;
+}
+
+void host_can_clear_flag(CAN_HandleTypeDef *hcan, uint32_t flag)
+{
+	UNUSED(hcan);
+
+	if (flag == CAN_FLAG_FOV0)
+		emu.fifo[CAN_RX_FIFO0].ovr = false;
+	if (flag == CAN_FLAG_FOV1)
+		emu.fifo[CAN_RX_FIFO1].ovr = false;
+}
+
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan)
+{
+	uint32_t free = 0;
+
+	if (!emu_ready(hcan))
+		return 0;
+
+	emu_tx_update();
+
+	for (int i = 0; i < EMU_MAILBOX_NUM; i++)
+		free += !emu.mailbox_pending[i];
+
+	return free;
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan,
+				       CAN_TxHeaderTypeDef *pHeader,
+				       uint8_t aData[], uint32_t *pTxMailbox)
+{
+	struct mdp_can_msg *msg;
+	int i;
+
+	if (!emu_ready(hcan))
+		return HAL_ERROR;
+
+	emu_tx_update();
+
+	/* Lowest free mailbox, as TSR CODE reports it */
+	for (i = 0; i < EMU_MAILBOX_NUM; i++) {
+		if (!emu.mailbox_pending[i])
+			break;
+	}
+
+	if (i == EMU_MAILBOX_NUM || pHeader->DLC > MDP_CAN_FRAME_LEN) {
+		hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+
+	msg = &emu.mailbox[i];
+	msg->id = pHeader->StdId;
+	msg->size = pHeader->DLC;
+	memcpy(msg->data, aData, msg->size);
+	emu.mailbox_pending[i] = true;
+	*pTxMailbox = BIT(i);
+
+	/* Bus may be idle, transmission starts at once */
+	emu_tx_update();
+	return HAL_OK;
+}
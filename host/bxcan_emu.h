@@ -0,0 +1,137 @@
+/**
+ * @file       bxcan_emu.h
+ * @brief      Behavioural bxCAN model behind the HAL_CAN_* calls.
+ *
+ *             Models what the polling loop depends on: two 3-deep RX
+ *             FIFOs with overrun (FIFOs are not locked, as configured in
+ *             main.c, so the last stored frame is overwritten) and
+ *             their FOVR flags, the filter banks with the reference
+ *             manual priority rules, FIFO1 message pending interrupt
+ *             and three TX mailboxes sent in identifier order. Silent
+ *             mode keeps sent frames off the bus.
+ *
+ *             Frames arrive on a virtual time schedule: the virtual
+ *             clock stops at every arrival, so FIFO levels and the FIFO1
+ *             interrupt are exact, and sleep is woken up by it as WFI is
+ *             by the RX interrupts. Frames take bus time at 125 kbit/s
+ *             (no bit stuffing). Other nodes' traffic and own frames do
+ *             not contend for the bus.
+ *
+ *             Every HAL call takes a fixed number of core cycles.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_BXCAN_EMU_H__
+#define __MDP_BXCAN_EMU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "can_bus_def.h"
+
+#define BXCAN_EMU_BITRATE	125000	/* Bus bit rate */
+#define BXCAN_EMU_FIFO_LEN	3	/* Messages per RX FIFO */
+#define BXCAN_EMU_SCHED_LEN	4096	/* Frames scheduled, not arrived yet */
+#define BXCAN_EMU_TX_QUEUE	256	/* Frames sent, not collected yet */
+#define BXCAN_EMU_CALL_CYCLES	60	/* Core cycles per HAL call */
+
+/* Data frame with standard ID, no bit stuffing, with interframe space */
+#define BXCAN_EMU_FRAME_BITS(dlc)	(47 + 8 * (dlc))
+#define BXCAN_EMU_FRAME_NS(dlc)		(BXCAN_EMU_FRAME_BITS(dlc) * \
+					 (1000000000ULL / BXCAN_EMU_BITRATE))
+
+#define BXCAN_EMU_NO_EVENT	UINT64_MAX
+
+struct bxcan_emu_stats {
+	uint32_t rx[2];		/* Frames stored, per FIFO */
+	uint32_t rx_ovr[2];	/* Frames lost on FIFO overrun, per FIFO */
+	uint32_t rx_ignored;	/* Frames not received: stopped or filter */
+	uint32_t rx_max_level[2];	/* Highest FIFO fill level seen */
+	uint32_t tx;		/* Frames sent */
+	uint32_t tx_silent;	/* Frames sent in silent mode, not on bus */
+	uint32_t tx_dropped;	/* Sent while the TX queue was full */
+};
+
+/**
+ * @brief Reset the model to the state after HAL_CAN_Init() and clear
+ *        the schedule and statistics.
+ */
+void bxcan_emu_reset(void);
+
+/**
+ * @brief Schedule a frame to be received at the given virtual time.
+ *        Frames must be scheduled in order of time, a frame scheduled
+ *        in the past is received at the next clock update.
+ *
+ * @param [in] msg Frame.
+ * @param [in] at_ns Virtual time of the end of the frame.
+ *
+ * @return true if scheduled, false if the schedule is full.
+ */
+bool bxcan_emu_schedule(const struct mdp_can_msg *msg, uint64_t at_ns);
+
+/**
+ * @brief Receive a frame now.
+ *
+ * @param [in] msg Frame.
+ *
+ * @return true if the frame was stored into a FIFO without overrun.
+ */
+bool bxcan_emu_receive(const struct mdp_can_msg *msg);
+
+/**
+ * @brief Take a frame sent by the model. Transmissions finished by the
+ *        current virtual time are completed first.
+ *
+ * @param [out] msg Frame.
+ *
+ * @return true if a frame was taken, false if there is none.
+ */
+bool bxcan_emu_collect(struct mdp_can_msg *msg);
+
+/**
+ * @brief Get number of frames scheduled, but not received yet.
+ *
+ * @return Number of frames.
+ */
+uint32_t bxcan_emu_scheduled(void);
+
+/**
+ * @brief Get virtual time of the next scheduled frame. Used by the
+ *        virtual clock.
+ *
+ * @return Time in nanoseconds, BXCAN_EMU_NO_EVENT if there is none.
+ */
+uint64_t bxcan_emu_next_ns(void);
+
+/**
+ * @brief Receive frames scheduled up to the current virtual time,
+ *        taking the FIFO1 interrupt if enabled. Used by the virtual
+ *        clock.
+ */
+void bxcan_emu_update(void);
+
+/**
+ * @brief Check if a message pending in any FIFO would keep WFI from
+ *        sleeping.
+ *
+ * @return true if any FIFO is not empty.
+ */
+bool bxcan_emu_rx_pending(void);
+
+/**
+ * @brief Get statistics since the last reset.
+ *
+ * @return Statistics.
+ */
+const struct bxcan_emu_stats *bxcan_emu_stats(void);
+
+/**
+ * @brief Clear statistics, the model state is kept.
+ */
+void bxcan_emu_clear_stats(void);
+
+#endif /* __MDP_BXCAN_EMU_H__ */
@@ -0,0 +1,39 @@
+/**
+ * @file       can_host.c
+ * @brief      Virtual CAN buses.
+ *
+ *             Both buses are served by the real back ends talking to the
+ *             controller models: bxCAN model behind the HAL CAN driver
+ *             and MCP2515 model behind SPI. Frames are passed to and
+ *             from the models.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "host.h"
+#include "bxcan_emu.h"
+#include "mcp2515_emu.h"
+
+void host_can_reset(void)
+{
+	bxcan_emu_reset();
+	mcp2515_emu_reset();
+}
+
+bool host_can_inject(host_can_t bus, const struct mdp_can_msg *msg)
+{
+	if (bus == HOST_CAN_SPI)
+		return mcp2515_emu_receive(msg);
+
+	return bxcan_emu_receive(msg);
+}
+
+bool host_can_collect(host_can_t bus, struct mdp_can_msg *msg)
+{
+	if (bus == HOST_CAN_SPI)
+		return mcp2515_emu_collect(msg);
+
+	return bxcan_emu_collect(msg);
+}
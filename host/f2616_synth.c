@@ -0,0 +1,205 @@
+/**
+ * @file       f2616_synth.c
+ * @brief      Falcon 2616 pulse train synthesizer implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "f2616_synth.h"
+#include "falcon2616.h"
+#include "common.h"
+
+#include <string.h>
+
+#define SYNTH_BITS		16
+#define SYNTH_STAT_OK		(1 << 10)
+#define SYNTH_SNS_SHIFT		8
+
+/* Nominal timing, middle of the ranges in falcon2616.h */
+#define SYNTH_START_US		850
+#define SYNTH_START_PERIOD_US	1775
+#define SYNTH_ONE_US		525
+#define SYNTH_ZERO_US		240
+#define SYNTH_BIT_PERIOD_US	800
+#define SYNTH_FRAME_US		(SYNTH_START_PERIOD_US + \
+				 SYNTH_BITS * SYNTH_BIT_PERIOD_US)
+#define SYNTH_PERIOD_MIN_US	80000
+#define SYNTH_PERIOD_MAX_US	100000
+
+#define SYNTH_GLITCH_US		10
+#define SYNTH_NOISE_MAX		3	/* Pulses per idle time */
+#define SYNTH_NOISE_MIN_US	50
+#define SYNTH_NOISE_MAX_US	1200
+
+/* Distances the sensor reports, in centimeters */
+static const uint8_t synth_dm[] = {
+	0, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+	20, 21, 22, 23, 24, 25,
+};
+
+struct synth_ctx {
+	struct f2616_synth *s;
+	struct f2616_synth_frame *f;
+	uint32_t pending_us;	/* Current level time so far */
+};
+
+static uint32_t synth_rand(struct f2616_synth *s)
+{
+	/* xorshift32 */
+	s->rng ^= s->rng << 13;
+	s->rng ^= s->rng >> 17;
+	s->rng ^= s->rng << 5;
+	return s->rng;
+}
+
+static uint32_t synth_range(struct f2616_synth *s, uint32_t lo, uint32_t hi)
+{
+	return lo + synth_rand(s) % (hi - lo + 1);
+}
+
+static bool synth_chance(struct f2616_synth *s, uint32_t pct)
+{
+	return pct && synth_rand(s) % 100 < pct;
+}
+
+static uint32_t synth_scale(struct f2616_synth *s, uint32_t us)
+{
+	return s->cfg.scale_pct ? us * s->cfg.scale_pct / 100 : us;
+}
+
+static uint32_t synth_jitter(struct f2616_synth *s, uint32_t us)
+{
+	uint32_t j = MIN(s->cfg.jitter_us, us / 2);
+
+	if (!j)
+		return us;
+
+	return us - j + synth_rand(s) % (2 * j + 1);
+}
+
+/* Line goes to the level, which is then kept for the given time */
+static void synth_level(struct synth_ctx *c, bool level, uint32_t us)
+{
+	struct f2616_synth_frame *f = c->f;
+
+	if (f->edge_cnt == F2616_SYNTH_MAX_EDGES) {
+		c->pending_us += us;
+		return;
+	}
+
+	f->edges[f->edge_cnt].dt_us = c->pending_us;
+	f->edges[f->edge_cnt].level = level;
+	f->edge_cnt++;
+	c->pending_us = us;
+}
+
+/* Pulse with a glitch: a spike in the low time or a dropout in the high */
+static void synth_pulse(struct synth_ctx *c, uint32_t high_us,
+			uint32_t low_us, bool glitch)
+{
+	uint32_t part;
+
+	if (!glitch) {
+		synth_level(c, true, high_us);
+		synth_level(c, false, low_us);
+		return;
+	}
+
+	if (synth_rand(c->s) & 1) {
+		part = synth_range(c->s, 1, high_us - SYNTH_GLITCH_US - 1);
+		synth_level(c, true, part);
+		synth_level(c, false, SYNTH_GLITCH_US);
+		synth_level(c, true, high_us - part - SYNTH_GLITCH_US);
+		synth_level(c, false, low_us);
+	} else {
+		part = synth_range(c->s, 1, low_us - SYNTH_GLITCH_US - 1);
+		synth_level(c, true, high_us);
+		synth_level(c, false, part);
+		synth_level(c, true, SYNTH_GLITCH_US);
+		synth_level(c, false, low_us - part - SYNTH_GLITCH_US);
+	}
+}
+
+void f2616_synth_init(struct f2616_synth *s, const struct f2616_synth_cfg *cfg)
+{
+	s->cfg = *cfg;
+	s->rng = cfg->seed ? cfg->seed : 1;
+	s->carry_us = 0;
+}
+
+uint32_t f2616_synth_random_cm(struct f2616_synth *s)
+{
+	return synth_dm[synth_rand(s) % ARRAY_SIZE(synth_dm)] * 10;
+}
+
+uint16_t f2616_synth_encode(uint8_t sensor, uint32_t cm)
+{
+	uint8_t dist;
+
+	if (!cm)
+		dist = 255;
+	else if (cm < 100)
+		dist = 255 - cm / 10;
+	else if (cm < 200)
+		dist = 239 - (cm - 100) / 10;
+	else
+		dist = 223 - (cm - 200) / 10;
+
+	return SYNTH_STAT_OK | (sensor << SYNTH_SNS_SHIFT) | dist;
+}
+
+void f2616_synth_next(struct f2616_synth *s, uint8_t sensor, uint32_t cm,
+		      struct f2616_synth_frame *f)
+{
+	struct synth_ctx c = { .s = s, .f = f };
+	uint16_t frame = f2616_synth_encode(sensor, cm);
+	uint32_t idle_us, slot_us, width, pulses = 0;
+	uint32_t bits = SYNTH_BITS, glitch_bit = SYNTH_BITS;
+	uint32_t high, period;
+
+	memset(f, 0, sizeof(*f));
+	f->sensor = sensor;
+	f->cm = cm;
+
+	/* Line is low since the end of the previous frame */
+	idle_us = synth_range(s, SYNTH_PERIOD_MIN_US, SYNTH_PERIOD_MAX_US) -
+		  SYNTH_FRAME_US;
+
+	if (synth_chance(s, s->cfg.noise_pct))
+		pulses = synth_range(s, 1, SYNTH_NOISE_MAX);
+
+	slot_us = idle_us / (pulses + 1);
+	c.pending_us = s->carry_us + slot_us;
+	for (uint32_t i = 0; i < pulses; i++) {
+		width = synth_range(s, SYNTH_NOISE_MIN_US, SYNTH_NOISE_MAX_US);
+		synth_level(&c, true, width);
+		synth_level(&c, false, slot_us - width);
+	}
+
+	if (synth_chance(s, s->cfg.trunc_pct)) {
+		bits = synth_range(s, 0, SYNTH_BITS - 1);
+		f->truncated = true;
+	}
+
+	if (synth_chance(s, s->cfg.glitch_pct)) {
+		glitch_bit = synth_range(s, 0, SYNTH_BITS - 1);
+		f->glitched = glitch_bit < bits;
+	}
+
+	high = synth_jitter(s, synth_scale(s, SYNTH_START_US));
+	period = synth_scale(s, SYNTH_START_PERIOD_US);
+	synth_pulse(&c, high, synth_jitter(s, period - high), false);
+
+	period = synth_scale(s, SYNTH_BIT_PERIOD_US);
+	for (uint32_t i = 0; i < bits; i++) {
+		high = (frame & BIT(i)) ? SYNTH_ONE_US : SYNTH_ZERO_US;
+		high = synth_jitter(s, synth_scale(s, high));
+		synth_pulse(&c, high, synth_jitter(s, period - high),
+			    i == glitch_bit);
+	}
+
+	/* Low time after the last pulse goes to the next idle time */
+	s->carry_us = c.pending_us;
+}
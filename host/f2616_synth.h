@@ -0,0 +1,97 @@
+/**
+ * @file       f2616_synth.h
+ * @brief      Falcon 2616 pulse train synthesizer.
+ *
+ *             Produces the edges of one frame period of the sensor line:
+ *             idle low time, optionally with noise pulses, then the
+ *             start pulse and 16 data bits as described in falcon2616.h.
+ *             Nominal timing is taken from the middle of the documented
+ *             ranges, scaled for units with other timing, and can be
+ *             impaired with jitter, glitches (a short spike or dropout
+ *             inside a frame) and truncated frames.
+ *
+ *             Random numbers come from a seeded generator, so the same
+ *             configuration always gives the same sequence.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_F2616_SYNTH_H__
+#define __MDP_F2616_SYNTH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define F2616_SYNTH_MAX_EDGES	64
+
+struct f2616_synth_cfg {
+	uint32_t jitter_us;	/* Max deviation of every level time */
+	uint32_t glitch_pct;	/* Frames with a glitch */
+	uint32_t trunc_pct;	/* Frames cut short */
+	uint32_t noise_pct;	/* Idle times with noise pulses */
+	uint32_t scale_pct;	/* Pulse timing of another unit, 0 - 100% */
+	uint32_t seed;
+};
+
+struct f2616_synth_edge {
+	uint32_t dt_us;		/* Time since the previous edge */
+	bool level;		/* Line level after the edge */
+};
+
+struct f2616_synth_frame {
+	uint8_t sensor;
+	uint32_t cm;
+	bool truncated;		/* Frame can't be decoded */
+	bool glitched;
+	uint32_t edge_cnt;
+	struct f2616_synth_edge edges[F2616_SYNTH_MAX_EDGES];
+};
+
+struct f2616_synth {
+	struct f2616_synth_cfg cfg;
+	uint32_t rng;
+	uint32_t carry_us;	/* Low time left from the previous frame */
+};
+
+/**
+ * @brief Initialize synthesizer.
+ *
+ * @param [out] s Synthesizer.
+ * @param [in] cfg Impairments and seed.
+ */
+void f2616_synth_init(struct f2616_synth *s, const struct f2616_synth_cfg *cfg);
+
+/**
+ * @brief Get a random distance the sensor can report.
+ *
+ * @param [in] s Synthesizer.
+ *
+ * @return Distance in centimeters.
+ */
+uint32_t f2616_synth_random_cm(struct f2616_synth *s);
+
+/**
+ * @brief Encode a frame of a working sensor.
+ *
+ * @param [in] sensor Sensor identifier, F2616_SNS_*.
+ * @param [in] cm Distance in centimeters, one f2616_synth_random_cm()
+ *                may return.
+ *
+ * @return Frame bits.
+ */
+uint16_t f2616_synth_encode(uint8_t sensor, uint32_t cm);
+
+/**
+ * @brief Synthesize one frame period.
+ *
+ * @param [in] s Synthesizer.
+ * @param [in] sensor Sensor identifier, F2616_SNS_*.
+ * @param [in] cm Distance in centimeters.
+ * @param [out] f Frame edges.
+ */
+void f2616_synth_next(struct f2616_synth *s, uint8_t sensor, uint32_t cm,
+		      struct f2616_synth_frame *f);
+
+#endif /* __MDP_F2616_SYNTH_H__ */
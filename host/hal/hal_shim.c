@@ -0,0 +1,210 @@
+/**
+ * @file       hal_shim.c
+ * @brief      Host shim of the STM32F1 HAL: virtual clock and GPIO.
+ *
+ *             The clock stops at every SysTick and at every scheduled
+ *             bxCAN frame to run their handlers. Handlers run to
+ *             completion: time they spend doesn't deliver other events
+ *             until they return.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "stm32f1xx_hal.h"
+#include "host.h"
+#include "bxcan_emu.h"
+#include "uart_emu.h"
+#include "common.h"
+
+#include <string.h>
+
+GPIO_TypeDef host_gpio[4];
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+
+static uint32_t hclk_hz = HOST_HCLK_HZ;
+static uint64_t cycles;		/* Virtual time */
+static uint64_t time_ns;	/* Virtual time, independent of the clock */
+static uint64_t time_rem;	/* Fraction of nanosecond * hclk_hz */
+static uint64_t tick_cycles;	/* Virtual time of the next SysTick */
+static uint32_t tick_ms;	/* HAL tick */
+static bool in_handler;
+
+/* Provided by the application, as in stm32f1xx_it.c */
+extern void SysTick_Handler(void);
+
+void host_reset(void)
+{
+	memset(host_gpio, 0, sizeof(host_gpio));
+	memset(&host_dwt, 0, sizeof(host_dwt));
+	memset(&host_core_debug, 0, sizeof(host_core_debug));
+
+	hclk_hz = HOST_HCLK_HZ;
+	cycles = 0;
+	time_ns = 0;
+	time_rem = 0;
+	tick_cycles = hclk_hz / 1000;
+	tick_ms = 0;
+	in_handler = false;
+
+	host_can_reset();
+	uart_emu_reset();
+}
+
+static void clock_run(uint64_t n)
+{
+	cycles += n;
+	host_dwt.CYCCNT = (uint32_t)cycles;
+
+	time_rem += n * 1000000000ULL;
+	time_ns += time_rem / hclk_hz;
+	time_rem %= hclk_hz;
+}
+
+/* Cycles until the next bxCAN frame, rounded up to reach its time */
+static uint64_t clock_can_cycles(void)
+{
+	uint64_t at = bxcan_emu_next_ns();
+
+	if (at == BXCAN_EMU_NO_EVENT)
+		return UINT64_MAX;
+	if (at <= time_ns)
+		return 0;
+
+	return ((at - time_ns) * hclk_hz + 999999999ULL) / 1000000000ULL;
+}
+
+void host_advance_cycles(uint64_t n)
+{
+	uint64_t end = cycles + n;
+
+	if (in_handler) {
+		clock_run(n);
+		return;
+	}
+
+	/* Counter runs between the events, so handlers see it moving */
+	while (true) {
+		if (bxcan_emu_next_ns() <= time_ns) {
+			in_handler = true;
+			bxcan_emu_update();
+			in_handler = false;
+			continue;
+		}
+
+		if (cycles >= tick_cycles) {
+			tick_cycles += hclk_hz / 1000;
+			in_handler = true;
+			SysTick_Handler();
+			in_handler = false;
+			continue;
+		}
+
+		if (cycles >= end)
+			break;
+
+		clock_run(MIN(MIN(end, tick_cycles) - cycles,
+			      clock_can_cycles()));
+	}
+}
+
+void host_advance_us(uint64_t us)
+{
+	host_advance_cycles(us * (hclk_hz / 1000000));
+}
+
+void host_sleep(void)
+{
+	/* Pending RX interrupt doesn't let WFI sleep */
+	if (bxcan_emu_rx_pending())
+		return;
+
+	host_advance_cycles(MIN(tick_cycles - cycles, clock_can_cycles()));
+}
+
+uint64_t host_cycles(void)
+{
+	return cycles;
+}
+
+uint64_t host_time_ns(void)
+{
+	return time_ns;
+}
+
+void host_set_hclk(uint32_t hz)
+{
+	uint64_t left = tick_cycles - cycles;
+
+	time_rem = time_rem * hz / hclk_hz;
+
+	/* SysTick keeps its millisecond period in the new clock domain */
+	tick_cycles = cycles + left * (hz / 1000) / (hclk_hz / 1000);
+	hclk_hz = hz;
+}
+
+void host_gpio_set_input(GPIO_TypeDef *port, uint16_t pin,
+			 GPIO_PinState state)
+{
+	if (state == GPIO_PIN_SET)
+		port->IDR |= pin;
+	else
+		port->IDR &= ~(uint32_t)pin;
+}
+
+GPIO_PinState host_gpio_get_output(GPIO_TypeDef *port, uint16_t pin)
+{
+	return (port->ODR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+	return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin,
+		       GPIO_PinState state)
+{
+	if (state == GPIO_PIN_SET)
+		port->ODR |= pin;
+	else
+		port->ODR &= ~(uint32_t)pin;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin)
+{
+	port->ODR ^= pin;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return tick_ms;
+}
+
+void HAL_IncTick(void)
+{
+	tick_ms++;
+}
+
+/* Busy wait on the MCU, so time just passes */
+void HAL_Delay(uint32_t delay)
+{
+	host_advance_us((uint64_t)delay * 1000);
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+	return hclk_hz;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+	return hclk_hz / 2;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+	return hclk_hz;
+}
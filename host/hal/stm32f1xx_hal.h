@@ -0,0 +1,248 @@
+/**
+ * @file       stm32f1xx_hal.h
+ * @brief      Host shim of the STM32F1 HAL.
+ *
+ *             Provides only what the application uses outside the MCU
+ *             interface headers (*_intf.h): GPIO, HAL tick, DWT cycle
+ *             counter, core clock, interrupt masking and the bxCAN
+ *             driver (backed by the bxCAN model, see bxcan_emu.h).
+ *             Nothing runs in the background, time is virtual and moves
+ *             only when it is advanced explicitly (see host.h), so every
+ *             run is deterministic.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef STM32F103xB
+#error "Host HAL shim must not be used for the MCU build"
+#endif
+
+#define UNUSED(x)	((void)(x))
+
+#define SET_BIT(reg, bit)	((reg) |= (bit))
+#define CLEAR_BIT(reg, bit)	((reg) &= ~(bit))
+
+typedef enum {
+	DISABLE = 0,
+	ENABLE = !DISABLE,
+} FunctionalState;
+
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U,
+} HAL_StatusTypeDef;
+
+/* GPIO */
+typedef struct {
+	volatile uint32_t IDR;	/* Input levels, set by the host */
+	volatile uint32_t ODR;	/* Output levels, set by the application */
+} GPIO_TypeDef;
+
+typedef enum {
+	GPIO_PIN_RESET = 0,
+	GPIO_PIN_SET,
+} GPIO_PinState;
+
+extern GPIO_TypeDef host_gpio[4];
+
+#define GPIOA		(&host_gpio[0])
+#define GPIOB		(&host_gpio[1])
+#define GPIOC		(&host_gpio[2])
+#define GPIOD		(&host_gpio[3])
+
+#define GPIO_PIN_0	((uint16_t)0x0001)
+#define GPIO_PIN_1	((uint16_t)0x0002)
+#define GPIO_PIN_2	((uint16_t)0x0004)
+#define GPIO_PIN_3	((uint16_t)0x0008)
+#define GPIO_PIN_4	((uint16_t)0x0010)
+#define GPIO_PIN_5	((uint16_t)0x0020)
+#define GPIO_PIN_6	((uint16_t)0x0040)
+#define GPIO_PIN_7	((uint16_t)0x0080)
+#define GPIO_PIN_8	((uint16_t)0x0100)
+#define GPIO_PIN_9	((uint16_t)0x0200)
+#define GPIO_PIN_10	((uint16_t)0x0400)
+#define GPIO_PIN_11	((uint16_t)0x0800)
+#define GPIO_PIN_12	((uint16_t)0x1000)
+#define GPIO_PIN_13	((uint16_t)0x2000)
+#define GPIO_PIN_14	((uint16_t)0x4000)
+#define GPIO_PIN_15	((uint16_t)0x8000)
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin,
+		       GPIO_PinState state);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *port, uint16_t pin);
+
+/* Core debug and DWT cycle counter */
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+
+#define DWT		(&host_dwt)
+#define CoreDebug	(&host_core_debug)
+
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+
+/* Interrupts are never taken asynchronously on the host */
+static inline uint32_t __get_PRIMASK(void)
+{
+	return 0;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+	UNUSED(primask);
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __enable_irq(void)
+{
+}
+
+static inline void __WFI(void)
+{
+}
+
+static inline void __NOP(void)
+{
+}
+
+/* bxCAN, only the registers read or written by the application */
+typedef struct {
+	volatile uint32_t ESR;
+	volatile uint32_t BTR;
+} CAN_TypeDef;
+
+extern CAN_TypeDef host_can1;
+
+#define CAN1			(&host_can1)
+
+#define CAN_ESR_EPVF		(1UL << 1)
+#define CAN_ESR_BOFF		(1UL << 2)
+#define CAN_BTR_SILM		(1UL << 31)
+
+typedef enum {
+	HAL_CAN_STATE_RESET = 0x00U,
+	HAL_CAN_STATE_READY = 0x01U,
+	HAL_CAN_STATE_LISTENING = 0x02U,
+} HAL_CAN_StateTypeDef;
+
+/* Init parameters are fixed by the model: 125 kbit/s, FIFOs not locked */
+typedef struct {
+	CAN_TypeDef *Instance;
+	volatile HAL_CAN_StateTypeDef State;
+	volatile uint32_t ErrorCode;
+} CAN_HandleTypeDef;
+
+typedef struct {
+	uint32_t FilterIdHigh;
+	uint32_t FilterIdLow;
+	uint32_t FilterMaskIdHigh;
+	uint32_t FilterMaskIdLow;
+	uint32_t FilterFIFOAssignment;
+	uint32_t FilterBank;
+	uint32_t FilterMode;
+	uint32_t FilterScale;
+	uint32_t FilterActivation;
+	uint32_t SlaveStartFilterBank;
+} CAN_FilterTypeDef;
+
+typedef struct {
+	uint32_t StdId;
+	uint32_t ExtId;
+	uint32_t IDE;
+	uint32_t RTR;
+	uint32_t DLC;
+	FunctionalState TransmitGlobalTime;
+} CAN_TxHeaderTypeDef;
+
+typedef struct {
+	uint32_t StdId;
+	uint32_t ExtId;
+	uint32_t IDE;
+	uint32_t RTR;
+	uint32_t DLC;
+	uint32_t Timestamp;
+	uint32_t FilterMatchIndex;
+} CAN_RxHeaderTypeDef;
+
+#define HAL_CAN_ERROR_NONE		(0x00000000U)
+#define HAL_CAN_ERROR_PARAM		(0x00200000U)
+#define HAL_CAN_ERROR_NOT_READY		(0x00080000U)
+#define HAL_CAN_ERROR_NOT_STARTED	(0x00100000U)
+#define HAL_CAN_ERROR_NOT_INITIALIZED	(0x00040000U)
+
+#define CAN_FILTERMODE_IDMASK		(0x00000000U)
+#define CAN_FILTERMODE_IDLIST		(0x00000001U)
+#define CAN_FILTERSCALE_16BIT		(0x00000000U)
+#define CAN_FILTERSCALE_32BIT		(0x00000001U)
+#define CAN_FILTER_FIFO0		(0x00000000U)
+#define CAN_FILTER_FIFO1		(0x00000001U)
+#define CAN_RX_FIFO0			(0x00000000U)
+#define CAN_RX_FIFO1			(0x00000001U)
+#define CAN_ID_STD			(0x00000000U)
+#define CAN_ID_EXT			(0x00000004U)
+#define CAN_RTR_DATA			(0x00000000U)
+#define CAN_RTR_REMOTE			(0x00000002U)
+
+#define CAN_IT_RX_FIFO0_MSG_PENDING	(1UL << 1)
+#define CAN_IT_RX_FIFO1_MSG_PENDING	(1UL << 4)
+
+#define CAN_FLAG_FOV0			(0x00000204U)
+#define CAN_FLAG_FOV1			(0x00000404U)
+
+/* Flags are kept by the model, rc_w1 bits can't be a plain register */
+#define __HAL_CAN_GET_FLAG(h, flag)	host_can_get_flag((h), (flag))
+#define __HAL_CAN_CLEAR_FLAG(h, flag)	host_can_clear_flag((h), (flag))
+
+uint32_t host_can_get_flag(CAN_HandleTypeDef *hcan, uint32_t flag);
+void host_can_clear_flag(CAN_HandleTypeDef *hcan, uint32_t flag);
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan,
+				       CAN_FilterTypeDef *sFilterConfig);
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan);
+HAL_StatusTypeDef HAL_CAN_Stop(CAN_HandleTypeDef *hcan);
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan,
+					       uint32_t ActiveITs);
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef *hcan,
+				    uint32_t RxFifo);
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan,
+				       uint32_t RxFifo,
+				       CAN_RxHeaderTypeDef *pHeader,
+				       uint8_t aData[]);
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan);
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan,
+				       CAN_TxHeaderTypeDef *pHeader,
+				       uint8_t aData[], uint32_t *pTxMailbox);
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan);
+
+/* Tick and clock */
+uint32_t HAL_GetTick(void);
+void HAL_IncTick(void);
+void HAL_Delay(uint32_t delay);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+#endif /* __STM32F1xx_HAL_H */
@@ -0,0 +1,131 @@
+/**
+ * @file       host.h
+ * @brief      Host build control API: virtual time, fake GPIO inputs and
+ *             virtual CAN buses.
+ *
+ *             Virtual time is kept in core cycles of the virtual MCU.
+ *             Advancing it updates the DWT counter and calls
+ *             SysTick_Handler() once for every millisecond boundary
+ *             crossed, the same way the real SysTick interrupt does.
+ *             Frames scheduled on the bxCAN bus are received at their
+ *             time the same way (see bxcan_emu.h).
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_HOST_H__
+#define __MDP_HOST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f1xx_hal.h"
+#include "can_bus_def.h"
+
+#define HOST_HCLK_HZ		72000000	/* Default core clock */
+
+/* Virtual buses, one per CAN interface of the board */
+typedef enum {
+	HOST_CAN_HAL = 0,	/* On-chip bxCAN */
+	HOST_CAN_SPI,		/* MCP2515 */
+	HOST_CAN_COUNT,
+} host_can_t;
+
+/**
+ * @brief Reset virtual time, GPIO, CAN buses and the sniffer UART to
+ *        power-on state.
+ */
+void host_reset(void);
+
+/**
+ * @brief Advance virtual time.
+ *
+ * @param [in] cycles Number of core cycles.
+ */
+void host_advance_cycles(uint64_t cycles);
+
+/**
+ * @brief Advance virtual time.
+ *
+ * @param [in] us Time in microseconds.
+ */
+void host_advance_us(uint64_t us);
+
+/**
+ * @brief Advance virtual time to the next SysTick or bxCAN frame, as
+ *        WFI does. Returns at once if a received frame is pending.
+ */
+void host_sleep(void);
+
+/**
+ * @brief Get virtual time.
+ *
+ * @return Number of core cycles since host_reset().
+ */
+uint64_t host_cycles(void);
+
+/**
+ * @brief Get virtual time, not affected by the core clock changes.
+ *
+ * @return Time in nanoseconds since host_reset().
+ */
+uint64_t host_time_ns(void);
+
+/**
+ * @brief Set virtual core clock, as done by the power governor.
+ *
+ * @param [in] hz Core clock frequency in Hz.
+ */
+void host_set_hclk(uint32_t hz);
+
+/**
+ * @brief Drive GPIO input level seen by HAL_GPIO_ReadPin().
+ *
+ * @param [in] port GPIO port.
+ * @param [in] pin GPIO pin mask.
+ * @param [in] state Input level.
+ */
+void host_gpio_set_input(GPIO_TypeDef *port, uint16_t pin,
+			 GPIO_PinState state);
+
+/**
+ * @brief Get GPIO output level written by the application.
+ *
+ * @param [in] port GPIO port.
+ * @param [in] pin GPIO pin mask.
+ *
+ * @return Output level.
+ */
+GPIO_PinState host_gpio_get_output(GPIO_TypeDef *port, uint16_t pin);
+
+/**
+ * @brief Reset virtual CAN buses: controller models reset, schedules and
+ *        statistics cleared. Called by host_reset().
+ */
+void host_can_reset(void);
+
+/**
+ * @brief Put a frame on the virtual bus now, to be read by the
+ *        application.
+ *
+ * @param [in] bus Virtual bus.
+ * @param [in] msg Frame.
+ *
+ * @return true if the frame was received by the controller, false if it
+ *         was lost or not accepted.
+ */
+bool host_can_inject(host_can_t bus, const struct mdp_can_msg *msg);
+
+/**
+ * @brief Take a frame written by the application to the virtual bus.
+ *
+ * @param [in] bus Virtual bus.
+ * @param [out] msg Frame.
+ *
+ * @return true if a frame was taken, false if there is none.
+ */
+bool host_can_collect(host_can_t bus, struct mdp_can_msg *msg);
+
+#endif /* __MDP_HOST_H__ */
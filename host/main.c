@@ -0,0 +1,123 @@
+/**
+ * @file       main.c
+ * @brief      Host build entry: boots the application on the virtual MCU
+ *             and runs the benchmarks.
+ *
+ *             Usage: mdp_host [-l] [benchmark...]
+ *                 -l  List benchmarks.
+ *             All benchmarks are run if none is given. Exit status is
+ *             non-zero if any of them has failed its checks.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "host.h"
+#include "bench.h"
+#include "mdp.h"
+#include "common.h"
+#include "time.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const struct host_bench *benches[] = {
+	&host_bench_signal,
+	&host_bench_display,
+	&host_bench_gateway,
+	&host_bench_mcp2515,
+	&host_bench_busload,
+	&host_bench_f2616,
+	&host_bench_track,
+	&host_bench_rgear,
+	/* Sniffer mode lasts until reset */
+	&host_bench_sniffer,
+};
+
+/* Same as in main.c, initialization parameters are fixed by the model */
+CAN_HandleTypeDef hcan = {
+	.Instance = CAN1,
+	.State = HAL_CAN_STATE_READY,
+};
+
+/* Same as in stm32f1xx_it.c */
+void SysTick_Handler(void)
+{
+	HAL_IncTick();
+	mdp_tm_systick();
+}
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int bench_run(const struct host_bench *b)
+{
+	uint64_t ns, cyc;
+	int ret;
+
+	ns = host_ns();
+	cyc = host_cycles();
+
+	ret = b->run(b->ops);
+
+	ns = host_ns() - ns;
+	cyc = host_cycles() - cyc;
+
+	printf("%-10s %9u %-8s %10.1f ns/op %12.0f op/s %10.1f cyc/op  %s\n",
+	       b->name, b->ops, b->op, (double)ns / b->ops,
+	       ns ? b->ops * 1e9 / ns : 0.0, (double)cyc / b->ops,
+	       ret ? "FAIL" : "ok");
+
+	if (b->report)
+		b->report();
+
+	return ret;
+}
+
+static bool bench_selected(const struct host_bench *b, int argc,
+			   char **argv)
+{
+	if (argc < 2)
+		return true;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], b->name))
+			return true;
+	}
+
+	return false;
+}
+
+int main(int argc, char **argv)
+{
+	int failed = 0;
+
+	if (argc > 1 && !strcmp(argv[1], "-l")) {
+		for (size_t i = 0; i < ARRAY_SIZE(benches); i++)
+			printf("%-10s %s\n", benches[i]->name, benches[i]->op);
+		return 0;
+	}
+
+	/* Same sequence as on the MCU, peripherals need no init here */
+	host_reset();
+	mdp_tm_init();
+	mdp_init();
+
+	printf("\n%-10s %9s %-8s %16s %17s %16s\n", "benchmark", "ops",
+	       "op", "host", "host", "virtual");
+
+	for (size_t i = 0; i < ARRAY_SIZE(benches); i++) {
+		if (bench_selected(benches[i], argc, argv) &&
+		    bench_run(benches[i]))
+			failed++;
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,582 @@
+/**
+ * @file       mcp2515_emu.c
+ * @brief      Behavioural MCP2515 model implementation.
+ *
+ *             Register map and instruction set follow the MCP2515
+ *             datasheet (DS20001801), sections 11 and 12.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "mcp2515_emu.h"
+#include "mcp2515_regs.h"
+#include "host.h"
+#include "common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EMU_REG_NUM		0x80
+#define EMU_TXB_NUM		3
+#define EMU_RXB_NUM		2
+
+/* Buffer layout: CTRL, SIDH, SIDL, EID8, EID0, DLC, D0..D7 */
+#define EMU_TXB(n)		(MCP2515_TXB0CTRL + 0x10 * (n))
+#define EMU_RXB(n)		(MCP2515_RXB0CTRL + 0x10 * (n))
+#define EMU_BUF_SIDH		1
+#define EMU_BUF_SIDL		2
+#define EMU_BUF_DLC		5
+#define EMU_BUF_D0		6
+
+#define EMU_TXREQ		BIT(3)
+#define EMU_TXP_MSK		0x03
+#define EMU_RXM_MSK		0x60	/* RXBnCTRL receive mode */
+#define EMU_RXM_ANY		0x60	/* Filters off, receive everything */
+#define EMU_BUKT		BIT(2)
+#define EMU_EXIDE		BIT(3)
+#define EMU_RTR			BIT(6)
+#define EMU_DLC_MSK		0x0F
+
+#define EMU_RX0IF		BIT(0)
+#define EMU_RX1IF		BIT(1)
+#define EMU_TXIF(n)		BIT((2 + (n)))
+#define EMU_RX0OVR		BIT(6)
+#define EMU_RX1OVR		BIT(7)
+
+#define EMU_OPMOD_MSK		0xE0
+#define EMU_MODE_NORMAL		0x00
+#define EMU_MODE_LISTEN		0x60
+#define EMU_MODE_CONFIG		0x80
+
+/* Data frame with standard ID, no bit stuffing, with interframe space */
+#define EMU_FRAME_BITS(dlc)	(47 + 8 * (dlc))
+
+struct mcp2515_emu {
+	uint8_t regs[EMU_REG_NUM];
+
+	/* SPI transaction */
+	bool cs_low;
+	uint32_t pos;		/* Byte index in the transaction */
+	uint8_t instr;
+	mcp2515_emu_op_t op;
+	uint8_t addr;
+	uint8_t mask;
+	uint32_t sck_hz;
+
+	/* Bus */
+	int tx_cur;		/* Buffer being sent, -1 if none */
+	uint64_t tx_end_ns;
+	uint64_t bus_free_ns;
+
+	struct mdp_can_msg tx_queue[MCP2515_EMU_TX_QUEUE];
+	uint32_t tx_head, tx_tail;
+
+	/* Received during the next READ RX BUFFER */
+	struct mdp_can_msg rx_in_read;
+	bool rx_in_read_set;
+
+	struct mcp2515_emu_stats stats;
+};
+
+static struct mcp2515_emu emu = { .sck_hz = 9000000, .tx_cur = -1 };
+
+static const char *const op_names[MCP2515_EMU_OP_COUNT] = {
+	[MCP2515_EMU_OP_RESET] = "RESET",
+	[MCP2515_EMU_OP_READ] = "READ",
+	[MCP2515_EMU_OP_WRITE] = "WRITE",
+	[MCP2515_EMU_OP_BIT_MODIFY] = "BIT_MODIFY",
+	[MCP2515_EMU_OP_READ_STATUS] = "READ_STATUS",
+	[MCP2515_EMU_OP_RX_STATUS] = "RX_STATUS",
+	[MCP2515_EMU_OP_LOAD_TX] = "LOAD_TX",
+	[MCP2515_EMU_OP_RTS] = "RTS",
+	[MCP2515_EMU_OP_READ_RX] = "READ_RX",
+	[MCP2515_EMU_OP_UNKNOWN] = "unknown",
+};
+
+static uint8_t emu_mode(void)
+{
+	return emu.regs[MCP2515_CANSTAT] & EMU_OPMOD_MSK;
+}
+
+static void emu_chip_reset(void)
+{
+	memset(emu.regs, 0, sizeof(emu.regs));
+	emu.regs[MCP2515_CANSTAT] = EMU_MODE_CONFIG;
+	emu.regs[MCP2515_CANCTRL] = 0x87;
+
+	/* Frame on the wire is aborted */
+	emu.tx_cur = -1;
+}
+
+static void emu_tx_complete(void)
+{
+	uint8_t *b = &emu.regs[EMU_TXB(emu.tx_cur)];
+	struct mdp_can_msg msg;
+
+	msg.id = (b[EMU_BUF_SIDH] << 3) | (b[EMU_BUF_SIDL] >> 5);
+	msg.size = MIN(b[EMU_BUF_DLC] & EMU_DLC_MSK, MDP_CAN_FRAME_LEN);
+	memcpy(msg.data, &b[EMU_BUF_D0], msg.size);
+
+	b[0] &= ~EMU_TXREQ;
+	emu.regs[MCP2515_CANINTF] |= EMU_TXIF(emu.tx_cur);
+	emu.bus_free_ns = emu.tx_end_ns;
+	emu.tx_cur = -1;
+	emu.stats.tx++;
+
+	if (emu.tx_head - emu.tx_tail >= MCP2515_EMU_TX_QUEUE) {
+		emu.stats.tx_dropped++;
+		return;
+	}
+
+	emu.tx_queue[emu.tx_head++ % MCP2515_EMU_TX_QUEUE] = msg;
+}
+
+/* Pending buffer with the highest TXP, the highest number wins a tie */
+static int emu_tx_next(void)
+{
+	int next = -1, prio = -1, p;
+	uint8_t ctrl;
+
+	for (int i = EMU_TXB_NUM - 1; i >= 0; i--) {
+		ctrl = emu.regs[EMU_TXB(i)];
+		p = ctrl & EMU_TXP_MSK;
+		if ((ctrl & EMU_TXREQ) && p > prio) {
+			next = i;
+			prio = p;
+		}
+	}
+
+	return next;
+}
+
+/* Brings the bus to the current virtual time */
+static void emu_update(void)
+{
+	uint64_t now = host_time_ns();
+	uint8_t dlc;
+
+	while (true) {
+		if (emu.tx_cur >= 0) {
+			if (emu.tx_end_ns > now)
+				return;
+			emu_tx_complete();
+		}
+
+		if (emu_mode() != EMU_MODE_NORMAL)
+			return;
+
+		emu.tx_cur = emu_tx_next();
+		if (emu.tx_cur < 0)
+			return;
+
+		dlc = emu.regs[EMU_TXB(emu.tx_cur) + EMU_BUF_DLC] & EMU_DLC_MSK;
+		emu.tx_end_ns = MAX(emu.bus_free_ns, now) +
+				(uint64_t)EMU_FRAME_BITS(MIN(dlc, 8)) *
+				1000000000ULL / MCP2515_EMU_BITRATE;
+	}
+}
+
+static void emu_write(uint8_t addr, uint8_t val)
+{
+	addr &= EMU_REG_NUM - 1;
+
+	switch (addr) {
+	case MCP2515_CANSTAT:
+	case MCP2515_TEC:
+	case MCP2515_REC:
+		/* Read-only */
+		return;
+	case MCP2515_CANCTRL:
+		/* Mode is changed at once, no frame is ever in progress */
+		emu.regs[addr] = val;
+		emu.regs[MCP2515_CANSTAT] =
+			(emu.regs[MCP2515_CANSTAT] & ~EMU_OPMOD_MSK) |
+			(val & EMU_OPMOD_MSK);
+		break;
+	case MCP2515_EFLG:
+		/* Only overflow flags are writable */
+		val &= EMU_RX0OVR | EMU_RX1OVR;
+		emu.regs[addr] &= ~(EMU_RX0OVR | EMU_RX1OVR);
+		emu.regs[addr] |= val;
+		break;
+	default:
+		emu.regs[addr] = val;
+		break;
+	}
+
+	emu_update();
+}
+
+static uint8_t emu_read(uint8_t addr)
+{
+	return emu.regs[addr & (EMU_REG_NUM - 1)];
+}
+
+static uint8_t emu_read_status(void)
+{
+	uint8_t intf = emu.regs[MCP2515_CANINTF];
+	uint8_t status = intf & (EMU_RX0IF | EMU_RX1IF);
+
+	/* TXREQ and TXnIF pairs of every buffer, not the CANINTF layout */
+	for (int i = 0; i < EMU_TXB_NUM; i++) {
+		if (emu.regs[EMU_TXB(i)] & EMU_TXREQ)
+			status |= BIT((2 + 2 * i));
+		if (intf & EMU_TXIF(i))
+			status |= BIT((3 + 2 * i));
+	}
+
+	return status;
+}
+
+static uint8_t emu_rx_status(void)
+{
+	uint8_t intf = emu.regs[MCP2515_CANINTF];
+	uint8_t status = 0;
+	uint8_t *b;
+	int rxb;
+
+	if (intf & EMU_RX0IF)
+		status |= BIT(6);
+	if (intf & EMU_RX1IF)
+		status |= BIT(7);
+	if (!status)
+		return 0;
+
+	/* Type and filter of RXB0 message if both are full */
+	rxb = (intf & EMU_RX0IF) ? 0 : 1;
+	b = &emu.regs[EMU_RXB(rxb)];
+
+	if (b[EMU_BUF_SIDL] & EMU_EXIDE)
+		status |= BIT(4);
+	if (b[EMU_BUF_DLC] & EMU_RTR)
+		status |= BIT(3);
+	status |= b[0] & (rxb ? 0x07 : 0x01);	/* FILHIT */
+
+	return status;
+}
+
+static mcp2515_emu_op_t emu_decode(uint8_t instr)
+{
+	switch (instr) {
+	case MCP2515_RESET:
+		return MCP2515_EMU_OP_RESET;
+	case MCP2515_READ:
+		return MCP2515_EMU_OP_READ;
+	case MCP2515_WRITE:
+		return MCP2515_EMU_OP_WRITE;
+	case MCP2515_BIT_MOD:
+		return MCP2515_EMU_OP_BIT_MODIFY;
+	case MCP2515_READ_STATUS:
+		return MCP2515_EMU_OP_READ_STATUS;
+	case MCP2515_RX_STATUS:
+		return MCP2515_EMU_OP_RX_STATUS;
+	}
+
+	if ((instr & 0xF8) == MCP2515_LOAD_TXB0SIDH && (instr & 0x07) <= 5)
+		return MCP2515_EMU_OP_LOAD_TX;
+	if ((instr & 0xF8) == 0x80)
+		return MCP2515_EMU_OP_RTS;
+	if ((instr & 0xF9) == MCP2515_READ_RXB0SIDH)
+		return MCP2515_EMU_OP_READ_RX;
+
+	return MCP2515_EMU_OP_UNKNOWN;
+}
+
+static void emu_start(uint8_t instr)
+{
+	emu.instr = instr;
+	emu.op = emu_decode(instr);
+
+	switch (emu.op) {
+	case MCP2515_EMU_OP_RESET:
+		emu_chip_reset();
+		break;
+	case MCP2515_EMU_OP_RTS:
+		for (int i = 0; i < EMU_TXB_NUM; i++) {
+			if (instr & BIT(i))
+				emu.regs[EMU_TXB(i)] |= EMU_TXREQ;
+		}
+		emu_update();
+		break;
+	case MCP2515_EMU_OP_LOAD_TX:
+		/* 0x40, 0x42, 0x44: TXB0-2 from SIDH, odd ones from D0 */
+		emu.addr = EMU_TXB((instr & 0x06) >> 1) +
+			   ((instr & 0x01) ? EMU_BUF_D0 : EMU_BUF_SIDH);
+		break;
+	case MCP2515_EMU_OP_READ_RX:
+		/* 0x90, 0x94: RXB0-1 from SIDH, 0x92, 0x96 from D0 */
+		emu.addr = EMU_RXB((instr & 0x04) >> 2) +
+			   ((instr & 0x02) ? EMU_BUF_D0 : EMU_BUF_SIDH);
+		break;
+	default:
+		break;
+	}
+}
+
+static uint8_t emu_byte(uint8_t in)
+{
+	uint32_t pos = emu.pos++;
+	uint8_t out = 0xFF;
+
+	if (!pos) {
+		emu_start(in);
+		return out;
+	}
+
+	switch (emu.op) {
+	case MCP2515_EMU_OP_READ:
+		if (pos == 1)
+			emu.addr = in;
+		else
+			out = emu_read(emu.addr++);
+		break;
+	case MCP2515_EMU_OP_WRITE:
+		if (pos == 1)
+			emu.addr = in;
+		else
+			emu_write(emu.addr++, in);
+		break;
+	case MCP2515_EMU_OP_BIT_MODIFY:
+		if (pos == 1)
+			emu.addr = in;
+		else if (pos == 2)
+			emu.mask = in;
+		else if (pos == 3)
+			emu_write(emu.addr, (emu_read(emu.addr) & ~emu.mask) |
+				  (in & emu.mask));
+		break;
+	case MCP2515_EMU_OP_READ_STATUS:
+		out = emu_read_status();
+		break;
+	case MCP2515_EMU_OP_RX_STATUS:
+		out = emu_rx_status();
+		break;
+	case MCP2515_EMU_OP_LOAD_TX:
+		emu_write(emu.addr++, in);
+		break;
+	case MCP2515_EMU_OP_READ_RX:
+		out = emu_read(emu.addr++);
+		break;
+	default:
+		break;
+	}
+
+	return out;
+}
+
+void mcp2515_emu_reset(void)
+{
+	memset(&emu, 0, sizeof(emu));
+	emu.sck_hz = 9000000;
+	emu_chip_reset();
+}
+
+void mcp2515_emu_set_sck(uint32_t hz)
+{
+	emu.sck_hz = hz;
+}
+
+void mcp2515_emu_cs(bool high)
+{
+	if (!high) {
+		emu.cs_low = true;
+		emu.pos = 0;
+		emu_update();
+		return;
+	}
+
+	if (!emu.cs_low)
+		return;
+
+	emu.cs_low = false;
+	if (!emu.pos)
+		return;
+
+	emu.stats.xfers[emu.op]++;
+	emu.stats.bytes[emu.op] += emu.pos;
+
+	if (emu.op != MCP2515_EMU_OP_READ_RX)
+		return;
+
+	/* Buffer being read is still full */
+	if (emu.rx_in_read_set) {
+		emu.rx_in_read_set = false;
+		mcp2515_emu_receive(&emu.rx_in_read);
+	}
+
+	/* READ RX BUFFER frees the buffer when CS goes high */
+	emu.regs[MCP2515_CANINTF] &= (emu.instr & 0x04) ? ~EMU_RX1IF :
+						      ~EMU_RX0IF;
+}
+
+int mcp2515_emu_xfer(const uint8_t *tx, uint8_t *rx, uint16_t size)
+{
+	uint8_t out;
+
+	if (!emu.cs_low)
+		return -EIO;
+
+	for (uint16_t i = 0; i < size; i++) {
+		out = emu_byte(tx ? tx[i] : 0xFF);
+		if (rx)
+			rx[i] = out;
+	}
+
+	/* 8 SCK periods per byte */
+	host_advance_cycles((uint64_t)size * 8 * HAL_RCC_GetHCLKFreq() /
+			    emu.sck_hz);
+	return 0;
+}
+
+static bool emu_filter_match(int rxb, uint32_t id, uint8_t *filhit)
+{
+	/* RXB0: mask 0, filters 0-1; RXB1: mask 1, filters 2-5 */
+	static const uint8_t filters[] = {
+		MCP2515_RXF0SIDH, MCP2515_RXF1SIDH, MCP2515_RXF2SIDH,
+		MCP2515_RXF3SIDH, MCP2515_RXF4SIDH, MCP2515_RXF5SIDH,
+	};
+	uint8_t maddr = rxb ? MCP2515_RXM1SIDH : MCP2515_RXM0SIDH;
+	uint32_t mask, filt;
+	int first = rxb ? 2 : 0, last = rxb ? 5 : 1;
+
+	if ((emu.regs[EMU_RXB(rxb)] & EMU_RXM_MSK) == EMU_RXM_ANY) {
+		*filhit = first;
+		return true;
+	}
+
+	mask = (emu.regs[maddr] << 3) | (emu.regs[maddr + 1] >> 5);
+	for (int i = first; i <= last; i++) {
+		filt = (emu.regs[filters[i]] << 3) |
+		       (emu.regs[filters[i] + 1] >> 5);
+		if (!((id ^ filt) & mask)) {
+			*filhit = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void emu_rx_load(int rxb, const struct mdp_can_msg *msg,
+			uint8_t filhit)
+{
+	uint8_t *b = &emu.regs[EMU_RXB(rxb)];
+
+	/* RXB0CTRL has BUKT and BUKT1 above FILHIT0 */
+	if (rxb)
+		b[0] = (b[0] & ~0x07) | filhit;
+	else
+		b[0] = (b[0] & ~0x01) | (filhit & 0x01);
+	b[EMU_BUF_SIDH] = msg->id >> 3;
+	b[EMU_BUF_SIDL] = (msg->id & 0x07) << 5;
+	b[EMU_BUF_SIDL + 1] = 0;
+	b[EMU_BUF_SIDL + 2] = 0;
+	b[EMU_BUF_DLC] = msg->size;
+	memcpy(&b[EMU_BUF_D0], msg->data, msg->size);
+
+	emu.regs[MCP2515_CANINTF] |= rxb ? EMU_RX1IF : EMU_RX0IF;
+	emu.stats.rx++;
+}
+
+bool mcp2515_emu_receive(const struct mdp_can_msg *msg)
+{
+	uint8_t intf, mode, filhit;
+
+	emu_update();
+
+	mode = emu_mode();
+	if (mode != EMU_MODE_NORMAL && mode != EMU_MODE_LISTEN) {
+		emu.stats.rx_ignored++;
+		return false;
+	}
+
+	intf = emu.regs[MCP2515_CANINTF];
+
+	if (emu_filter_match(0, msg->id, &filhit)) {
+		if (!(intf & EMU_RX0IF)) {
+			emu_rx_load(0, msg, filhit);
+			return true;
+		}
+
+		/* Rollover: RXB0 message goes to RXB1 regardless of filters */
+		if (!(emu.regs[MCP2515_RXB0CTRL] & EMU_BUKT)) {
+			emu.regs[MCP2515_EFLG] |= EMU_RX0OVR;
+			emu.stats.rx_ovr++;
+			return false;
+		}
+	} else if (!emu_filter_match(1, msg->id, &filhit)) {
+		emu.stats.rx_ignored++;
+		return false;
+	}
+
+	if (intf & EMU_RX1IF) {
+		emu.regs[MCP2515_EFLG] |= EMU_RX1OVR;
+		emu.stats.rx_ovr++;
+		return false;
+	}
+
+	emu_rx_load(1, msg, filhit);
+	return true;
+}
+
+void mcp2515_emu_receive_in_read(const struct mdp_can_msg *msg)
+{
+	emu.rx_in_read = *msg;
+	emu.rx_in_read_set = true;
+}
+
+bool mcp2515_emu_collect(struct mdp_can_msg *msg)
+{
+	emu_update();
+
+	if (emu.tx_head == emu.tx_tail)
+		return false;
+
+	*msg = emu.tx_queue[emu.tx_tail++ % MCP2515_EMU_TX_QUEUE];
+	return true;
+}
+
+const struct mcp2515_emu_stats *mcp2515_emu_stats(void)
+{
+	return &emu.stats;
+}
+
+void mcp2515_emu_clear_stats(void)
+{
+	memset(&emu.stats, 0, sizeof(emu.stats));
+}
+
+void mcp2515_emu_print_stats(uint32_t frames)
+{
+	const struct mcp2515_emu_stats *s = &emu.stats;
+	uint32_t xfers = 0, bytes = 0;
+
+	printf("  %-12s %10s %10s", "instruction", "xfers", "bytes");
+	if (frames)
+		printf(" %12s %12s", "xfers/frame", "bytes/frame");
+	printf("\n");
+
+	for (int i = 0; i < MCP2515_EMU_OP_COUNT; i++) {
+		xfers += s->xfers[i];
+		bytes += s->bytes[i];
+		if (!s->xfers[i])
+			continue;
+
+		printf("  %-12s %10u %10u", op_names[i], s->xfers[i],
+		       s->bytes[i]);
+		if (frames)
+			printf(" %12.2f %12.2f", (double)s->xfers[i] / frames,
+			       (double)s->bytes[i] / frames);
+		printf("\n");
+	}
+
+	printf("  %-12s %10u %10u", "total", xfers, bytes);
+	if (frames)
+		printf(" %12.2f %12.2f", (double)xfers / frames,
+		       (double)bytes / frames);
+	printf("\n  frames: rx %u, rx overflow %u, rx ignored %u, tx %u\n",
+	       s->rx, s->rx_ovr, s->rx_ignored, s->tx);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file       mcp2515_emu.h
+ * @brief      Behavioural MCP2515 model at the SPI instruction level.
+ *
+ *             Implements the instructions used by the driver: RESET,
+ *             READ, WRITE, BIT MODIFY, READ STATUS, RX STATUS, LOAD TX
+ *             BUFFER, RTS and READ RX BUFFER, with the register file,
+ *             TX/RX buffers, acceptance filters, rollover and
+ *             CANINTF/EFLG flags. Modes: configuration, normal and
+ *             listen-only.
+ *
+ *             SPI bytes take virtual time at the SCK rate. Frames take
+ *             virtual time on the bus (no bit stuffing) and pending TX
+ *             buffers are sent in the chip's order: highest TXP, then
+ *             highest buffer number. Received frames arrive instantly.
+ *
+ *             Every SPI transaction (CS low to CS high) is accounted to
+ *             its instruction, so the cost of driver operations can be
+ *             counted in transactions and bytes.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_MCP2515_EMU_H__
+#define __MDP_MCP2515_EMU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "can_bus_def.h"
+
+#define MCP2515_EMU_BITRATE	125000	/* Bus bit rate */
+#define MCP2515_EMU_TX_QUEUE	256	/* Frames sent, not collected yet */
+
+typedef enum {
+	MCP2515_EMU_OP_RESET = 0,
+	MCP2515_EMU_OP_READ,
+	MCP2515_EMU_OP_WRITE,
+	MCP2515_EMU_OP_BIT_MODIFY,
+	MCP2515_EMU_OP_READ_STATUS,
+	MCP2515_EMU_OP_RX_STATUS,
+	MCP2515_EMU_OP_LOAD_TX,
+	MCP2515_EMU_OP_RTS,
+	MCP2515_EMU_OP_READ_RX,
+	MCP2515_EMU_OP_UNKNOWN,
+	MCP2515_EMU_OP_COUNT,
+} mcp2515_emu_op_t;
+
+struct mcp2515_emu_stats {
+	uint32_t xfers[MCP2515_EMU_OP_COUNT];	/* CS low to CS high */
+	uint32_t bytes[MCP2515_EMU_OP_COUNT];
+	uint32_t rx;		/* Frames put into RX buffers */
+	uint32_t rx_ovr;	/* Frames lost, both RX buffers full */
+	uint32_t rx_ignored;	/* Frames not received: mode or filter */
+	uint32_t tx;		/* Frames sent */
+	uint32_t tx_dropped;	/* Sent while the TX queue was full */
+};
+
+/**
+ * @brief Reset the model to power-on state and clear statistics.
+ */
+void mcp2515_emu_reset(void);
+
+/**
+ * @brief Set SPI clock used to account the transfer time.
+ *
+ * @param [in] hz SCK frequency in Hz.
+ */
+void mcp2515_emu_set_sck(uint32_t hz);
+
+/**
+ * @brief Drive chip select.
+ *
+ * @param [in] high true to end the transaction, false to start one.
+ */
+void mcp2515_emu_cs(bool high);
+
+/**
+ * @brief Clock bytes through SPI while CS is low.
+ *
+ * @param [in] tx Bytes to send, NULL to send 0xFF.
+ * @param [out] rx Received bytes, may be NULL.
+ * @param [in] size Number of bytes.
+ *
+ * @return 0 on success, -EIO if CS is high.
+ */
+int mcp2515_emu_xfer(const uint8_t *tx, uint8_t *rx, uint16_t size);
+
+/**
+ * @brief Put a frame on the bus, to be received by the model.
+ *
+ * @param [in] msg Frame.
+ *
+ * @return true if the frame was put into an RX buffer.
+ */
+bool mcp2515_emu_receive(const struct mdp_can_msg *msg);
+
+/**
+ * @brief Put a frame on the bus while the next READ RX BUFFER is in
+ *        progress, so it finds the buffer being read still full.
+ *
+ * @param [in] msg Frame.
+ */
+void mcp2515_emu_receive_in_read(const struct mdp_can_msg *msg);
+
+/**
+ * @brief Take a frame sent by the model. Transmissions finished by the
+ *        current virtual time are completed first.
+ *
+ * @param [out] msg Frame.
+ *
+ * @return true if a frame was taken, false if there is none.
+ */
+bool mcp2515_emu_collect(struct mdp_can_msg *msg);
+
+/**
+ * @brief Get statistics since the last reset.
+ *
+ * @return Statistics.
+ */
+const struct mcp2515_emu_stats *mcp2515_emu_stats(void);
+
+/**
+ * @brief Clear statistics, the model state is kept.
+ */
+void mcp2515_emu_clear_stats(void);
+
+/**
+ * @brief Print SPI statistics per instruction.
+ *
+ * @param [in] frames Number of frames to normalize to, 0 - don't.
+ */
+void mcp2515_emu_print_stats(uint32_t frames);
+
+#endif /* __MDP_MCP2515_EMU_H__ */
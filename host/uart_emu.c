@@ -0,0 +1,75 @@
+/**
+ * @file       uart_emu.c
+ * @brief      Behavioural model of the sniffer UART implementation.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#include "uart_emu.h"
+#include "host.h"
+
+#include <string.h>
+
+struct uart_emu {
+	uint32_t baud;
+	uint64_t busy_ns;	/* Virtual time the last byte is sent */
+
+	uint8_t rx[UART_EMU_RX_SIZE];
+	uint32_t rx_head, rx_tail;
+	uint32_t dropped;
+};
+
+static struct uart_emu emu;
+
+void uart_emu_reset(void)
+{
+	memset(&emu, 0, sizeof(emu));
+}
+
+bool uart_emu_init(uint32_t baud)
+{
+	emu.baud = baud;
+	emu.busy_ns = 0;
+
+	return baud != 0;
+}
+
+bool uart_emu_busy(void)
+{
+	return host_time_ns() < emu.busy_ns;
+}
+
+void uart_emu_send(const uint8_t *data, uint16_t size)
+{
+	if (!emu.baud)
+		return;
+
+	emu.busy_ns = host_time_ns() + (uint64_t)size * UART_EMU_BYTE_BITS *
+		      1000000000ULL / emu.baud;
+
+	for (uint16_t i = 0; i < size; i++) {
+		if (emu.rx_head - emu.rx_tail >= UART_EMU_RX_SIZE) {
+			emu.dropped++;
+			continue;
+		}
+
+		emu.rx[emu.rx_head++ % UART_EMU_RX_SIZE] = data[i];
+	}
+}
+
+uint32_t uart_emu_read(uint8_t *data, uint32_t size)
+{
+	uint32_t n = 0;
+
+	while (n < size && emu.rx_tail != emu.rx_head)
+		data[n++] = emu.rx[emu.rx_tail++ % UART_EMU_RX_SIZE];
+
+	return n;
+}
+
+uint32_t uart_emu_dropped(void)
+{
+	return emu.dropped;
+}
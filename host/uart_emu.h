@@ -0,0 +1,71 @@
+/**
+ * @file       uart_emu.h
+ * @brief      Behavioural model of the sniffer UART with its TX DMA
+ *             channel.
+ *
+ *             A transfer is started at once and keeps the channel busy
+ *             for the time the bytes take on the wire at the set baud
+ *             rate (8N1, 10 bits per byte). Sent bytes are kept for the
+ *             host to read as the serial port on the other end would.
+ *
+ * @date       October 19, 2026
+ * @author     Eduard Chaika <rampopula@gmail.com>
+ * @copyright  Copyright (c) 2026 Eduard Chaika
+ */
+
+#ifndef __MDP_UART_EMU_H__
+#define __MDP_UART_EMU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_EMU_RX_SIZE	65536	/* Bytes sent, not read yet */
+#define UART_EMU_BYTE_BITS	10	/* Start, 8 data, stop */
+
+/**
+ * @brief Reset the model: stopped, nothing sent. Called by host_reset().
+ */
+void uart_emu_reset(void);
+
+/**
+ * @brief Start the UART at the given baud rate.
+ *
+ * @param [in] baud Baud rate.
+ *
+ * @return true on success, false if the baud rate is 0.
+ */
+bool uart_emu_init(uint32_t baud);
+
+/**
+ * @brief Check if the last transfer is still going on.
+ *
+ * @return true until its last byte is on the wire.
+ */
+bool uart_emu_busy(void);
+
+/**
+ * @brief Start a DMA transfer, the data is taken at once.
+ *
+ * @param [in] data Bytes to send.
+ * @param [in] size Number of bytes.
+ */
+void uart_emu_send(const uint8_t *data, uint16_t size);
+
+/**
+ * @brief Read bytes sent by the application.
+ *
+ * @param [out] data Buffer.
+ * @param [in] size Buffer size.
+ *
+ * @return Number of bytes read.
+ */
+uint32_t uart_emu_read(uint8_t *data, uint32_t size);
+
+/**
+ * @brief Get number of bytes lost because the host didn't read them.
+ *
+ * @return Number of bytes.
+ */
+uint32_t uart_emu_dropped(void);
+
+#endif /* __MDP_UART_EMU_H__ */
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+#
+# Decode MDP black-box snapshot (see app/bbox/bbox.h).
+#
+# Input is either a console log with "bbox dump" output, or a raw image
+# of the BBOX flash region, e.g. read by "st-flash read img.bin 0x800E000
+# 0x2000".
+#
+# Usage:
+#   mdp_bbox_decode.py console.log
+#   mdp_bbox_decode.py --raw img.bin --candump > trace.log
+#
+# Copyright (c) 2026 Eduard Chaika <rampopula@gmail.com>
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x42504D44
+VERSION = 1
+DICT_SIZE = 64
+HDR_FMT = '<IHHIIQH%dH3H' % DICT_SIZE
+HDR_LEN = struct.calcsize(HDR_FMT)
+
+REC_DICT, REC_ID, REC_EVENT = 0, 1, 2
+DIRS = ('pjb->dp', 'dp->pjb')
+EVENTS = ('boot', 'trigger', 'error', 'rgear', 'power', 'bypass',
+          'gw_drop', 'rx_err', 'tx_err')
+
+DUMP_RE = re.compile(r'BBOX ([0-9A-F]{4,}) ([0-9A-F]+)')
+
+
+def read_dump(lines):
+    chunks = {}
+    for line in lines:
+        m = DUMP_RE.search(line)
+        if m:
+            chunks[int(m.group(1), 16)] = bytes.fromhex(m.group(2))
+
+    data = bytearray()
+    for off in sorted(chunks):
+        if off != len(data):
+            sys.exit('Dump is incomplete at offset 0x%04X' % len(data))
+        data += chunks[off]
+    return bytes(data)
+
+
+def leb128(data, pos):
+    val = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        val |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return val, pos
+
+
+def event_arg(ev, arg):
+    name = EVENTS[ev] if ev < len(EVENTS) else 'event%d' % ev
+    if name == 'trigger':
+        return name, EVENTS[arg] if arg < len(EVENTS) else str(arg)
+    if name == 'gw_drop':
+        return name, DIRS[arg & 1]
+    if name in ('rx_err', 'tx_err'):
+        return name, '%s errno %d' % (DIRS[(arg >> 8) & 1], arg & 0xFF)
+    return name, str(arg)
+
+
+def decode(data):
+    if len(data) < HDR_LEN:
+        sys.exit('Snapshot is too short')
+
+    hdr = struct.unpack_from(HDR_FMT, data)
+    magic, version, reason, commit_ms, length, first_us, dict_cnt = hdr[:7]
+    dictionary = hdr[7:7 + dict_cnt]
+
+    if magic != MAGIC or version != VERSION:
+        sys.exit('No valid snapshot (magic 0x%08X, version %d)' %
+                 (magic, version))
+
+    recs = data[HDR_LEN:HDR_LEN + length]
+    if len(recs) < length:
+        sys.exit('Snapshot is truncated')
+
+    info = {
+        'reason': EVENTS[reason] if reason < len(EVENTS) else str(reason),
+        'commit_ms': commit_ms,
+        'length': length,
+        'ids': len(dictionary),
+    }
+
+    records = []
+    pos, us = 0, first_us
+    while pos < length:
+        hdr = recs[pos]
+        rtype = hdr >> 6
+        dt, pos = leb128(recs, pos + 1)
+        # Delta of the oldest record refers to an overwritten one
+        if records:
+            us += dt
+
+        if rtype == REC_EVENT:
+            arg, pos = leb128(recs, pos)
+            records.append((us, 'event', event_arg(hdr & 0x3F, arg)))
+            continue
+
+        dlc = hdr & 0x0F
+        if rtype == REC_DICT:
+            can_id = dictionary[recs[pos]]
+            pos += 1
+        else:
+            can_id = recs[pos] | (recs[pos + 1] << 8)
+            pos += 2
+
+        frame = (DIRS[(hdr >> 5) & 1], can_id, bool(hdr & 0x10),
+                 recs[pos:pos + dlc])
+        pos += dlc
+        records.append((us, 'frame', frame))
+
+    return info, records
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode MDP black-box snapshot')
+    parser.add_argument('input', help='console log, raw image or -')
+    parser.add_argument('--raw', action='store_true',
+                        help='input is a raw flash image')
+    parser.add_argument('--candump', action='store_true',
+                        help='print frames only, in candump log format')
+    args = parser.parse_args()
+
+    if args.raw:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+    else:
+        with (sys.stdin if args.input == '-' else
+              open(args.input, errors='replace')) as f:
+            data = read_dump(f)
+
+    info, records = decode(data)
+    end_us = records[-1][0] if records else 0
+
+    if not args.candump:
+        print('Reason: %(reason)s, uptime %(commit_ms)d ms, '
+              '%(length)d bytes, %(ids)d IDs' % info)
+
+    for us, kind, rec in records:
+        if args.candump:
+            if kind == 'frame':
+                print('(%.6f) %s %03X#%s' % (us / 1e6, rec[0], rec[1],
+                                             rec[3].hex().upper()))
+            continue
+
+        rel = (us - end_us) / 1e3
+        if kind == 'event':
+            print('%10.3f ms  %-8s %s %s' % (rel, '', *rec))
+        else:
+            print('%10.3f ms  %-8s %03X %s %s' %
+                  (rel, rec[0], rec[1], 'R' if rec[2] else ' ',
+                   rec[3].hex(' ').upper()))
+
+
+if __name__ == '__main__':
+    main()
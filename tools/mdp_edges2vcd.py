@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+#
+# Convert MDP edge capture stream (see app/edgecap/edgecap.h) to VCD.
+#
+# Usage:
+#   mdp_edges2vcd.py /dev/ttyUSB0 > line.vcd
+#   mdp_edges2vcd.py capture.bin --widths
+#
+# The output can be opened with GTKWave, PulseView or any other
+# waveform viewer which reads Value Change Dump files.
+#
+# Copyright (c) 2026 Eduard Chaika <rampopula@gmail.com>
+
+import argparse
+import sys
+
+from mdp_sniff2candump import DEFAULT_BAUD, crc8, open_input
+
+SYNC = 0x5A
+REC_LEN = 9
+INFO_LEVEL = 0
+INFO_TICK = 1
+
+
+class Decoder:
+    def __init__(self, out, signal, widths):
+        self.out = out
+        self.signal = signal
+        self.widths = widths
+        self.buf = bytearray()
+        self.last_cyc = None
+        self.wraps = 0
+        self.start_ns = None
+        self.level = None
+        self.level_ns = 0
+        self.seq = None
+        self.edges = 0
+        self.lost = 0
+        self.crc_errors = 0
+
+    def _header(self, level):
+        if self.widths:
+            return
+
+        self.out.write('$timescale 1 ns $end\n'
+                       '$scope module mdp $end\n'
+                       '$var wire 1 ! %s $end\n'
+                       '$upscope $end\n'
+                       '$enddefinitions $end\n'
+                       '#0\n'
+                       '$dumpvars\n%d!\n$end\n' % (self.signal, level))
+
+    def _time_ns(self, cyc, mhz):
+        if self.last_cyc is not None and cyc < self.last_cyc:
+            self.wraps += 1
+        self.last_cyc = cyc
+
+        ns = ((self.wraps << 32) + cyc) * 1000 // mhz
+        if self.start_ns is None:
+            self.start_ns = ns
+        return ns - self.start_ns
+
+    def _level(self, ns, level):
+        if self.level is None:
+            self._header(level)
+        elif level == self.level:
+            return
+        elif self.widths:
+            self.out.write('%d %d\n' % (self.level,
+                                        (ns - self.level_ns) // 1000))
+        else:
+            self.out.write('#%d\n%d!\n' % (ns, level))
+
+        self.level = level
+        self.level_ns = ns
+
+    def _record(self, rec):
+        seq, info, mhz = rec[1], rec[2], rec[3]
+        cyc = int.from_bytes(rec[4:8], 'little')
+        level = (info >> INFO_LEVEL) & 1
+
+        if not mhz:
+            return
+        ns = self._time_ns(cyc, mhz)
+
+        if not (info >> INFO_TICK) & 1:
+            if self.seq is not None:
+                self.lost += (seq - self.seq - 1) & 0xFF
+            self.seq = seq
+            self.edges += 1
+
+        self._level(ns, level)
+
+    def feed(self, chunk):
+        buf = self.buf
+        buf += chunk
+
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                buf.clear()
+                return
+            del buf[:start]
+
+            if len(buf) < REC_LEN:
+                return
+
+            if crc8(buf[1:REC_LEN - 1]) != buf[REC_LEN - 1]:
+                # Not a record start, resync from the next byte
+                self.crc_errors += 1
+                del buf[0]
+                continue
+
+            self._record(bytes(buf[:REC_LEN]))
+            del buf[:REC_LEN]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert MDP edge capture stream to VCD')
+    parser.add_argument('input', help='serial device, capture file or -')
+    parser.add_argument('-b', '--baud', type=int, default=DEFAULT_BAUD,
+                        help='serial baud rate (default %(default)d)')
+    parser.add_argument('-s', '--signal', default='ptronic',
+                        help='signal name in VCD (default %(default)s)')
+    parser.add_argument('-w', '--widths', action='store_true',
+                        help='print level and its width in us instead')
+    args = parser.parse_args()
+
+    dec = Decoder(sys.stdout, args.signal, args.widths)
+    src = open_input(args.input, args.baud)
+
+    try:
+        while True:
+            chunk = src.read(4096)
+            if not chunk:
+                break
+            dec.feed(chunk)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    sys.stderr.write('%d edges, %d lost, %d CRC errors\n' %
+                     (dec.edges, dec.lost, dec.crc_errors))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+#
+# Convert MDP sniffer stream (see app/sniffer/sniffer.h) to candump log.
+#
+# Usage:
+#   mdp_sniff2candump.py /dev/ttyUSB0 > trace.log
+#   mdp_sniff2candump.py capture.bin --relative > trace.log
+#
+# The output can be replayed with canplayer or viewed with any tool
+# which understands "candump -L" format.
+#
+# Copyright (c) 2026 Eduard Chaika <rampopula@gmail.com>
+
+import argparse
+import os
+import stat
+import sys
+import termios
+import time
+
+SYNC = 0xA5
+HDR_LEN = 9
+INFO_BUS = 7
+INFO_DLC = 0x0F
+DEFAULT_BAUD = 1000000
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) if crc & 0x80 else crc << 1
+            crc &= 0xFF
+    return crc
+
+
+def open_input(path, baud):
+    if path == '-':
+        return sys.stdin.buffer
+
+    f = open(path, 'rb', buffering=0)
+    if not stat.S_ISCHR(os.fstat(f.fileno()).st_mode):
+        return f
+
+    speed = getattr(termios, 'B%d' % baud, None)
+    if speed is None:
+        sys.exit('Unsupported baud rate: %d' % baud)
+
+    attr = termios.tcgetattr(f.fileno())
+    attr[0] = 0                                     # iflag
+    attr[1] = 0                                     # oflag
+    attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+    attr[3] = 0                                     # lflag
+    attr[4] = attr[5] = speed
+    attr[6][termios.VMIN] = 1
+    attr[6][termios.VTIME] = 0
+    termios.tcsetattr(f.fileno(), termios.TCSANOW, attr)
+    termios.tcflush(f.fileno(), termios.TCIFLUSH)
+    return f
+
+
+class Decoder:
+    def __init__(self, out, ifnames, relative):
+        self.out = out
+        self.ifnames = ifnames
+        self.base = 0.0 if relative else None
+        self.buf = bytearray()
+        self.last_us = None
+        self.wraps = 0
+        self.seq = None
+        self.frames = 0
+        self.lost = 0
+        self.crc_errors = 0
+
+    def _timestamp(self, us):
+        if self.last_us is not None and us < self.last_us:
+            self.wraps += 1
+        self.last_us = us
+        usec = (self.wraps << 32) + us
+
+        if self.base is None:
+            self.base = time.time() - usec / 1e6
+        return self.base + usec / 1e6
+
+    def _record(self, rec):
+        seq, info = rec[1], rec[2]
+        bus = (info >> INFO_BUS) & 1
+        dlc = info & INFO_DLC
+        can_id = rec[3] | (rec[4] << 8)
+        us = int.from_bytes(rec[5:9], 'little')
+        data = rec[HDR_LEN:HDR_LEN + dlc]
+
+        if self.seq is not None:
+            self.lost += (seq - self.seq - 1) & 0xFF
+        self.seq = seq
+        self.frames += 1
+
+        self.out.write('(%.6f) %s %03X#%s\n' %
+                       (self._timestamp(us), self.ifnames[bus], can_id,
+                        data.hex().upper()))
+
+    def feed(self, chunk):
+        buf = self.buf
+        buf += chunk
+
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                buf.clear()
+                return
+            del buf[:start]
+
+            if len(buf) < HDR_LEN:
+                return
+
+            dlc = buf[2] & INFO_DLC
+            size = HDR_LEN + dlc + 1
+            if dlc > 8:
+                del buf[0]
+                continue
+            if len(buf) < size:
+                return
+
+            if crc8(buf[1:size - 1]) != buf[size - 1]:
+                # Not a record start, resync from the next byte
+                self.crc_errors += 1
+                del buf[0]
+                continue
+
+            self._record(bytes(buf[:size]))
+            del buf[:size]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert MDP sniffer stream to candump log')
+    parser.add_argument('input', help='serial device, capture file or -')
+    parser.add_argument('-b', '--baud', type=int, default=DEFAULT_BAUD,
+                        help='serial baud rate (default %(default)d)')
+    parser.add_argument('-i', '--ifnames', default='pjb,dp',
+                        help='names of bus 0 and bus 1 (default %(default)s)')
+    parser.add_argument('-r', '--relative', action='store_true',
+                        help='timestamps start from the device boot')
+    args = parser.parse_args()
+
+    ifnames = args.ifnames.split(',')
+    if len(ifnames) != 2:
+        sys.exit('Two interface names expected')
+
+    dec = Decoder(sys.stdout, ifnames, args.relative)
+    src = open_input(args.input, args.baud)
+
+    try:
+        while True:
+            chunk = src.read(4096)
+            if not chunk:
+                break
+            dec.feed(chunk)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    sys.stderr.write('%d frames, at least %d lost, %d CRC errors\n' %
+                     (dec.frames, dec.lost, dec.crc_errors))
+
+
+if __name__ == '__main__':
+    main()